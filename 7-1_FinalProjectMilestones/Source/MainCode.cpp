@@ -1,205 +1,783 @@
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-// Namespace for declaring global variables
-namespace
-{
-    // Macro for window title
-    const char* const WINDOW_TITLE = "5-3 Assignment Jake B";
-
-    // Main GLFW window
-    GLFWwindow* g_Window = nullptr;
-
-    // Scene manager object for managing the 3D scene prepare and render
-    SceneManager* g_SceneManager = nullptr;
-    // Shader manager object for dynamic interaction with the shader code
-    ShaderManager* g_ShaderManager = nullptr;
-    // View manager object for managing the 3D view setup and projection to 2D
-    ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-bool InitializeGLFW();
-bool InitializeGLEW();
-void initLighting();  // Declare the lighting initialization function
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-    // if GLFW fails initialization, then terminate the application
-    if (InitializeGLFW() == false)
-    {
-        return(EXIT_FAILURE);
-    }
-
-    // try to create a new shader manager object
-    g_ShaderManager = new ShaderManager();
-    // try to create a new view manager object
-    g_ViewManager = new ViewManager(g_ShaderManager);
-
-    // try to create the main display window
-    g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-    // if GLEW fails initialization, then terminate the application
-    if (InitializeGLEW() == false)
-    {
-        return(EXIT_FAILURE);
-    }
-
-    // load the shader code from the external GLSL files
-    g_ShaderManager->LoadShaders(
-        "../../Utilities/shaders/vertexShader.glsl",
-        "../../Utilities/shaders/fragmentShader.glsl");
-    g_ShaderManager->use();
-
-    // Initialize lighting setup
-    initLighting();  // Call the lighting initialization function
-
-    // try to create a new scene manager object and prepare the 3D scene
-    g_SceneManager = new SceneManager(g_ShaderManager);
-    g_SceneManager->PrepareScene();
-
-    // loop will keep running until the application is closed 
-    // or until an error has occurred
-    while (!glfwWindowShouldClose(g_Window))
-    {
-        // Enable z-depth
-        glEnable(GL_DEPTH_TEST);
-
-        // Clear the frame and z buffers
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // convert from 3D object space to 2D view
-        g_ViewManager->PrepareSceneView();
-
-        // refresh the 3D scene
-        g_SceneManager->RenderScene();
-
-        // Flips the the back buffer with the front buffer every frame.
-        glfwSwapBuffers(g_Window);
-
-        // query the latest GLFW events
-        glfwPollEvents();
-    }
-
-    // clear the allocated manager objects from memory
-    if (NULL != g_SceneManager)
-    {
-        delete g_SceneManager;
-        g_SceneManager = NULL;
-    }
-    if (NULL != g_ViewManager)
-    {
-        delete g_ViewManager;
-        g_ViewManager = NULL;
-    }
-    if (NULL != g_ShaderManager)
-    {
-        delete g_ShaderManager;
-        g_ShaderManager = NULL;
-    }
-
-    // Terminates the program successfully
-    exit(EXIT_SUCCESS);
-}
-
-/***********************************************************
- *	InitializeGLFW()
- *
- *  This function is used to initialize the GLFW library.
- ***********************************************************/
-bool InitializeGLFW()
-{
-    // GLFW: initialize and configure library
-    glfwInit();
-
-#ifdef __APPLE__
-    // set the version of OpenGL and profile to use
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-    // set the version of OpenGL and profile to use
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-    // GLFW: end -------------------------------
-
-    return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-    // GLEW: initialize
-    GLenum GLEWInitResult = GLEW_OK;
-
-    // try to initialize the GLEW library
-    GLEWInitResult = glewInit();
-    if (GLEW_OK != GLEWInitResult)
-    {
-        std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-        return false;
-    }
-    // GLEW: end -------------------------------
-
-    // Displays a successful OpenGL initialization message
-    std::cout << "INFO: OpenGL Successfully Initialized\n";
-    std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-    return(true);
-}
-
-/***********************************************************
- *  initLighting()
- *
- *  This function sets up the lighting parameters for the scene.
- ***********************************************************/
-void initLighting() {
-    glEnable(GL_LIGHTING);  // Enable the lighting system
-    glEnable(GL_LIGHT0);    // Enable the first light source (GL_LIGHT0)
-    glEnable(GL_DEPTH_TEST); // Enable depth testing for correct rendering order
-
-    // Light properties
-    GLfloat lightPos[] = { 1.0f, 1.0f, 1.0f, 0.0f };  // Directional light
-    GLfloat ambientLight[] = { 0.2f, 0.2f, 0.2f, 1.0f };  // Ambient color
-    GLfloat diffuseLight[] = { 0.8f, 0.8f, 0.8f, 1.0f };  // Diffuse color
-    GLfloat specularLight[] = { 1.0f, 1.0f, 1.0f, 1.0f }; // Specular color
-
-    // Apply properties to GL_LIGHT0
-    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
-    glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, specularLight);
-
-    // Optional: Set material properties for objects being drawn
-    GLfloat materialSpecular[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    GLfloat materialShininess[] = { 50.0f };
-
-    glMaterialfv(GL_FRONT, GL_SPECULAR, materialSpecular);
-    glMaterialfv(GL_FRONT, GL_SHININESS, materialShininess);
-}
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <chrono>           // shader benchmark timing
+#include <thread>           // hardware thread count
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+#include "ShaderUniforms.h"
+#include "CookedTexture.h"
+#include "TextureCompressor.h"
+#include "TextureDecoder.h"
+#include "MipGenerator.h"
+#include "InstancedMeshes.h"
+#include "FrameDataBuffer.h"
+
+// Namespace for declaring global variables
+namespace
+{
+    // Macro for window title
+    const char* const WINDOW_TITLE = "5-3 Assignment Jake B";
+
+    // Main GLFW window
+    GLFWwindow* g_Window = nullptr;
+
+    // Scene manager object for managing the 3D scene prepare and render
+    SceneManager* g_SceneManager = nullptr;
+    // Shader manager object for dynamic interaction with the shader code
+    ShaderManager* g_ShaderManager = nullptr;
+    // View manager object for managing the 3D view setup and projection to 2D
+    ViewManager* g_ViewManager = nullptr;
+
+    // number of frames between printing the GL state call counts
+    const unsigned int STATE_STATS_INTERVAL = 600;
+    // number of frames rendered so far
+    unsigned int g_FrameCount = 0;
+
+    // paths of the scene shaders
+    const char* const VERTEX_SHADER_PATH = "../../Utilities/shaders/vertexShader.glsl";
+    const char* const FRAGMENT_SHADER_PATH = "../../Utilities/shaders/fragmentShader.glsl";
+    const char* const VERTEX_SPIRV_PATH = "../../Utilities/shaders/spirv/vertexShader.spv";
+    const char* const FRAGMENT_SPIRV_PATH = "../../Utilities/shaders/spirv/fragmentShader.spv";
+
+    // number of times each shader path is built by the benchmark
+    const int SHADER_BENCHMARK_RUNS = 5;
+    // number of times each image is compressed by the benchmark
+    const int COMPRESS_BENCHMARK_RUNS = 3;
+    // the vertex benchmark draws a square grid of spheres this
+    // many on a side, for this many timed frames per path
+    const int VERTEX_BENCHMARK_GRID = 100;
+    const int VERTEX_BENCHMARK_FRAMES = 100;
+
+    // how textures without a cooked file are block compressed,
+    // which the cooker uses as well
+    bool g_bCompressTextures = true;
+    TextureCompressor::COMPRESSION_FORMAT g_CompressionFormat = TextureCompressor::FORMAT_AUTO;
+    TextureCompressor::COMPRESSION_QUALITY g_CompressionQuality = TextureCompressor::QUALITY_NORMAL;
+    // the filter that the mipmaps are built with
+    MipGenerator::MIP_FILTER g_MipFilter = MipGenerator::FILTER_KAISER;
+    // whether small textures are packed into atlas pages
+    bool g_bPackTextures = true;
+    // the most video memory that the texture levels may take
+    size_t g_TextureBudget = 256 * 1024 * 1024;
+    // the video played on the laptop screen, when one is given
+    // instead of the default image sequence
+    bool g_bScreenVideoSet = false;
+    VideoTexture::VIDEO_SOURCE g_ScreenVideo;
+    // whether the shaders pull the mesh vertices from a storage
+    // buffer instead of fetching vertex attributes
+    bool g_bVertexPulling = false;
+}
+
+// Function declarations - all functions that are called manually
+bool InitializeGLFW();
+bool InitializeGLEW();
+void initLighting();  // Declare the lighting initialization function
+bool UseSpirvShaders(ShaderManager* pShaderManager);
+void RunShaderBenchmark();
+void RunVertexBenchmark();
+int CookTextures(int fileCount, char* files[]);
+int RunCompressBenchmark(int fileCount, char* files[]);
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+    // --spirv builds the shader variants from the SPIR-V modules,
+    // --shader-benchmark times both shader paths and exits,
+    // --vertex-pulling reads the mesh vertices from a storage
+    // buffer in the shaders instead of as vertex attributes,
+    // --vertex-benchmark times drawing with both vertex fetches
+    // and exits,
+    // --texture-compression <off|fast|normal|high> sets how the
+    // textures are block compressed, --bc7 compresses into BC7,
+    // --mip-filter <box|kaiser> sets how the mipmaps are built,
+    // --texture-budget <megabytes> sets the texture memory budget,
+    // --texture-atlas <on|off> sets whether small textures share
+    // atlas pages,
+    // --screen-video <file pattern> <fps> plays an image sequence
+    // on the laptop screen, such as frame%03d.jpg,
+    // --screen-raw <file> <width> <height> <channels> <fps> plays
+    // a raw video file on the laptop screen,
+    // --cook-textures cooks the image files that follow and exits,
+    // --compress-benchmark times compressing the image files that
+    // follow and exits
+    bool bUseSpirv = false;
+    bool bShaderBenchmark = false;
+    bool bVertexBenchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--spirv") == 0)
+        {
+            bUseSpirv = true;
+        }
+        else if (strcmp(argv[i], "--shader-benchmark") == 0)
+        {
+            bShaderBenchmark = true;
+        }
+        else if (strcmp(argv[i], "--vertex-pulling") == 0)
+        {
+            g_bVertexPulling = true;
+        }
+        else if (strcmp(argv[i], "--vertex-benchmark") == 0)
+        {
+            bVertexBenchmark = true;
+        }
+        else if ((strcmp(argv[i], "--texture-compression") == 0) && (i + 1 < argc))
+        {
+            i++;
+            g_bCompressTextures = (strcmp(argv[i], "off") != 0);
+            if (strcmp(argv[i], "fast") == 0)
+            {
+                g_CompressionQuality = TextureCompressor::QUALITY_FAST;
+            }
+            else if (strcmp(argv[i], "high") == 0)
+            {
+                g_CompressionQuality = TextureCompressor::QUALITY_HIGH;
+            }
+            else
+            {
+                g_CompressionQuality = TextureCompressor::QUALITY_NORMAL;
+            }
+        }
+        else if ((strcmp(argv[i], "--mip-filter") == 0) && (i + 1 < argc))
+        {
+            i++;
+            g_MipFilter = (strcmp(argv[i], "box") == 0) ? MipGenerator::FILTER_BOX : MipGenerator::FILTER_KAISER;
+        }
+        else if ((strcmp(argv[i], "--texture-budget") == 0) && (i + 1 < argc))
+        {
+            i++;
+            g_TextureBudget = (size_t)atoi(argv[i]) * 1024 * 1024;
+        }
+        else if ((strcmp(argv[i], "--texture-atlas") == 0) && (i + 1 < argc))
+        {
+            i++;
+            g_bPackTextures = (strcmp(argv[i], "off") != 0);
+        }
+        else if ((strcmp(argv[i], "--screen-video") == 0) && (i + 2 < argc))
+        {
+            g_ScreenVideo.type = VideoTexture::SOURCE_IMAGE_SEQUENCE;
+            g_ScreenVideo.path = argv[i + 1];
+            g_ScreenVideo.width = 0;
+            g_ScreenVideo.height = 0;
+            g_ScreenVideo.colorChannels = 0;
+            g_ScreenVideo.frameRate = atof(argv[i + 2]);
+            g_bScreenVideoSet = true;
+            i += 2;
+        }
+        else if ((strcmp(argv[i], "--screen-raw") == 0) && (i + 5 < argc))
+        {
+            g_ScreenVideo.type = VideoTexture::SOURCE_RAW_VIDEO;
+            g_ScreenVideo.path = argv[i + 1];
+            g_ScreenVideo.width = atoi(argv[i + 2]);
+            g_ScreenVideo.height = atoi(argv[i + 3]);
+            g_ScreenVideo.colorChannels = atoi(argv[i + 4]);
+            g_ScreenVideo.frameRate = atof(argv[i + 5]);
+            g_bScreenVideoSet = true;
+            i += 5;
+        }
+        else if (strcmp(argv[i], "--bc7") == 0)
+        {
+            g_CompressionFormat = TextureCompressor::FORMAT_BC7;
+        }
+        else if (strcmp(argv[i], "--compress-benchmark") == 0)
+        {
+            return(RunCompressBenchmark(argc - i - 1, &argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--cook-textures") == 0)
+        {
+            // cooking is offline, so no window is needed
+            return(CookTextures(argc - i - 1, &argv[i + 1]));
+        }
+    }
+
+    // if GLFW fails initialization, then terminate the application
+    if (InitializeGLFW() == false)
+    {
+        return(EXIT_FAILURE);
+    }
+
+    // try to create a new shader manager object
+    g_ShaderManager = new ShaderManager();
+    // try to create a new view manager object
+    g_ViewManager = new ViewManager(g_ShaderManager);
+
+    // try to create the main display window
+    g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+
+    // if GLEW fails initialization, then terminate the application
+    if (InitializeGLEW() == false)
+    {
+        return(EXIT_FAILURE);
+    }
+
+    if (bShaderBenchmark)
+    {
+        RunShaderBenchmark();
+        exit(EXIT_SUCCESS);
+    }
+
+    if (bVertexBenchmark)
+    {
+        RunVertexBenchmark();
+        exit(EXIT_SUCCESS);
+    }
+
+    // register the uniform handles so they are checked when
+    // the shader program is linked
+    g_ShaderManager->RegisterUniforms(
+        ShaderUniforms::All,
+        sizeof(ShaderUniforms::All) / sizeof(ShaderUniforms::All[0]));
+
+    // load the shader code from the external GLSL files
+    g_ShaderManager->LoadShaders(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    g_ShaderManager->use();
+
+    // the shader variants can be built from the SPIR-V modules
+    // instead, with the GLSL files kept as the fallback
+    if (bUseSpirv)
+    {
+        UseSpirvShaders(g_ShaderManager);
+    }
+
+    // recompile the shaders whenever their files are saved
+    g_ShaderManager->EnableHotReload();
+
+    // Initialize lighting setup
+    initLighting();  // Call the lighting initialization function
+
+    // try to create a new scene manager object and prepare the 3D scene
+    g_SceneManager = new SceneManager(g_ShaderManager);
+    g_SceneManager->SetMipFilter(g_MipFilter);
+    g_SceneManager->SetTextureCompression(g_bCompressTextures, g_CompressionFormat, g_CompressionQuality);
+    g_SceneManager->SetTexturePacking(g_bPackTextures);
+    g_SceneManager->SetTextureBudget(g_TextureBudget);
+    g_SceneManager->SetVertexPulling(g_bVertexPulling);
+    if (g_bScreenVideoSet)
+    {
+        g_SceneManager->SetScreenVideo(g_ScreenVideo);
+    }
+    g_SceneManager->PrepareScene();
+
+    // loop will keep running until the application is closed 
+    // or until an error has occurred
+    while (!glfwWindowShouldClose(g_Window))
+    {
+        // the state changes are counted per frame, and the counts
+        // of the last frame are printed now and then
+        GLStateCache& stateCache = g_ShaderManager->GetStateCache();
+        stateCache.BeginFrame();
+        if ((g_FrameCount > 0) && (g_FrameCount % STATE_STATS_INTERVAL == 0))
+        {
+            stateCache.LogFrameStats();
+            g_SceneManager->LogTextureResidency();
+            g_SceneManager->LogRenderQueue();
+        }
+        g_FrameCount++;
+
+        // Enable z-depth
+        stateCache.Enable(GL_DEPTH_TEST);
+
+        // Clear the frame and z buffers
+        stateCache.ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // pick up the shader variants that finished compiling -
+        // until then the scene is drawn with the fallback shader
+        g_ShaderManager->PollCompileQueue();
+
+        // stream the pixels of the scene textures, a part per frame
+        g_SceneManager->UpdateTextureStreaming();
+
+        // convert from 3D object space to 2D view
+        g_ViewManager->PrepareSceneView();
+
+        // refresh the 3D scene, requesting the texture levels
+        // that the view needs
+        g_SceneManager->SetSceneView(
+            g_ViewManager->GetViewMatrix(),
+            g_ViewManager->GetProjectionMatrix(),
+            g_ViewManager->GetViewportHeight());
+        g_SceneManager->RenderScene();
+
+        // Flips the the back buffer with the front buffer every frame.
+        glfwSwapBuffers(g_Window);
+
+        // query the latest GLFW events
+        glfwPollEvents();
+    }
+
+    // clear the allocated manager objects from memory
+    if (NULL != g_SceneManager)
+    {
+        delete g_SceneManager;
+        g_SceneManager = NULL;
+    }
+    if (NULL != g_ViewManager)
+    {
+        delete g_ViewManager;
+        g_ViewManager = NULL;
+    }
+    if (NULL != g_ShaderManager)
+    {
+        delete g_ShaderManager;
+        g_ShaderManager = NULL;
+    }
+
+    // Terminates the program successfully
+    exit(EXIT_SUCCESS);
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ *
+ *  This function is used to initialize the GLFW library.
+ ***********************************************************/
+bool InitializeGLFW()
+{
+    // GLFW: initialize and configure library
+    glfwInit();
+
+#ifdef __APPLE__
+    // set the version of OpenGL and profile to use
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+    // set the version of OpenGL and profile to use
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+    // GLFW: end -------------------------------
+
+    return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+    // GLEW: initialize
+    GLenum GLEWInitResult = GLEW_OK;
+
+    // try to initialize the GLEW library
+    GLEWInitResult = glewInit();
+    if (GLEW_OK != GLEWInitResult)
+    {
+        std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+        return false;
+    }
+    // GLEW: end -------------------------------
+
+    // Displays a successful OpenGL initialization message
+    std::cout << "INFO: OpenGL Successfully Initialized\n";
+    std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+    return(true);
+}
+
+/***********************************************************
+ *  initLighting()
+ *
+ *  This function sets up the lighting parameters for the scene.
+ ***********************************************************/
+void initLighting() {
+    glEnable(GL_LIGHTING);  // Enable the lighting system
+    glEnable(GL_LIGHT0);    // Enable the first light source (GL_LIGHT0)
+    g_ShaderManager->GetStateCache().Enable(GL_DEPTH_TEST); // Enable depth testing for correct rendering order
+
+    // Light properties
+    GLfloat lightPos[] = { 1.0f, 1.0f, 1.0f, 0.0f };  // Directional light
+    GLfloat ambientLight[] = { 0.2f, 0.2f, 0.2f, 1.0f };  // Ambient color
+    GLfloat diffuseLight[] = { 0.8f, 0.8f, 0.8f, 1.0f };  // Diffuse color
+    GLfloat specularLight[] = { 1.0f, 1.0f, 1.0f, 1.0f }; // Specular color
+
+    // Apply properties to GL_LIGHT0
+    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+    glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
+    glLightfv(GL_LIGHT0, GL_SPECULAR, specularLight);
+
+    // Optional: Set material properties for objects being drawn
+    GLfloat materialSpecular[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    GLfloat materialShininess[] = { 50.0f };
+
+    glMaterialfv(GL_FRONT, GL_SPECULAR, materialSpecular);
+    glMaterialfv(GL_FRONT, GL_SHININESS, materialShininess);
+}
+
+/***********************************************************
+ *  UseSpirvShaders()
+ *
+ *  This function is used for switching the shader variants
+ *  of the passed in shader manager to the SPIR-V modules.
+ ***********************************************************/
+bool UseSpirvShaders(ShaderManager* pShaderManager)
+{
+    return(pShaderManager->SetSpirvShaders(
+        VERTEX_SPIRV_PATH,
+        FRAGMENT_SPIRV_PATH,
+        ShaderUniforms::SpecializationConstants,
+        sizeof(ShaderUniforms::SpecializationConstants) / sizeof(ShaderUniforms::SpecializationConstants[0])));
+}
+
+/***********************************************************
+ *  RunShaderBenchmark()
+ *
+ *  This function is used for timing how long the scene
+ *  shader variants take to build from the GLSL files and from
+ *  the SPIR-V modules.  The program cache is turned off, but
+ *  the driver may keep its own cache, which should be turned
+ *  off too (MESA_SHADER_CACHE_DISABLE=true on Mesa).
+ ***********************************************************/
+void RunShaderBenchmark()
+{
+    const char* pathNames[2] = { "GLSL", "SPIR-V" };
+
+    printf("Shader benchmark - set MESA_SHADER_CACHE_DISABLE=true or turn off the driver shader cache for cold timings\n");
+
+    for (int path = 0; path < 2; path++)
+    {
+        double totalMs = 0.0;
+        double minMs = 0.0;
+
+        for (int run = 0; run < SHADER_BENCHMARK_RUNS; run++)
+        {
+            ShaderManager shaderManager;
+            shaderManager.SetProgramCacheDirectory("");
+            shaderManager.RegisterUniforms(
+                ShaderUniforms::All,
+                sizeof(ShaderUniforms::All) / sizeof(ShaderUniforms::All[0]));
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            shaderManager.LoadShaders(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+            if ((path == 1) && (UseSpirvShaders(&shaderManager) == false))
+            {
+                printf("SPIR-V shaders are not available, skipping\n");
+                break;
+            }
+
+            // the same variants that the scene loads
+            for (int textured = 0; textured < 2; textured++)
+            {
+                for (int lit = 0; lit < 2; lit++)
+                {
+                    ShaderManager::ShaderDefines defines;
+                    if (textured)
+                    {
+                        defines.push_back({ "USE_TEXTURE", "1" });
+                    }
+                    if (lit)
+                    {
+                        defines.push_back({ "USE_LIGHTING", "1" });
+                        defines.push_back({ "TOTAL_LIGHTS", "1" });
+                    }
+                    shaderManager.LoadShaderVariant(defines);
+                }
+            }
+            while (shaderManager.PollCompileQueue() > 0)
+            {
+            }
+
+            double elapsedMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            totalMs += elapsedMs;
+            if ((run == 0) || (elapsedMs < minMs))
+            {
+                minMs = elapsedMs;
+            }
+
+            if (run == SHADER_BENCHMARK_RUNS - 1)
+            {
+                printf("%s shaders: min %.2f ms, average %.2f ms over %d runs\n",
+                    pathNames[path], minMs, totalMs / SHADER_BENCHMARK_RUNS, SHADER_BENCHMARK_RUNS);
+            }
+        }
+    }
+}
+
+/***********************************************************
+ *  RunVertexBenchmark()
+ *
+ *  This function is used for timing how long the GPU takes
+ *  to draw a grid of sphere instances with the vertices
+ *  fetched as vertex attributes and with them pulled from
+ *  the storage buffer.  Both paths read the same packed
+ *  vertex buffer with the same colored, unlit variant and
+ *  one multi-draw command, so the difference between them is
+ *  the vertex fetch.  The first frame of each path is not
+ *  counted, since it includes the driver's first use of the
+ *  program and buffers.
+ ***********************************************************/
+void RunVertexBenchmark()
+{
+    const char* pathNames[2] = { "Vertex attributes", "Vertex pulling" };
+    const InstancedMeshes::VERTEX_FETCH fetches[2] =
+    {
+        InstancedMeshes::FETCH_VERTEX_ARRAY,
+        InstancedMeshes::FETCH_VERTEX_PULLING
+    };
+
+    // look down at the whole grid
+    const float spacing = 2.5f;
+    const float gridSize = VERTEX_BENCHMARK_GRID * spacing;
+    glm::vec3 eye(0.0f, gridSize * 0.6f, gridSize * 0.8f);
+    FRAME_DATA frameData;
+    frameData.view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    frameData.projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, gridSize * 4.0f);
+    frameData.viewPosition = glm::vec4(eye, 1.0f);
+
+    FrameDataBuffer frameDataBuffer;
+    frameDataBuffer.Create();
+
+    std::vector<INSTANCE_DATA> instances;
+    for (int row = 0; row < VERTEX_BENCHMARK_GRID; row++)
+    {
+        for (int column = 0; column < VERTEX_BENCHMARK_GRID; column++)
+        {
+            INSTANCE_DATA instance;
+            instance.model = glm::translate(glm::vec3(
+                (column + 0.5f) * spacing - gridSize * 0.5f,
+                0.0f,
+                (row + 0.5f) * spacing - gridSize * 0.5f));
+            instance.color = glm::vec4((float)column / VERTEX_BENCHMARK_GRID, (float)row / VERTEX_BENCHMARK_GRID, 0.5f, 1.0f);
+            instance.atlasRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            instance.uvScale = glm::vec2(1.0f, 1.0f);
+            instance.texture = glm::ivec2(0, 0);
+            instance.materialIndex = -1;
+            instance.padding[0] = 0;
+            instance.padding[1] = 0;
+            instance.padding[2] = 0;
+            instances.push_back(instance);
+        }
+    }
+
+    glEnable(GL_DEPTH_TEST);
+    GLuint queryID = 0;
+    glGenQueries(1, &queryID);
+
+    for (int path = 0; path < 2; path++)
+    {
+        InstancedMeshes meshes;
+        if ((meshes.Create(fetches[path]) == false) || (meshes.GetVertexFetch() != fetches[path]))
+        {
+            printf("%s are not available, skipping\n", pathNames[path]);
+            continue;
+        }
+
+        ShaderManager shaderManager;
+        shaderManager.RegisterUniforms(
+            ShaderUniforms::All,
+            sizeof(ShaderUniforms::All) / sizeof(ShaderUniforms::All[0]));
+        shaderManager.LoadShaders(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+
+        ShaderManager::ShaderDefines defines;
+        if (fetches[path] == InstancedMeshes::FETCH_VERTEX_PULLING)
+        {
+            defines.push_back({ "USE_VERTEX_PULLING", "1" });
+        }
+        int program = shaderManager.LoadShaderVariant(defines);
+        while (shaderManager.PollCompileQueue() > 0)
+        {
+        }
+        if (shaderManager.IsProgramReady(program) == false)
+        {
+            printf("%s shader failed to build, skipping\n", pathNames[path]);
+            continue;
+        }
+        shaderManager.UseProgram(program);
+        shaderManager.setBoolValue(ShaderUniforms::Instanced, true);
+
+        std::vector<DRAW_ELEMENTS_INDIRECT_COMMAND> commands;
+        commands.push_back(meshes.MakeCommand(InstancedMeshes::INSTANCED_SPHERE, 0));
+        commands[0].instanceCount = (GLuint)instances.size();
+        meshes.UploadFrame(instances, commands);
+
+        double totalMs = 0.0;
+        double minMs = 0.0;
+        for (int frame = 0; frame <= VERTEX_BENCHMARK_FRAMES; frame++)
+        {
+            frameDataBuffer.Update(frameData);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            glBeginQuery(GL_TIME_ELAPSED, queryID);
+            meshes.DrawCommands(0, 1);
+            glEndQuery(GL_TIME_ELAPSED);
+
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(queryID, GL_QUERY_RESULT, &elapsedNs);
+            double elapsedMs = elapsedNs / 1000000.0;
+            if (frame == 0)
+            {
+                continue;
+            }
+            totalMs += elapsedMs;
+            if ((frame == 1) || (elapsedMs < minMs))
+            {
+                minMs = elapsedMs;
+            }
+        }
+
+        printf("%s: min %.3f ms, average %.3f ms of GPU time over %d frames of %d vertices\n",
+            pathNames[path],
+            minMs,
+            totalMs / VERTEX_BENCHMARK_FRAMES,
+            VERTEX_BENCHMARK_FRAMES,
+            (int)(commands[0].count * commands[0].instanceCount));
+    }
+
+    glDeleteQueries(1, &queryID);
+}
+
+/***********************************************************
+ *  CookTextures()
+ *
+ *  This function is used for cooking each of the passed in
+ *  image files into a cooked texture file next to it, which
+ *  the scene loads instead of decoding the image.  The levels
+ *  are block compressed unless texture compression is off.
+ ***********************************************************/
+int CookTextures(int fileCount, char* files[])
+{
+    if (fileCount == 0)
+    {
+        std::cout << "Usage: --cook-textures <image file>..." << std::endl;
+        return(EXIT_FAILURE);
+    }
+
+    TextureCompressor* pCompressor = NULL;
+    if (g_bCompressTextures)
+    {
+        pCompressor = new TextureCompressor();
+    }
+
+    int failedCount = 0;
+    for (int i = 0; i < fileCount; i++)
+    {
+        if (CookedTexture::Cook(
+            files[i], CookedTexture::GetCookedPath(files[i]), g_MipFilter,
+            pCompressor, g_CompressionFormat, g_CompressionQuality) == false)
+        {
+            failedCount++;
+        }
+    }
+
+    delete pCompressor;
+
+    return((failedCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *  RunCompressBenchmark()
+ *
+ *  This function is used for timing the texture compressor
+ *  on level 0 of each of the passed in image files, for every
+ *  format and quality, on one thread and on every hardware
+ *  thread.  The speed is reported in megapixels per second,
+ *  in total and per core.
+ ***********************************************************/
+int RunCompressBenchmark(int fileCount, char* files[])
+{
+    const char* formatNames[4] = { "auto", "BC1", "BC3", "BC7" };
+    const char* qualityNames[3] = { "fast", "normal", "high" };
+
+    if (fileCount == 0)
+    {
+        std::cout << "Usage: --compress-benchmark <image file>..." << std::endl;
+        return(EXIT_FAILURE);
+    }
+
+    // decode the images up front, so only compressing is timed
+    std::vector<TEXTURE_DATA> textures;
+    {
+        TextureDecoder decoder;
+        std::vector<int> tickets;
+        for (int i = 0; i < fileCount; i++)
+        {
+            tickets.push_back(decoder.Submit(files[i], true));
+        }
+        for (size_t i = 0; i < tickets.size(); i++)
+        {
+            TextureDecoder::DECODED_IMAGE image;
+            TEXTURE_DATA texture;
+            if ((decoder.WaitForImage(tickets[i], image)) && (TextureDecoder::TakeTextureData(image, texture)))
+            {
+                texture.bGenerateMipmaps = false;
+                textures.push_back(texture);
+            }
+            else
+            {
+                TextureDecoder::FreeImage(image);
+            }
+        }
+    }
+
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    unsigned int threadCounts[2] = { 1, (hardwareThreads > 1) ? hardwareThreads : 1 };
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if ((pass == 1) && (threadCounts[1] == 1))
+        {
+            break;
+        }
+
+        TextureCompressor compressor(threadCounts[pass]);
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            double megapixels = (double)textures[i].width * textures[i].height / 1000000.0;
+            for (int format = TextureCompressor::FORMAT_BC1; format <= TextureCompressor::FORMAT_BC7; format++)
+            {
+                for (int quality = TextureCompressor::QUALITY_FAST; quality <= TextureCompressor::QUALITY_HIGH; quality++)
+                {
+                    double minMs = 0.0;
+                    for (int run = 0; run < COMPRESS_BENCHMARK_RUNS; run++)
+                    {
+                        TEXTURE_DATA compressed;
+                        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                        compressor.Compress(
+                            textures[i],
+                            (TextureCompressor::COMPRESSION_FORMAT)format,
+                            (TextureCompressor::COMPRESSION_QUALITY)quality,
+                            compressed);
+                        double elapsedMs = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start).count();
+                        if ((run == 0) || (elapsedMs < minMs))
+                        {
+                            minMs = elapsedMs;
+                        }
+                    }
+
+                    double megapixelsPerSecond = megapixels / (minMs / 1000.0);
+                    printf("%s %s %s: %u threads, %.2f ms, %.2f MP/s, %.2f MP/s per core\n",
+                        textures[i].filename.c_str(), formatNames[format], qualityNames[quality],
+                        compressor.GetThreadCount(), minMs, megapixelsPerSecond,
+                        megapixelsPerSecond / compressor.GetThreadCount());
+                }
+            }
+        }
+    }
+
+    return(EXIT_SUCCESS);
+}
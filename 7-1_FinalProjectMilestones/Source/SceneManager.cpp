@@ -1,550 +1,1708 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.cpp
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager* pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-
-	// initialize the texture collection
-	for (int i = 0; i < 16; i++)
-	{
-		m_textureIDs[i].tag = "/0";
-		m_textureIDs[i].ID = -1;
-	}
-	m_loadedTextures = 0;
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	// clear the allocated memory
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-	// destroy the created OpenGL textures
-	DestroyGLTextures();
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
-  *  LoadSceneTextures()
-  *
-  *  This method is used for preparing the 3D scene by loading
-  *  the shapes, textures in memory to support the 3D scene
-  *  rendering
-  ***********************************************************/
-void SceneManager::LoadSceneTextures()
-{
-	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
-
-	bool bReturn = false;
-
-	bReturn = CreateGLTexture("../../Utilities/textures/tilesf2.jpg", "floor");
-	bReturn = CreateGLTexture("../../Utilities/textures/cheese_wheel.jpg", "cone");
-	bReturn = CreateGLTexture("../../Utilities/textures/gold-seamless-texture.jpg", "gold");
-	bReturn = CreateGLTexture("../../Utilities/textures/knife_handle.jpg", "wood");
-	bReturn = CreateGLTexture("../../Utilities/textures/keys.png", "keys");
-
-	// after the texture image data is loaded into memory, thed
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
-	BindGLTextures();
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-	LoadSceneTextures();
-	m_basicMeshes->LoadPlaneMesh();
-	//TODO load your shape meshes
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_pShaderManager->setVec3Value("light.position", lightPos);
-	m_pShaderManager->setVec3Value("light.color", lightColor);
-	m_pShaderManager->setFloatValue("light.intensity", 1.0f); // Set light intensity
-}
-
-void SceneManager::DrawLaptopMesh(glm::vec3 position, float rotationAngle, glm::vec3 scale) {
-	// Combine transformation matrices for the whole laptop object
-
-	// Base of the laptop (bottom half)
-	glm::vec3 baseScale = glm::vec3(12.0f, 6.0f, 10.0f);
-	glm::vec3 basePosition = position + glm::vec3(0.0f, -1.0f, 0.0f);
-	float baseRotationX = 12.0f;
-
-	SetTransformations(
-		baseScale,
-		baseRotationX,
-		0.0f,
-		0.0f,
-		basePosition);
-	SetShaderColor(0.72, 0.75, 0.75, 1.0);
-	//SetShaderTexture("keys");
-	m_basicMeshes->DrawBoxMesh();
-
-	// Top screen of the laptop
-	glm::vec3 screenScale = glm::vec3(13.0f, 8.1f, 3.0f);
-	glm::vec3 screenPosition = position + glm::vec3(0.0f, 5.0f, -10.0f);
-	float screenRotationX = -19.0f;
-
-	SetTransformations(
-		screenScale,
-		screenRotationX,
-		0.0f,
-		0.0f,
-		screenPosition);
-	SetShaderColor(0.21, 0.21, 0.21, 1.0);
-	m_basicMeshes->DrawBoxMesh();
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-
-	// Set up a position and transformation for the whole laptop object
-	glm::vec3 laptopPosition = glm::vec3(0.0f, 0.0f, 0.0f);
-	float laptopRotationAngle = 0.0f;
-	glm::vec3 laptopScale = glm::vec3(1.0f, 1.0f, 1.0f); // No additional scaling for the whole laptop
-	DrawLaptopMesh(laptopPosition, laptopRotationAngle, laptopScale);
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-	// set the color values into the shader
-	//SetShaderColor(1, 1, 1, 1);
-	SetShaderTexture("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 9.0f, -10.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	// set the color values into the shader
-	SetShaderColor(1, 1, 1, 1);
-	SetShaderTexture("wood");
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+#include "ShaderUniforms.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// position and color of the scene light source
+	const glm::vec3 g_LightPosition = glm::vec3(1.0f, 1.0f, 1.0f);
+	const glm::vec3 g_LightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+
+	// the most texture bytes that are streamed into the textures
+	// each frame
+	const size_t g_TextureUploadBudget = 8 * 1024 * 1024;
+	// the largest level that a texture starts with, before the
+	// view asks for more detail
+	const int g_TextureStartSize = 64;
+	// the radius of a sphere around each basic mesh, by
+	// MESH_TYPE, for sizing the meshes on the screen
+	const float g_MeshRadius[] = { 0.87f, 1.42f, 1.42f, 1.0f };
+
+	// the size of the atlas pages, the largest image that is
+	// packed into them, and the border of texels around each
+	// packed image
+	const int g_AtlasPageSize = 1024;
+	const int g_AtlasMaxTextureSize = 512;
+	const int g_AtlasPadding = 8;
+
+	// the image sequence that plays on the laptop screen, and
+	// its frames per second
+	const char* const g_ScreenVideoPath = "../../Utilities/textures/screen/frame%03d.jpg";
+	const double g_ScreenVideoFrameRate = 30.0;
+}
+
+
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_basicMeshes = new ShapeMeshes();
+	m_pTextureDecoder = NULL;
+	m_pMipGenerator = NULL;
+	m_mipFilter = MipGenerator::FILTER_KAISER;
+	m_pTextureCompressor = NULL;
+	m_bCompressTextures = false;
+	m_compressionFormat = TextureCompressor::FORMAT_AUTO;
+	m_compressionQuality = TextureCompressor::QUALITY_NORMAL;
+	m_bPackTextures = true;
+	m_pTextureUploader = NULL;
+
+	// the texture arrays are passed to the shaders as bindless
+	// handles when the driver supports them - the SPIR-V shaders
+	// always take them on texture units
+	m_pTextureArrays = NULL;
+	m_bBindlessTextures = (GLEW_ARB_bindless_texture) && (!m_pShaderManager->IsSpirvEnabled());
+	m_pTextureResidency = NULL;
+	m_textureBudget = 256 * 1024 * 1024;
+	m_viewProjection = glm::mat4(1.0f);
+	m_projectionScale = 1.0f;
+	m_viewportHeight = 0;
+	m_pScreenVideo = NULL;
+	m_screenSource.type = VideoTexture::SOURCE_IMAGE_SEQUENCE;
+	m_screenSource.path = g_ScreenVideoPath;
+	m_screenSource.width = 0;
+	m_screenSource.height = 0;
+	m_screenSource.colorChannels = 0;
+	m_screenSource.frameRate = g_ScreenVideoFrameRate;
+
+	// initialize the draw state to the shader defaults
+	m_drawState.model = glm::mat4(1.0f);
+	m_drawState.color = glm::vec4(1.0f);
+	m_drawState.textureSlot = -1;
+	m_drawState.uvScale = glm::vec2(1.0f, 1.0f);
+	m_drawState.materialIndex = -1;
+	m_pMaterialTable = NULL;
+	m_pInstancedMeshes = NULL;
+	m_bVertexPulling = false;
+
+	for (int textured = 0; textured < 2; textured++)
+	{
+		for (int lit = 0; lit < 2; lit++)
+		{
+			m_shaderVariants[textured][lit] = -1;
+		}
+		m_lightsGeneration[textured] = 0;
+		m_textureArraysGeneration[textured] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	// clear the allocated memory
+	m_pShaderManager = NULL;
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+	if (NULL != m_pInstancedMeshes)
+	{
+		delete m_pInstancedMeshes;
+		m_pInstancedMeshes = NULL;
+	}
+	if (NULL != m_pTextureDecoder)
+	{
+		delete m_pTextureDecoder;
+		m_pTextureDecoder = NULL;
+	}
+	if (NULL != m_pMipGenerator)
+	{
+		delete m_pMipGenerator;
+		m_pMipGenerator = NULL;
+	}
+	if (NULL != m_pTextureCompressor)
+	{
+		delete m_pTextureCompressor;
+		m_pTextureCompressor = NULL;
+	}
+	if (NULL != m_pTextureUploader)
+	{
+		delete m_pTextureUploader;
+		m_pTextureUploader = NULL;
+	}
+	if (NULL != m_pMaterialTable)
+	{
+		delete m_pMaterialTable;
+		m_pMaterialTable = NULL;
+	}
+	// destroy the created OpenGL textures
+	DestroyGLTextures();
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.  The texture
+ *  is ready when this returns - use QueueGLTexture() to load
+ *  several textures in parallel and stream them in.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, const std::string& tag)
+{
+	if (QueueGLTexture(filename, tag) == false)
+	{
+		return(false);
+	}
+
+	bool bCreated = (UploadQueuedTextures() == 1);
+	if (NULL != m_pTextureUploader)
+	{
+		m_pTextureUploader->Flush();
+	}
+
+	return(bCreated);
+}
+
+/***********************************************************
+ *  QueueGLTexture()
+ *
+ *  This method is used for queueing an image file to be
+ *  loaded under a tag.  When a texture with the same file
+ *  contents is loaded or queued already, the tag shares it
+ *  instead.  When a cooked file sits next to the image, it
+ *  is mapped and used as is, with its precomputed mipmaps.
+ *  Otherwise the image is decoded on the texture decoder's
+ *  worker threads.  The texture is created by the next
+ *  UploadQueuedTextures().
+ ***********************************************************/
+bool SceneManager::QueueGLTexture(const char* filename, const std::string& tag)
+{
+	PENDING_TEXTURE pending;
+	pending.ticket = -1;
+
+	// the cooked texture is owned by its texture data, so the
+	// mapping lasts until its levels are uploaded
+	std::shared_ptr<CookedTexture> pCooked = std::make_shared<CookedTexture>();
+	bool bCooked =
+		(pCooked->Open(CookedTexture::GetCookedPath(filename))) &&
+		(pCooked->GetTextureData(pending.cooked));
+	uint64_t contentHash = bCooked ?
+		TextureRegistry::HashBytes(pCooked->GetData(), pCooked->GetSize()) :
+		TextureRegistry::HashFile(filename);
+
+	int tagID = m_textureRegistry.InternTag(tag);
+	int texture = m_textureRegistry.FindContent(contentHash);
+	if (texture >= 0)
+	{
+		std::cout << "Sharing the texture of " << m_textureRegistry.GetTexture(texture).filename << " for " << filename << std::endl;
+		FreeGLTexture(m_textureRegistry.BindTag(tagID, texture));
+		return(true);
+	}
+
+	texture = m_textureRegistry.AddTexture(contentHash, filename);
+	FreeGLTexture(m_textureRegistry.BindTag(tagID, texture));
+	pending.texture = texture;
+
+	if (bCooked)
+	{
+		pending.cooked.pOwner = pCooked;
+		m_pendingTextures.push_back(pending);
+		return(true);
+	}
+
+	if (NULL == m_pTextureDecoder)
+	{
+		m_pTextureDecoder = new TextureDecoder();
+	}
+
+	// indicate to always flip images vertically when loaded
+	pending.ticket = m_pTextureDecoder->Submit(filename, true);
+	m_pendingTextures.push_back(pending);
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadQueuedTextures()
+ *
+ *  This method is used for creating the OpenGL textures of
+ *  the queued image files.  The small decoded images are
+ *  packed into shared atlas pages first, then the mipmaps of
+ *  the images and pages are built and compressed.  The
+ *  textures are stored as layers of texture arrays, one array
+ *  for each size and format in the batch, in the order they
+ *  were queued, so the layers do not depend on which file
+ *  decodes first.  Returns the number of textures created.
+ ***********************************************************/
+int SceneManager::UploadQueuedTextures()
+{
+	int createdTextures = 0;
+	// the textures that are uploaded - cooked files, decoded
+	// images that were not packed, and atlas pages
+	std::vector<TEXTURE_DATA> textures;
+	// for each registered texture, the texture that holds it
+	// and its rectangle there
+	std::vector<int> handles;
+	std::vector<size_t> holders;
+	std::vector<glm::vec4> atlasRects;
+	// the decoded images, which may be packed
+	std::vector<TEXTURE_DATA> decoded;
+	std::vector<int> decodedHandles;
+
+	for (size_t i = 0; i < m_pendingTextures.size(); i++)
+	{
+		if (m_pendingTextures[i].ticket < 0)
+		{
+			const TEXTURE_DATA& cooked = m_pendingTextures[i].cooked;
+			if (m_pendingTextures[i].texture < 0)
+			{
+				continue;
+			}
+			std::cout << "Successfully mapped cooked image:" << cooked.filename << ", width:" << cooked.width << ", height:" << cooked.height << ", levels:" << cooked.levels.size() << std::endl;
+			handles.push_back(m_pendingTextures[i].texture);
+			holders.push_back(textures.size());
+			atlasRects.push_back(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+			textures.push_back(cooked);
+			continue;
+		}
+
+		TextureDecoder::DECODED_IMAGE image;
+		if (m_pTextureDecoder->WaitForImage(m_pendingTextures[i].ticket, image) == false)
+		{
+			std::cout << "Could not load image:" << image.filename << std::endl;
+			continue;
+		}
+
+		// the texture was released while its file was decoded
+		if (m_pendingTextures[i].texture < 0)
+		{
+			TextureDecoder::FreeImage(image);
+			continue;
+		}
+
+		// only RGB and RGBA images are handled
+		TEXTURE_DATA texture;
+		if (TextureDecoder::TakeTextureData(image, texture) == false)
+		{
+			std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+			TextureDecoder::FreeImage(image);
+			continue;
+		}
+
+		std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+
+		decoded.push_back(texture);
+		decodedHandles.push_back(m_pendingTextures[i].texture);
+	}
+	m_pendingTextures.clear();
+
+	// the small images share atlas pages, so they take one layer
+	// of one array between them
+	std::vector<TEXTURE_DATA> pages;
+	std::vector<TextureAtlas::ATLAS_PLACEMENT> placements;
+	if (m_bPackTextures)
+	{
+		TextureAtlas atlas(g_AtlasPageSize, g_AtlasMaxTextureSize, g_AtlasPadding);
+		atlas.Pack(decoded, pages, placements);
+	}
+	else
+	{
+		placements.assign(decoded.size(), TextureAtlas::ATLAS_PLACEMENT{ -1, 0.0f, 0.0f, 1.0f, 1.0f });
+	}
+
+	size_t firstPage = textures.size();
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		BuildTextureLevels(pages[i]);
+		textures.push_back(pages[i]);
+	}
+	for (size_t i = 0; i < decoded.size(); i++)
+	{
+		const TextureAtlas::ATLAS_PLACEMENT& placement = placements[i];
+		handles.push_back(decodedHandles[i]);
+		if (placement.page >= 0)
+		{
+			holders.push_back(firstPage + placement.page);
+			atlasRects.push_back(glm::vec4(placement.offsetU, placement.offsetV, placement.scaleU, placement.scaleV));
+			continue;
+		}
+
+		BuildTextureLevels(decoded[i]);
+		holders.push_back(textures.size());
+		atlasRects.push_back(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+		textures.push_back(decoded[i]);
+	}
+	// the pages hold the pixels of the packed images now
+	decoded.clear();
+
+	if (textures.empty())
+	{
+		return(0);
+	}
+
+	CreateTextureArrays();
+
+	// the texture storage is allocated here, and the pixels are
+	// streamed in by the texture uploader, which keeps them
+	// alive until they are uploaded
+	std::vector<TextureArraySet::TEXTURE_LAYER> layers;
+	m_pTextureArrays->AddTextures(textures, m_pTextureUploader, g_TextureStartSize, layers);
+	if (NULL == m_pTextureResidency)
+	{
+		m_pTextureResidency = new TextureResidency(m_pTextureArrays, m_pTextureUploader, m_textureBudget);
+	}
+
+	std::vector<bool> bLayerUsed(textures.size(), false);
+	for (size_t i = 0; i < handles.size(); i++)
+	{
+		const TextureArraySet::TEXTURE_LAYER& layer = layers[holders[i]];
+		if (layer.arrayIndex < 0)
+		{
+			continue;
+		}
+
+		// each texture packed into a page holds on to the page
+		if (bLayerUsed[holders[i]])
+		{
+			m_pTextureArrays->RetainLayer(layer.arrayIndex, layer.layer);
+		}
+		bLayerUsed[holders[i]] = true;
+
+		// record where the texture of the tags was stored
+		m_textureRegistry.SetLoaded(handles[i], layer.arrayIndex, layer.layer, atlasRects[i]);
+		createdTextures++;
+	}
+
+	// the shader variants pick up the new arrays on their next draw
+	for (int lit = 0; lit < 2; lit++)
+	{
+		m_textureArraysGeneration[lit] = 0;
+	}
+
+	return(createdTextures);
+}
+
+/***********************************************************
+ *  CreateTextureArrays()
+ *
+ *  This method is used for creating the texture uploader and
+ *  the texture arrays with the first textures that need them.
+ ***********************************************************/
+void SceneManager::CreateTextureArrays()
+{
+	if (NULL == m_pTextureUploader)
+	{
+		m_pTextureUploader = new TextureUploader(&m_pShaderManager->GetStateCache());
+	}
+	if (NULL == m_pTextureArrays)
+	{
+		m_pTextureArrays = new TextureArraySet(
+			&m_pShaderManager->GetStateCache(),
+			ShaderUniforms::MaxTextureArrays,
+			m_bBindlessTextures);
+	}
+}
+
+/***********************************************************
+ *  LoadScreenVideo()
+ *
+ *  This method is used for opening the video of the laptop
+ *  screen and creating the texture that it plays into, which
+ *  is a dynamic texture array of the size of its frames,
+ *  under the "screen" tag.  Without the video the screen is
+ *  drawn with its color.
+ ***********************************************************/
+bool SceneManager::LoadScreenVideo()
+{
+	if (m_screenSource.path.empty())
+	{
+		return(false);
+	}
+
+	VideoTexture* pVideo = new VideoTexture(&m_pShaderManager->GetStateCache());
+	if (pVideo->Open(m_screenSource) == false)
+	{
+		delete pVideo;
+		return(false);
+	}
+
+	CreateTextureArrays();
+	int arrayIndex = m_pTextureArrays->AddDynamicArray(
+		m_pTextureUploader,
+		pVideo->GetWidth(),
+		pVideo->GetHeight(),
+		pVideo->GetInternalFormat());
+	if (arrayIndex < 0)
+	{
+		delete pVideo;
+		return(false);
+	}
+	pVideo->SetTarget(m_pTextureArrays->GetArrayID(arrayIndex), 0);
+
+	// the frames change, so the texture is never shared by its
+	// contents
+	int texture = m_textureRegistry.AddTexture(0, m_screenSource.path);
+	FreeGLTexture(m_textureRegistry.BindTag(m_textureRegistry.InternTag("screen"), texture));
+	m_textureRegistry.SetLoaded(texture, arrayIndex, 0, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+	m_pScreenVideo = pVideo;
+
+	for (int lit = 0; lit < 2; lit++)
+	{
+		m_textureArraysGeneration[lit] = 0;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildTextureLevels()
+ *
+ *  This method is used for building the mipmaps of a decoded
+ *  image or atlas page on the CPU, in linear space, so they
+ *  come out the same on every driver, and block compressing
+ *  the levels when that is enabled.  The compressed texture
+ *  takes the place of the pixels, which are freed along with
+ *  the last copy of them.
+ ***********************************************************/
+void SceneManager::BuildTextureLevels(TEXTURE_DATA& texture)
+{
+	if (NULL == m_pMipGenerator)
+	{
+		m_pMipGenerator = new MipGenerator();
+	}
+	TEXTURE_DATA mipmapped;
+	if (m_pMipGenerator->Generate(texture, m_mipFilter, true, mipmapped))
+	{
+		texture = mipmapped;
+	}
+
+	if ((m_bCompressTextures) && (TextureCompressor::IsFormatSupported(m_compressionFormat)))
+	{
+		if (NULL == m_pTextureCompressor)
+		{
+			m_pTextureCompressor = new TextureCompressor();
+		}
+
+		TEXTURE_DATA compressed;
+		if (m_pTextureCompressor->Compress(texture, m_compressionFormat, m_compressionQuality, compressed))
+		{
+			texture = compressed;
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateTextureStreaming()
+ *
+ *  This method is used for streaming the pixels of the newly
+ *  created textures into OpenGL, and is called once per
+ *  frame.  Each frame uploads no more than the upload budget.
+ *  The newest due frame of the screen video is uploaded.
+ *  Then the texture levels are streamed towards the levels
+ *  that the draws of the last frame requested, within the
+ *  texture memory budget.
+ ***********************************************************/
+void SceneManager::UpdateTextureStreaming()
+{
+	if (NULL != m_pTextureUploader)
+	{
+		m_pTextureUploader->Update(g_TextureUploadBudget);
+	}
+	// the video frames are uploaded on top of the budget, since
+	// a frame that waits is a dropped frame
+	if (NULL != m_pScreenVideo)
+	{
+		m_pScreenVideo->Update();
+	}
+
+	// an array that changed its storage has a new texture for
+	// the shader variants to pick up
+	if ((NULL != m_pTextureResidency) && (m_pTextureResidency->Update()))
+	{
+		for (int lit = 0; lit < 2; lit++)
+		{
+			m_textureArraysGeneration[lit] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetTextureCompression()
+ *
+ *  This method is used for setting whether the decoded
+ *  images are block compressed before they are uploaded, and
+ *  into which format at which quality.  Cooked files are
+ *  uploaded the way they were cooked.
+ ***********************************************************/
+void SceneManager::SetTextureCompression(
+	bool bEnabled,
+	TextureCompressor::COMPRESSION_FORMAT format,
+	TextureCompressor::COMPRESSION_QUALITY quality)
+{
+	m_bCompressTextures = bEnabled;
+	m_compressionFormat = format;
+	m_compressionQuality = quality;
+}
+
+/***********************************************************
+ *  SetMipFilter()
+ *
+ *  This method is used for setting the filter that the
+ *  mipmaps of the decoded images are built with.
+ ***********************************************************/
+void SceneManager::SetMipFilter(MipGenerator::MIP_FILTER filter)
+{
+	m_mipFilter = filter;
+}
+
+/***********************************************************
+ *  SetTexturePacking()
+ *
+ *  This method is used for setting whether the small decoded
+ *  images are packed into shared atlas pages.
+ ***********************************************************/
+void SceneManager::SetTexturePacking(bool bEnabled)
+{
+	m_bPackTextures = bEnabled;
+}
+
+/***********************************************************
+ *  SetVertexPulling()
+ *
+ *  This method is used for setting whether the instanced
+ *  meshes are read by the vertex shaders from a storage
+ *  buffer, by vertex index, instead of through the vertex
+ *  attributes.
+ ***********************************************************/
+void SceneManager::SetVertexPulling(bool bEnabled)
+{
+	m_bVertexPulling = bEnabled;
+}
+
+/***********************************************************
+ *  SetTextureBudget()
+ *
+ *  This method is used for setting the most video memory
+ *  that the texture levels may take.  The levels that do not
+ *  fit are evicted, least recently used first.
+ ***********************************************************/
+void SceneManager::SetTextureBudget(size_t budgetBytes)
+{
+	m_textureBudget = budgetBytes;
+	if (NULL != m_pTextureResidency)
+	{
+		m_pTextureResidency->SetBudget(budgetBytes);
+	}
+}
+
+/***********************************************************
+ *  SetSceneView()
+ *
+ *  This method is used for setting the camera of the frame
+ *  that is about to be rendered, so the draws can tell how
+ *  large their textures appear on the screen.
+ ***********************************************************/
+void SceneManager::SetSceneView(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportHeight)
+{
+	m_viewProjection = projection * view;
+	// the vertical scale of the projection - the pixel size of
+	// an object is its size times this, over its depth for a
+	// perspective projection
+	m_projectionScale = projection[1][1];
+	m_viewportHeight = viewportHeight;
+}
+
+/***********************************************************
+ *  SetScreenVideo()
+ *
+ *  This method is used for setting the image sequence or raw
+ *  video that is played on the laptop screen.  A source
+ *  without a path leaves the screen drawn with its color.
+ ***********************************************************/
+void SceneManager::SetScreenVideo(const VideoTexture::VIDEO_SOURCE& source)
+{
+	m_screenSource = source;
+}
+
+/***********************************************************
+ *  LogTextureResidency()
+ *
+ *  This method is used for printing the bytes of the loaded
+ *  texture levels, the requests that are waiting for more
+ *  detail, and the number of evicted levels, along with the
+ *  upload throughput and dropped frames of the screen video.
+ ***********************************************************/
+void SceneManager::LogTextureResidency() const
+{
+	if (NULL != m_pTextureResidency)
+	{
+		m_pTextureResidency->LogStats();
+	}
+	if (NULL != m_pScreenVideo)
+	{
+		m_pScreenVideo->LogStats();
+	}
+}
+
+/***********************************************************
+ *  LogRenderQueue()
+ *
+ *  This method is used for printing the state changes that
+ *  the draws of the last frame needed, sorted and unsorted,
+ *  and the instanced draw calls that they were drawn with.
+ ***********************************************************/
+void SceneManager::LogRenderQueue() const
+{
+	m_renderQueue.LogStats();
+	if (NULL != m_pInstancedMeshes)
+	{
+		m_pInstancedMeshes->LogStats();
+	}
+}
+
+/***********************************************************
+ *  ReleaseGLTexture()
+ *
+ *  This method is used for letting go of the texture of a
+ *  tag.  The texture is freed once no other tag shares it.
+ ***********************************************************/
+void SceneManager::ReleaseGLTexture(const std::string& tag)
+{
+	FreeGLTexture(m_textureRegistry.ReleaseTag(m_textureRegistry.FindTag(tag)));
+}
+
+/***********************************************************
+ *  FreeGLTexture()
+ *
+ *  This method is used for freeing a texture that lost its
+ *  last tag.  A texture that is still queued is dropped when
+ *  its turn comes, and a loaded one gives back its layer,
+ *  which deletes the texture array with its last layer.
+ ***********************************************************/
+void SceneManager::FreeGLTexture(int texture)
+{
+	if (texture < 0)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_pendingTextures.size(); i++)
+	{
+		if (m_pendingTextures[i].texture == texture)
+		{
+			m_pendingTextures[i].texture = -1;
+			m_pendingTextures[i].cooked = TEXTURE_DATA();
+		}
+	}
+
+	const TextureRegistry::TEXTURE_ENTRY& entry = m_textureRegistry.GetTexture(texture);
+	if ((entry.bLoaded) && (NULL != m_pTextureArrays))
+	{
+		m_pTextureArrays->ReleaseLayer(entry.arrayIndex, entry.layer, m_pTextureUploader);
+
+		// a deleted array must not stay in the shader variants
+		for (int lit = 0; lit < 2; lit++)
+		{
+			m_textureArraysGeneration[lit] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the texture arrays to
+ *  OpenGL texture units, one unit for each array.  Bindless
+ *  texture arrays are resident already and are not bound.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	if ((NULL != m_pTextureArrays) && (m_pTextureArrays->IsBindless() == false))
+	{
+		// the state cache skips the units that already hold them
+		m_pTextureArrays->BindArrays();
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	// the video writes into its texture array
+	if (NULL != m_pScreenVideo)
+	{
+		delete m_pScreenVideo;
+		m_pScreenVideo = NULL;
+	}
+	// the pending uploads refer to the texture arrays
+	if (NULL != m_pTextureUploader)
+	{
+		delete m_pTextureUploader;
+		m_pTextureUploader = NULL;
+	}
+	if (NULL != m_pTextureResidency)
+	{
+		delete m_pTextureResidency;
+		m_pTextureResidency = NULL;
+	}
+	if (NULL != m_pTextureArrays)
+	{
+		delete m_pTextureArrays;
+		m_pTextureArrays = NULL;
+	}
+	m_textureRegistry.Clear();
+	m_pendingTextures.clear();
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting the OpenGL texture that
+ *  holds the loaded texture of the passed in tag, or -1.
+ ***********************************************************/
+int SceneManager::FindTextureID(const std::string& tag)
+{
+	int texture = FindTextureSlot(tag);
+	if (texture < 0)
+	{
+		return(-1);
+	}
+
+	return((int)m_pTextureArrays->GetArrayID(m_textureRegistry.GetTexture(texture).arrayIndex));
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting the registry handle of
+ *  the loaded texture of the passed in tag, or -1 when the
+ *  tag has no texture or it is not loaded yet.  The tag is
+ *  found by its hash, and the texture by its handle.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(const std::string& tag)
+{
+	int texture = m_textureRegistry.GetTagTexture(m_textureRegistry.FindTag(tag));
+	if ((texture < 0) || (m_textureRegistry.GetTexture(texture).bLoaded == false))
+	{
+		return(-1);
+	}
+
+	return(texture);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
+{
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
+	{
+		return(false);
+	}
+
+	material = m_objectMaterials[index];
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of the material
+ *  of the passed in tag in the material table, which is the
+ *  same as its index in the defined materials list.  The tag
+ *  is found by its hash.  Returns -1 for an unknown tag, or
+ *  before the table is packed.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_materialIndices.find(tag);
+	return((found != m_materialIndices.end()) ? found->second : -1);
+}
+
+/***********************************************************
+  *  LoadSceneTextures()
+  *
+  *  This method is used for preparing the 3D scene by loading
+  *  the shapes, textures in memory to support the 3D scene
+  *  rendering
+  ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	/*** STUDENTS - add the code BELOW for loading the textures that ***/
+	/*** will be used for mapping to objects in the 3D scene. Any    ***/
+	/*** number of textures can be loaded, in up to 16 different     ***/
+	/*** sizes. Refer to the code in the OpenGL Sample for help.     ***/
+
+	bool bReturn = false;
+
+	// the image files are decoded in parallel on worker threads,
+	// then uploaded to OpenGL here in the order they are queued
+	bReturn = QueueGLTexture("../../Utilities/textures/tilesf2.jpg", "floor");
+	bReturn = QueueGLTexture("../../Utilities/textures/cheese_wheel.jpg", "cone");
+	bReturn = QueueGLTexture("../../Utilities/textures/gold-seamless-texture.jpg", "gold");
+	bReturn = QueueGLTexture("../../Utilities/textures/knife_handle.jpg", "wood");
+	bReturn = QueueGLTexture("../../Utilities/textures/keys.png", "keys");
+	UploadQueuedTextures();
+	// the laptop screen plays a video into a texture of its own
+	LoadScreenVideo();
+
+	// the decoder, mip generator and compressor threads are not
+	// needed once the scene is loaded
+	delete m_pTextureDecoder;
+	m_pTextureDecoder = NULL;
+	delete m_pMipGenerator;
+	m_pMipGenerator = NULL;
+	delete m_pTextureCompressor;
+	m_pTextureCompressor = NULL;
+
+	// the pixels are streamed into the textures by
+	// UpdateTextureStreaming(), a few megabytes per frame
+
+	// after the texture image data is loaded into memory, the
+	// texture arrays need to be bound to texture units - there
+	// is one unit for each size and format of scene texture
+	BindGLTextures();
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	modelView = translation * rotationX * rotationY * rotationZ * scale;
+
+	m_drawState.model = modelView;
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	m_drawState.textureSlot = -1;
+	m_drawState.color = currentColor;
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const std::string& textureTag)
+{
+	// an unknown tag leaves the slot at -1, so the
+	// object is drawn with its color instead
+	m_drawState.textureSlot = FindTextureSlot(textureTag);
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	m_drawState.uvScale = glm::vec2(u, v);
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
+{
+	int materialIndex = FindMaterialIndex(materialTag);
+	if (materialIndex >= 0)
+	{
+		SetShaderMaterial(materialIndex);
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting a material by its index
+ *  in the material table.  The draw only carries the index,
+ *  and the shader reads the material from the table.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(int materialIndex)
+{
+	// objects with a material are drawn with a lit variant
+	m_drawState.materialIndex = materialIndex;
+}
+
+/***********************************************************
+ *  LoadMaterialTable()
+ *
+ *  This method is used for packing the defined materials into
+ *  the material table, in the order they were defined, and
+ *  indexing them by tag.  The materials are not looked up by
+ *  their tags while the scene is drawn.
+ ***********************************************************/
+void SceneManager::LoadMaterialTable()
+{
+	std::vector<MATERIAL_DATA> materials;
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		MATERIAL_DATA data;
+		data.ambient = glm::vec4(material.ambientColor, material.ambientStrength);
+		data.diffuse = glm::vec4(material.diffuseColor, 0.0f);
+		data.specular = glm::vec4(material.specularColor, material.shininess);
+		materials.push_back(data);
+	}
+
+	if (NULL == m_pMaterialTable)
+	{
+		m_pMaterialTable = new MaterialTable();
+	}
+	m_materialIndices.clear();
+	if (m_pMaterialTable->Create(materials) == false)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		// the first material defined with a tag is the one found
+		m_materialIndices.insert(std::make_pair(m_objectMaterials[i].tag, (int)i));
+	}
+}
+
+/***********************************************************
+ *  LoadShaderVariants()
+ *
+ *  This method is used for queueing the shader variants
+ *  that the scene draws with - textured or colored, and lit
+ *  or unlit with the number of defined light sources.  All
+ *  of them are submitted up front so the driver can compile
+ *  them in parallel.  When the instanced meshes pull their
+ *  vertices, every variant is built to read them.
+ ***********************************************************/
+void SceneManager::LoadShaderVariants()
+{
+	bool bVertexPulling = (NULL != m_pInstancedMeshes) &&
+		(m_pInstancedMeshes->GetVertexFetch() == InstancedMeshes::FETCH_VERTEX_PULLING);
+
+	for (int textured = 0; textured < 2; textured++)
+	{
+		for (int lit = 0; lit < 2; lit++)
+		{
+			ShaderManager::ShaderDefines defines;
+			if (bVertexPulling)
+			{
+				defines.push_back({ "USE_VERTEX_PULLING", "1" });
+			}
+			if (textured == 1)
+			{
+				defines.push_back({ "USE_TEXTURE", "1" });
+				if (m_bBindlessTextures)
+				{
+					defines.push_back({ "USE_BINDLESS_TEXTURES", "1" });
+				}
+			}
+			if (lit == 1)
+			{
+				// without any light sources there is nothing to light with
+				if (m_lightSources.empty())
+				{
+					m_shaderVariants[textured][lit] = m_shaderVariants[textured][0];
+					continue;
+				}
+				defines.push_back({ "USE_LIGHTING", "1" });
+				defines.push_back({ "TOTAL_LIGHTS", std::to_string(GetShaderLightCount()) });
+			}
+
+			// the variant is only queued here - until its compile
+			// finishes, draws that need it use the fallback variant
+			m_shaderVariants[textured][lit] = m_pShaderManager->LoadShaderVariant(defines);
+			m_lightsGeneration[textured] = 0;
+			m_textureArraysGeneration[lit] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetShaderLightCount()
+ *
+ *  This method is used for getting the number of defined
+ *  light sources that the shaders have room for.
+ ***********************************************************/
+size_t SceneManager::GetShaderLightCount() const
+{
+	return(std::min(m_lightSources.size(), (size_t)ShaderUniforms::MaxLights));
+}
+
+/***********************************************************
+ *  ApplyLightSources()
+ *
+ *  This method is used for writing the defined light sources
+ *  into the active shader variant.
+ ***********************************************************/
+void SceneManager::ApplyLightSources()
+{
+	for (size_t i = 0; i < GetShaderLightCount(); i++)
+	{
+		const ShaderUniforms::LIGHT_SOURCE_UNIFORMS& uniforms = ShaderUniforms::LightSources[i];
+		m_pShaderManager->setVec3Value(uniforms.position, m_lightSources[i].position);
+		m_pShaderManager->setVec3Value(uniforms.ambientColor, m_lightSources[i].ambientColor);
+		m_pShaderManager->setVec3Value(uniforms.diffuseColor, m_lightSources[i].diffuseColor);
+		m_pShaderManager->setVec3Value(uniforms.specularColor, m_lightSources[i].specularColor);
+		m_pShaderManager->setFloatValue(uniforms.focalStrength, m_lightSources[i].focalStrength);
+		m_pShaderManager->setFloatValue(uniforms.specularIntensity, m_lightSources[i].specularIntensity);
+	}
+}
+
+/***********************************************************
+ *  ApplyTextureArrays()
+ *
+ *  This method is used for writing the texture arrays into
+ *  the active shader variant, as bindless handles or as the
+ *  texture units that the arrays are bound on.
+ ***********************************************************/
+void SceneManager::ApplyTextureArrays()
+{
+	if (NULL == m_pTextureArrays)
+	{
+		return;
+	}
+
+	for (int i = 0; i < m_pTextureArrays->GetArrayCount(); i++)
+	{
+		if (m_pTextureArrays->GetArrayID(i) == 0)
+		{
+			// the index of a deleted array is not sampled
+			continue;
+		}
+		if (m_pTextureArrays->IsBindless())
+		{
+			m_pShaderManager->setTextureHandleValue(ShaderUniforms::TextureArrays[i], m_pTextureArrays->GetArrayHandle(i));
+		}
+		else
+		{
+			m_pShaderManager->setSampler2DArrayValue(ShaderUniforms::TextureArrays[i], i);
+		}
+	}
+}
+
+/***********************************************************
+ *  SelectShaderVariant()
+ *
+ *  This method is used for picking the shader variant that
+ *  matches a draw state.  The texture decides between
+ *  textured and colored, and a defined material turns on
+ *  the lighting.
+ ***********************************************************/
+int SceneManager::SelectShaderVariant(const DRAW_STATE& drawState) const
+{
+	int textured = (drawState.textureSlot >= 0) ? 1 : 0;
+	int lit = ((drawState.materialIndex >= 0) && (!m_lightSources.empty())) ? 1 : 0;
+
+	return(m_shaderVariants[textured][lit]);
+}
+
+/***********************************************************
+ *  ApplyDrawState()
+ *
+ *  This method is used for activating the shader program of
+ *  a draw command, and writing the draw state into it.  The
+ *  model, color, texture and material of instanced draws are
+ *  read from their instances, so only the rest is written
+ *  then.
+ *  Returns false when no program is ready to draw with.
+ ***********************************************************/
+bool SceneManager::ApplyDrawState(const DRAW_COMMAND& command, bool bInstanced)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
+	}
+
+	const DRAW_STATE& drawState = command.state;
+	int textured = (drawState.textureSlot >= 0) ? 1 : 0;
+	int lit = ((drawState.materialIndex >= 0) && (!m_lightSources.empty())) ? 1 : 0;
+
+	// the shader manager falls back to its generic variant while
+	// the specialized one is compiling, or if it failed to compile,
+	// and only the uniforms of the generic variant are written then
+	int program = m_pShaderManager->UseProgram(command.program);
+	if (program < 0)
+	{
+		return(false);
+	}
+	if (program != command.program)
+	{
+		textured = 0;
+		lit = 0;
+	}
+
+	// the light sources do not change, so they are written into
+	// each lit variant once, right after it becomes ready, and
+	// again whenever a shader reload replaces its program
+	unsigned int generation = m_pShaderManager->GetProgramGeneration(program);
+	if ((lit == 1) && (m_lightsGeneration[textured] != generation))
+	{
+		ApplyLightSources();
+		m_lightsGeneration[textured] = generation;
+	}
+
+	// the texture array samplers do not change either, so they
+	// are written into each textured variant the same way
+	if ((textured == 1) && (m_textureArraysGeneration[lit] != generation))
+	{
+		ApplyTextureArrays();
+		m_textureArraysGeneration[lit] = generation;
+	}
+
+	m_pShaderManager->setBoolValue(ShaderUniforms::Instanced, bInstanced);
+	if (!bInstanced)
+	{
+		m_pShaderManager->setMat4Value(ShaderUniforms::Model, drawState.model);
+	}
+
+	if ((textured == 1) && (!bInstanced))
+	{
+		// selecting the texture is a plain integer write, so draws
+		// with different textures do not rebind any sampler
+		const TextureRegistry::TEXTURE_ENTRY& texture = m_textureRegistry.GetTexture(drawState.textureSlot);
+		m_pShaderManager->setIVec2Value(ShaderUniforms::ObjectTexture, glm::ivec2(texture.arrayIndex, texture.layer));
+		m_pShaderManager->setVec4Value(ShaderUniforms::AtlasRect, texture.atlasRect);
+		m_pShaderManager->setVec2Value(ShaderUniforms::UVScale, drawState.uvScale);
+	}
+	else if (!bInstanced)
+	{
+		m_pShaderManager->setVec4Value(ShaderUniforms::ObjectColor, drawState.color);
+	}
+
+	if ((lit == 1) && (!bInstanced))
+	{
+		// the materials live in the material table, so selecting
+		// one is a single integer write
+		m_pShaderManager->setIntValue(ShaderUniforms::MaterialIndex, drawState.materialIndex);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SubmitDraw()
+ *
+ *  This method is used for recording a draw of the passed in
+ *  mesh with the current draw state.  Nothing is drawn until
+ *  FlushDrawCommands() is called.
+ ***********************************************************/
+void SceneManager::SubmitDraw(MESH_TYPE mesh)
+{
+	DRAW_COMMAND command;
+	command.state = m_drawState;
+	command.mesh = mesh;
+	command.program = SelectShaderVariant(m_drawState);
+	command.depth = (m_viewProjection * command.state.model[3]).z;
+
+	if (command.state.textureSlot >= 0)
+	{
+		RequestTextureLevel(command);
+	}
+
+	m_drawCommands.push_back(command);
+}
+
+/***********************************************************
+ *  RequestTextureLevel()
+ *
+ *  This method is used for requesting the texture level
+ *  that a draw needs.  The mesh is sized on the screen by a
+ *  sphere around it, and the texture repeats across it as
+ *  often as the UV scale says, so each repeat covers a part
+ *  of those pixels.  Draws behind the camera request nothing.
+ ***********************************************************/
+void SceneManager::RequestTextureLevel(const DRAW_COMMAND& command)
+{
+	if ((NULL == m_pTextureResidency) || (m_viewportHeight <= 0))
+	{
+		return;
+	}
+
+	const DRAW_STATE& drawState = command.state;
+	const TextureRegistry::TEXTURE_ENTRY& texture = m_textureRegistry.GetTexture(drawState.textureSlot);
+	glm::vec4 center = m_viewProjection * drawState.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	if (center.w <= 0.0f)
+	{
+		return;
+	}
+
+	// the largest scale of the model stretches the sphere
+	float scale = std::max(
+		glm::length(glm::vec3(drawState.model[0])),
+		std::max(glm::length(glm::vec3(drawState.model[1])), glm::length(glm::vec3(drawState.model[2]))));
+	float pixels = g_MeshRadius[command.mesh] * scale * m_projectionScale * m_viewportHeight / center.w;
+	float repeats = std::max(1.0f, std::max(drawState.uvScale.x, drawState.uvScale.y));
+	// a texture packed into an atlas page covers a part of it
+	float textureSize = m_pTextureArrays->GetArraySize(texture.arrayIndex) * std::max(texture.atlasRect.z, texture.atlasRect.w);
+
+	m_pTextureResidency->RequestLevel(
+		texture.arrayIndex,
+		TextureResidency::GetRequiredLevel((int)textureSize, pixels / repeats));
+}
+
+/***********************************************************
+ *  FlushDrawCommands()
+ *
+ *  This method is used for drawing the recorded commands.
+ *  Each command is pushed into the render queue with its
+ *  state, and drawn in the sorted order of the queue, so the
+ *  opaque commands come first, grouped by shader program,
+ *  texture, material and mesh and front to back within each
+ *  group, and the transparent ones last, back to front.
+ *  Untextured commands with a color that is not opaque are
+ *  the transparent ones.  The sorted commands that follow
+ *  each other with the same program are gathered into
+ *  batches, with their models, colors, textures and
+ *  materials written as instances and each run of the same
+ *  mesh as an indirect draw, and each batch is submitted
+ *  with one multi-draw call.
+ ***********************************************************/
+void SceneManager::FlushDrawCommands()
+{
+	m_renderQueue.Clear();
+	for (size_t i = 0; i < m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+
+		RenderQueue::DRAW_KEY key;
+		key.pass = ((command.state.textureSlot < 0) && (command.state.color.a < 1.0f)) ?
+			RenderQueue::PASS_TRANSPARENT : RenderQueue::PASS_OPAQUE;
+		key.program = command.program;
+		key.texture = command.state.textureSlot;
+		key.material = command.state.materialIndex;
+		key.mesh = (int)command.mesh;
+		key.depth = command.depth;
+		m_renderQueue.Push(key, (uint32_t)i);
+	}
+	m_renderQueue.Sort();
+
+	m_drawBatches.clear();
+	m_instances.clear();
+	m_indirectCommands.clear();
+	// the mesh of the last indirect draw
+	InstancedMeshes::INSTANCED_MESH drawMesh = InstancedMeshes::INSTANCED_BOX;
+	for (size_t i = 0; i < m_renderQueue.GetCount(); i++)
+	{
+		size_t index = m_renderQueue.GetPayload(i);
+		const DRAW_COMMAND& command = m_drawCommands[index];
+
+		InstancedMeshes::INSTANCED_MESH instancedMesh;
+		bool bInstanced = (NULL != m_pInstancedMeshes) && GetInstancedMesh(command.mesh, instancedMesh);
+		bool bNewBatch =
+			(!bInstanced) ||
+			(m_drawBatches.empty()) ||
+			(m_drawBatches.back().drawCount == 0) ||
+			(m_drawCommands[m_drawBatches.back().command].program != command.program);
+
+		if (bNewBatch)
+		{
+			DRAW_BATCH batch;
+			batch.command = index;
+			batch.firstDraw = (int)m_indirectCommands.size();
+			batch.drawCount = 0;
+			m_drawBatches.push_back(batch);
+		}
+
+		if (bInstanced)
+		{
+			// a new indirect draw starts with each change of mesh,
+			// and of texture array, since the shaders pick the
+			// sampler of the array by an index that must be the
+			// same for a whole draw
+			INSTANCE_DATA instance = MakeInstance(command);
+			bool bNewDraw =
+				(bNewBatch) ||
+				(drawMesh != instancedMesh) ||
+				(m_instances.back().texture.x != instance.texture.x);
+
+			if (bNewDraw)
+			{
+				m_indirectCommands.push_back(m_pInstancedMeshes->MakeCommand(instancedMesh, (GLuint)m_instances.size()));
+				m_drawBatches.back().drawCount++;
+				drawMesh = instancedMesh;
+			}
+			m_indirectCommands.back().instanceCount++;
+			m_instances.push_back(instance);
+		}
+	}
+
+	if (NULL != m_pInstancedMeshes)
+	{
+		m_pInstancedMeshes->UploadFrame(m_instances, m_indirectCommands);
+	}
+
+	for (size_t i = 0; i < m_drawBatches.size(); i++)
+	{
+		const DRAW_BATCH& batch = m_drawBatches[i];
+		const DRAW_COMMAND& command = m_drawCommands[batch.command];
+		bool bInstanced = (batch.drawCount > 0);
+
+		if (ApplyDrawState(command, bInstanced))
+		{
+			if (bInstanced)
+			{
+				m_pInstancedMeshes->DrawCommands(batch.firstDraw, batch.drawCount);
+			}
+			else
+			{
+				DrawMesh(command.mesh);
+			}
+		}
+	}
+
+	m_drawCommands.clear();
+}
+
+/***********************************************************
+ *  GetInstancedMesh()
+ *
+ *  This method is used for getting the mesh in the shared
+ *  buffers that draws one of the basic meshes.  Returns false
+ *  for meshes that are drawn one at a time.
+ ***********************************************************/
+bool SceneManager::GetInstancedMesh(MESH_TYPE mesh, InstancedMeshes::INSTANCED_MESH& instancedMesh) const
+{
+	switch (mesh)
+	{
+	case MESH_BOX:
+		instancedMesh = InstancedMeshes::INSTANCED_BOX;
+		return(true);
+	case MESH_CYLINDER:
+		instancedMesh = InstancedMeshes::INSTANCED_CYLINDER;
+		return(true);
+	case MESH_PLANE:
+		instancedMesh = InstancedMeshes::INSTANCED_PLANE;
+		return(true);
+	case MESH_SPHERE:
+		instancedMesh = InstancedMeshes::INSTANCED_SPHERE;
+		return(true);
+	default:
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  MakeInstance()
+ *
+ *  This method is used for getting the values of a draw
+ *  command that instanced draws read from their instances.
+ ***********************************************************/
+INSTANCE_DATA SceneManager::MakeInstance(const DRAW_COMMAND& command) const
+{
+	INSTANCE_DATA instance;
+	instance.model = command.state.model;
+	instance.color = command.state.color;
+	instance.atlasRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	instance.uvScale = command.state.uvScale;
+	instance.texture = glm::ivec2(0, 0);
+	instance.materialIndex = command.state.materialIndex;
+	instance.padding[0] = 0;
+	instance.padding[1] = 0;
+	instance.padding[2] = 0;
+
+	if (command.state.textureSlot >= 0)
+	{
+		const TextureRegistry::TEXTURE_ENTRY& texture = m_textureRegistry.GetTexture(command.state.textureSlot);
+		instance.atlasRect = texture.atlasRect;
+		instance.texture = glm::ivec2(texture.arrayIndex, texture.layer);
+	}
+
+	return(instance);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing one of the basic meshes.
+ ***********************************************************/
+void SceneManager::DrawMesh(MESH_TYPE mesh)
+{
+	switch (mesh)
+	{
+	case MESH_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case MESH_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	}
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene
+	LoadSceneTextures();
+	m_basicMeshes->LoadPlaneMesh();
+	//TODO load your shape meshes
+	m_basicMeshes->LoadBoxMesh();
+	m_basicMeshes->LoadBoxMesh();
+
+	// the meshes are drawn from shared buffers, with one
+	// multi-draw call for the draws that share a program, and
+	// one at a time through the basic meshes when that is not
+	// supported
+	m_pInstancedMeshes = new InstancedMeshes();
+	if (m_pInstancedMeshes->Create(m_bVertexPulling ?
+		InstancedMeshes::FETCH_VERTEX_PULLING :
+		InstancedMeshes::FETCH_VERTEX_ARRAY) == false)
+	{
+		delete m_pInstancedMeshes;
+		m_pInstancedMeshes = NULL;
+	}
+
+	// define the scene light source
+	LIGHT_SOURCE light;
+	light.position = g_LightPosition;
+	light.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	light.diffuseColor = g_LightColor;
+	light.specularColor = g_LightColor;
+	light.focalStrength = 32.0f;
+	light.specularIntensity = 1.0f; // Set light intensity
+	m_lightSources.push_back(light);
+
+	// pack the defined materials for the shaders, which select
+	// them by index
+	LoadMaterialTable();
+
+	// compile the shader variants for the defined lights
+	LoadShaderVariants();
+}
+
+void SceneManager::DrawLaptopMesh(glm::vec3 position, float rotationAngle, glm::vec3 scale) {
+	// Combine transformation matrices for the whole laptop object
+
+	// Base of the laptop (bottom half)
+	glm::vec3 baseScale = glm::vec3(12.0f, 6.0f, 10.0f);
+	glm::vec3 basePosition = position + glm::vec3(0.0f, -1.0f, 0.0f);
+	float baseRotationX = 12.0f;
+
+	SetTransformations(
+		baseScale,
+		baseRotationX,
+		0.0f,
+		0.0f,
+		basePosition);
+	SetShaderColor(0.72, 0.75, 0.75, 1.0);
+	//SetShaderTexture("keys");
+	SubmitDraw(MESH_BOX);
+
+	// Top screen of the laptop
+	glm::vec3 screenScale = glm::vec3(13.0f, 8.1f, 3.0f);
+	glm::vec3 screenPosition = position + glm::vec3(0.0f, 5.0f, -10.0f);
+	float screenRotationX = -19.0f;
+
+	SetTransformations(
+		screenScale,
+		screenRotationX,
+		0.0f,
+		0.0f,
+		screenPosition);
+	SetShaderColor(0.21, 0.21, 0.21, 1.0);
+	SubmitDraw(MESH_BOX);
+
+	// the display of the screen plays the video, on a plane
+	// just in front of the box, turned up to face the same
+	// way as the front of the box
+	if (FindTextureSlot("screen") >= 0)
+	{
+		glm::vec3 displayScale = glm::vec3(6.0f, 1.0f, 3.7f);
+		glm::vec3 displayOffset = glm::vec3(
+			glm::rotate(glm::radians(screenRotationX), glm::vec3(1.0f, 0.0f, 0.0f)) *
+			glm::vec4(0.0f, 0.0f, screenScale.z * 0.5f + 0.01f, 0.0f));
+
+		SetTransformations(
+			displayScale,
+			screenRotationX + 90.0f,
+			0.0f,
+			0.0f,
+			screenPosition + displayOffset);
+		SetShaderTexture("screen");
+		SubmitDraw(MESH_PLANE);
+	}
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+
+	// Set up a position and transformation for the whole laptop object
+	glm::vec3 laptopPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	float laptopRotationAngle = 0.0f;
+	glm::vec3 laptopScale = glm::vec3(1.0f, 1.0f, 1.0f); // No additional scaling for the whole laptop
+	DrawLaptopMesh(laptopPosition, laptopRotationAngle, laptopScale);
+	// declare the variables for the transformations
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+
+	/*** Set needed transformations before drawing the basic mesh.  ***/
+	/*** This same ordering of code should be used for transforming ***/
+	/*** and drawing all the basic 3D shapes.						***/
+	/******************************************************************/
+	// set the XYZ scale for the mesh
+	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
+
+	// set the XYZ rotation for the mesh
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	// set the XYZ position for the mesh
+	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// set the transformations into memory to be used on the drawn meshes
+	SetTransformations(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+	// set the color values into the shader
+	//SetShaderColor(1, 1, 1, 1);
+	SetShaderTexture("wood");
+	// draw the mesh with transformation values
+	SubmitDraw(MESH_PLANE);
+	/****************************************************************/
+
+	/*** Set needed transformations before drawing the basic mesh.  ***/
+	/*** This same ordering of code should be used for transforming ***/
+	/*** and drawing all the basic 3D shapes.						***/
+	/******************************************************************/
+	// set the XYZ scale for the mesh
+	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
+
+	// set the XYZ rotation for the mesh
+	XrotationDegrees = 90.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	// set the XYZ position for the mesh
+	positionXYZ = glm::vec3(0.0f, 9.0f, -10.0f);
+
+	// set the transformations into memory to be used on the drawn meshes
+	SetTransformations(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	// set the color values into the shader
+	SetShaderColor(1, 1, 1, 1);
+	SetShaderTexture("wood");
+	// draw the mesh with transformation values
+	SubmitDraw(MESH_PLANE);
+
+	// draw the recorded meshes, grouped by shader program
+	FlushDrawCommands();
 }
\ No newline at end of file
@@ -1,105 +1,328 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.h
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager* pShaderManager);
-	// destructor
-	~SceneManager();
-
-	// properties for loaded texture access
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	// properties for object materials
-	struct OBJECT_MATERIAL
-	{
-		float ambientStrength;
-		glm::vec3 ambientColor;
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// the number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	// methods for managing OpenGL textures
-	bool CreateGLTexture(const char* filename, std::string tag);
-	void BindGLTextures();
-	void DestroyGLTextures();
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the texture UV scale into the shader
-	void SetTextureUVScale(
-		float u, float v);
-
-public:
-
-	/*** The following methods are for the students to ***/
-	/*** customize for their own 3D scene              ***/
-	void PrepareScene();
-	void RenderScene();
-
-	void SetShaderMaterial(std::string materialTag);
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-	// loads textures from image files
-	void LoadSceneTextures();
-	void DrawLaptopMesh(glm::vec3 position, float rotationAngle, glm::vec3 scale);
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.h
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include "TextureDecoder.h"
+#include "CookedTexture.h"
+#include "TextureCompressor.h"
+#include "MipGenerator.h"
+#include "TextureUploader.h"
+#include "TextureArraySet.h"
+#include "TextureRegistry.h"
+#include "TextureResidency.h"
+#include "TextureAtlas.h"
+#include "VideoTexture.h"
+#include "MaterialTable.h"
+#include "RenderQueue.h"
+#include "InstancedMeshes.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(ShaderManager* pShaderManager);
+	// destructor
+	~SceneManager();
+
+	// properties for object materials
+	struct OBJECT_MATERIAL
+	{
+		float ambientStrength;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+	// properties for scene light sources
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		glm::vec3 ambientColor;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float focalStrength;
+		float specularIntensity;
+	};
+
+	// shader values for the next draw command, which are
+	// written into the selected shader variant right before
+	// the mesh is drawn
+	struct DRAW_STATE
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		// registry handle of the loaded texture, or -1 for
+		// drawing with the color
+		int textureSlot;
+		glm::vec2 uvScale;
+		// index of the material in the material table, or -1
+		// for drawing without lighting
+		int materialIndex;
+	};
+
+	// basic meshes that a draw command can draw
+	enum MESH_TYPE
+	{
+		MESH_BOX = 0,
+		MESH_CYLINDER,
+		MESH_PLANE,
+		MESH_SPHERE
+	};
+
+	// a draw command recorded while the scene is rendered, which
+	// is submitted later in the order of the render queue
+	struct DRAW_COMMAND
+	{
+		DRAW_STATE state;
+		MESH_TYPE mesh;
+		// handle of the shader program to draw with
+		int program;
+		// clip space depth of the model origin, for sorting
+		float depth;
+	};
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to basic shapes object
+	ShapeMeshes* m_basicMeshes;
+	// draws the basic meshes from shared buffers, or NULL
+	InstancedMeshes* m_pInstancedMeshes;
+	// whether the instanced meshes pull their vertices from a
+	// storage buffer instead of fetching vertex attributes
+	bool m_bVertexPulling;
+	// decodes queued image files on worker threads, or NULL
+	TextureDecoder* m_pTextureDecoder;
+	// an image file queued for decoding, or a mapped cooked
+	// file, with the registered texture that is created from it
+	struct PENDING_TEXTURE
+	{
+		// the decoder ticket, or -1 for a cooked file
+		int ticket;
+		TEXTURE_DATA cooked;
+		// registry handle, or -1 when the texture was released
+		// before it was loaded
+		int texture;
+	};
+	// image files waiting to be uploaded, in queue order
+	std::vector<PENDING_TEXTURE> m_pendingTextures;
+	// builds the mipmaps of decoded images, or NULL
+	MipGenerator* m_pMipGenerator;
+	// the filter that the mipmaps are built with
+	MipGenerator::MIP_FILTER m_mipFilter;
+	// compresses decoded images before they are uploaded, or NULL
+	TextureCompressor* m_pTextureCompressor;
+	// whether decoded images are block compressed, and how
+	bool m_bCompressTextures;
+	TextureCompressor::COMPRESSION_FORMAT m_compressionFormat;
+	TextureCompressor::COMPRESSION_QUALITY m_compressionQuality;
+	// whether small decoded images are packed into atlas pages
+	bool m_bPackTextures;
+	// streams the pixels of created textures, or NULL
+	TextureUploader* m_pTextureUploader;
+	// the texture arrays that hold the loaded textures, or NULL
+	TextureArraySet* m_pTextureArrays;
+	// whether the texture arrays are used through bindless handles
+	bool m_bBindlessTextures;
+	// streams the texture levels that the view needs, or NULL
+	TextureResidency* m_pTextureResidency;
+	// the most bytes that the texture levels may take
+	size_t m_textureBudget;
+	// the camera of the frame being rendered, for sizing the
+	// textured objects on the screen
+	glm::mat4 m_viewProjection;
+	float m_projectionScale;
+	int m_viewportHeight;
+	// plays a video into the texture of the laptop screen, or
+	// NULL
+	VideoTexture* m_pScreenVideo;
+	// the video that is played on the laptop screen, without a
+	// path when the screen is not played
+	VideoTexture::VIDEO_SOURCE m_screenSource;
+	// the loaded textures, by tag and by file contents
+	TextureRegistry m_textureRegistry;
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// the defined materials packed for the shaders, or NULL
+	MaterialTable* m_pMaterialTable;
+	// the index of each material in the table, by tag
+	std::unordered_map<std::string, int> m_materialIndices;
+	// defined scene light sources
+	std::vector<LIGHT_SOURCE> m_lightSources;
+	// shader values for the next draw command
+	DRAW_STATE m_drawState;
+	// shader variant numbers, indexed by [textured][lit]
+	int m_shaderVariants[2][2];
+	// program generation of the lit variants that the light
+	// sources were written into, indexed by [textured]
+	unsigned int m_lightsGeneration[2];
+	// program generation of the textured variants that the
+	// texture arrays were written into, indexed by [lit]
+	unsigned int m_textureArraysGeneration[2];
+	// draw commands recorded for the current frame
+	std::vector<DRAW_COMMAND> m_drawCommands;
+	// sorts the draw commands of the frame by their state
+	RenderQueue m_renderQueue;
+	// a run of sorted draw commands that share their program,
+	// drawn with the state of its first command
+	struct DRAW_BATCH
+	{
+		// index of the first command in m_drawCommands
+		size_t command;
+		// the indirect draws of the batch in m_indirectCommands,
+		// or a count of 0 for a command that is not drawn
+		// instanced
+		int firstDraw;
+		int drawCount;
+	};
+	// the batches of the current frame, in drawing order
+	std::vector<DRAW_BATCH> m_drawBatches;
+	// the instances of the batches of the current frame
+	std::vector<INSTANCE_DATA> m_instances;
+	// the indirect draws of the batches of the current frame,
+	// each a run of instances with one mesh
+	std::vector<DRAW_ELEMENTS_INDIRECT_COMMAND> m_indirectCommands;
+
+	// methods for managing OpenGL textures
+	bool CreateGLTexture(const char* filename, const std::string& tag);
+	bool QueueGLTexture(const char* filename, const std::string& tag);
+	int UploadQueuedTextures();
+	void CreateTextureArrays();
+	bool LoadScreenVideo();
+	void BuildTextureLevels(TEXTURE_DATA& texture);
+	void ReleaseGLTexture(const std::string& tag);
+	void FreeGLTexture(int texture);
+	void BindGLTextures();
+	void DestroyGLTextures();
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		const std::string& textureTag);
+
+	// set the texture UV scale into the shader
+	void SetTextureUVScale(
+		float u, float v);
+
+	// pack the defined materials into the material table
+	void LoadMaterialTable();
+	// queue the shader variants needed by the scene
+	void LoadShaderVariants();
+	// get the number of light sources the shaders can use
+	size_t GetShaderLightCount() const;
+	// write the light sources into the active shader variant
+	void ApplyLightSources();
+	// write the texture arrays into the active shader variant
+	void ApplyTextureArrays();
+	// select the shader variant that matches the draw state
+	int SelectShaderVariant(const DRAW_STATE& drawState) const;
+	// activate the program of a draw command and write the
+	// draw state into it, leaving out the values that instanced
+	// draws read from their instances - returns false if it
+	// cannot be drawn
+	bool ApplyDrawState(const DRAW_COMMAND& command, bool bInstanced);
+	// record a draw of the mesh with the current draw state
+	void SubmitDraw(MESH_TYPE mesh);
+	// request the texture level that a draw needs for its size
+	// on the screen
+	void RequestTextureLevel(const DRAW_COMMAND& command);
+	// draw the recorded commands in the order of the render queue,
+	// with one multi-draw call for each run that shares a program
+	void FlushDrawCommands();
+	// get the instanced mesh that draws a mesh - returns false
+	// for meshes that are only drawn one at a time
+	bool GetInstancedMesh(MESH_TYPE mesh, InstancedMeshes::INSTANCED_MESH& instancedMesh) const;
+	// get the instance values of a draw command
+	INSTANCE_DATA MakeInstance(const DRAW_COMMAND& command) const;
+	// draw one of the basic meshes
+	void DrawMesh(MESH_TYPE mesh);
+
+public:
+
+	/*** The following methods are for the students to ***/
+	/*** customize for their own 3D scene              ***/
+	void PrepareScene();
+	void RenderScene();
+	// stream the pixels of new textures - called once per frame
+	void UpdateTextureStreaming();
+	// set how textures without a cooked file are compressed -
+	// called before PrepareScene()
+	void SetTextureCompression(
+		bool bEnabled,
+		TextureCompressor::COMPRESSION_FORMAT format,
+		TextureCompressor::COMPRESSION_QUALITY quality);
+	// set the filter that the mipmaps of textures without a
+	// cooked file are built with - called before PrepareScene()
+	void SetMipFilter(MipGenerator::MIP_FILTER filter);
+	// set whether small textures without a cooked file are
+	// packed into atlas pages - called before PrepareScene()
+	void SetTexturePacking(bool bEnabled);
+	// set the most video memory that the texture levels may take
+	void SetTextureBudget(size_t budgetBytes);
+	// set whether the shaders pull the mesh vertices from a
+	// storage buffer - called before PrepareScene()
+	void SetVertexPulling(bool bEnabled);
+	// set the camera of the frame - called before RenderScene()
+	void SetSceneView(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportHeight);
+	// set the video that is played on the laptop screen -
+	// called before PrepareScene()
+	void SetScreenVideo(const VideoTexture::VIDEO_SOURCE& source);
+	// print the texture memory and video counters
+	void LogTextureResidency() const;
+	// print the state changes and instanced draw calls that the
+	// last frame needed
+	void LogRenderQueue() const;
+
+	void SetShaderMaterial(const std::string& materialTag);
+	// set the material by its index in the material table, as
+	// returned by FindMaterialIndex(), or -1 for no material
+	void SetShaderMaterial(int materialIndex);
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+	// get the index of a material in the material table, or -1 -
+	// the table is packed by PrepareScene()
+	int FindMaterialIndex(const std::string& tag) const;
+	// loads textures from image files
+	void LoadSceneTextures();
+	void DrawLaptopMesh(glm::vec3 position, float rotationAngle, glm::vec3 scale);
 };
\ No newline at end of file
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderuniforms.h
+// ============
+// typed handles for the uniforms declared in the scene shaders
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "UniformHandle.h"
+
+namespace ShaderUniforms
+{
+	// the locations below must match the layout(location = N)
+	// qualifiers in the GLSL and the SPIR-V scene shaders
+
+	// transformation uniforms
+	constexpr Uniform<glm::mat4> Model("model", 0);
+	// whether the model, object color, texture and material
+	// index are read from the instance attributes instead of
+	// the uniforms
+	constexpr Uniform<bool> Instanced("instanced", 5);
+
+	// object surface uniforms
+	constexpr Uniform<glm::vec4> ObjectColor("objectColor", 1);
+	// the texture of the object, as the index of its texture
+	// array and its layer in that array
+	constexpr Uniform<glm::ivec2> ObjectTexture("objectTexture", 2);
+	constexpr Uniform<glm::vec2> UVScale("UVscale", 3);
+	// the rectangle of the texture in its layer, as an offset
+	// in xy and a scale in zw - set for atlas pages
+	constexpr Uniform<glm::vec4> AtlasRect("atlasRect", 9);
+
+	// material uniform - the index of the material in the
+	// MaterialTable uniform block
+	constexpr Uniform<int> MaterialIndex("materialIndex", 4);
+
+	// light source uniforms - each element of the array takes
+	// one location per struct member
+	constexpr int MaxLights = 4;
+	constexpr GLint LightSourcesLocation = 16;
+	constexpr GLint LightSourceLocations = 6;
+
+	struct LIGHT_SOURCE_UNIFORMS
+	{
+		Uniform<glm::vec3> position;
+		Uniform<glm::vec3> ambientColor;
+		Uniform<glm::vec3> diffuseColor;
+		Uniform<glm::vec3> specularColor;
+		Uniform<float> focalStrength;
+		Uniform<float> specularIntensity;
+	};
+
+#define LIGHT_SOURCE_UNIFORMS_AT(i) \
+	{ \
+		Uniform<glm::vec3>("lightSources[" #i "].position", LightSourcesLocation + (i) * LightSourceLocations + 0), \
+		Uniform<glm::vec3>("lightSources[" #i "].ambientColor", LightSourcesLocation + (i) * LightSourceLocations + 1), \
+		Uniform<glm::vec3>("lightSources[" #i "].diffuseColor", LightSourcesLocation + (i) * LightSourceLocations + 2), \
+		Uniform<glm::vec3>("lightSources[" #i "].specularColor", LightSourcesLocation + (i) * LightSourceLocations + 3), \
+		Uniform<float>("lightSources[" #i "].focalStrength", LightSourcesLocation + (i) * LightSourceLocations + 4), \
+		Uniform<float>("lightSources[" #i "].specularIntensity", LightSourcesLocation + (i) * LightSourceLocations + 5) \
+	}
+
+	constexpr LIGHT_SOURCE_UNIFORMS LightSources[MaxLights] =
+	{
+		LIGHT_SOURCE_UNIFORMS_AT(0),
+		LIGHT_SOURCE_UNIFORMS_AT(1),
+		LIGHT_SOURCE_UNIFORMS_AT(2),
+		LIGHT_SOURCE_UNIFORMS_AT(3),
+	};
+
+#undef LIGHT_SOURCE_UNIFORMS_AT
+
+	// texture array uniforms - one sampler for each array of
+	// textures, set to a texture unit or to a bindless handle
+	constexpr int MaxTextureArrays = 16;
+	constexpr GLint TextureArraysLocation = LightSourcesLocation + MaxLights * LightSourceLocations;
+
+#define TEXTURE_ARRAY_AT(i) \
+	Uniform<Sampler2DArray>("textureArrays[" #i "]", TextureArraysLocation + (i))
+
+	constexpr Uniform<Sampler2DArray> TextureArrays[MaxTextureArrays] =
+	{
+		TEXTURE_ARRAY_AT(0), TEXTURE_ARRAY_AT(1), TEXTURE_ARRAY_AT(2), TEXTURE_ARRAY_AT(3),
+		TEXTURE_ARRAY_AT(4), TEXTURE_ARRAY_AT(5), TEXTURE_ARRAY_AT(6), TEXTURE_ARRAY_AT(7),
+		TEXTURE_ARRAY_AT(8), TEXTURE_ARRAY_AT(9), TEXTURE_ARRAY_AT(10), TEXTURE_ARRAY_AT(11),
+		TEXTURE_ARRAY_AT(12), TEXTURE_ARRAY_AT(13), TEXTURE_ARRAY_AT(14), TEXTURE_ARRAY_AT(15),
+	};
+
+#undef TEXTURE_ARRAY_AT
+
+#define DESCRIBE_LIGHT_SOURCE(i) \
+	LightSources[i].position.Describe(), \
+	LightSources[i].ambientColor.Describe(), \
+	LightSources[i].diffuseColor.Describe(), \
+	LightSources[i].specularColor.Describe(), \
+	LightSources[i].focalStrength.Describe(), \
+	LightSources[i].specularIntensity.Describe()
+
+	// every handle above, checked when the program is linked
+	constexpr UNIFORM_DESC All[] =
+	{
+		Model.Describe(),
+		Instanced.Describe(),
+		ObjectColor.Describe(),
+		ObjectTexture.Describe(),
+		UVScale.Describe(),
+		AtlasRect.Describe(),
+		MaterialIndex.Describe(),
+		DESCRIBE_LIGHT_SOURCE(0),
+		DESCRIBE_LIGHT_SOURCE(1),
+		DESCRIBE_LIGHT_SOURCE(2),
+		DESCRIBE_LIGHT_SOURCE(3),
+		TextureArrays[0].Describe(), TextureArrays[1].Describe(),
+		TextureArrays[2].Describe(), TextureArrays[3].Describe(),
+		TextureArrays[4].Describe(), TextureArrays[5].Describe(),
+		TextureArrays[6].Describe(), TextureArrays[7].Describe(),
+		TextureArrays[8].Describe(), TextureArrays[9].Describe(),
+		TextureArrays[10].Describe(), TextureArrays[11].Describe(),
+		TextureArrays[12].Describe(), TextureArrays[13].Describe(),
+		TextureArrays[14].Describe(), TextureArrays[15].Describe(),
+	};
+
+#undef DESCRIBE_LIGHT_SOURCE
+
+	// the variant defines that the SPIR-V scene shaders take as
+	// specialization constants, with their constant_id
+	constexpr SPECIALIZATION_CONSTANT_DESC SpecializationConstants[] =
+	{
+		{ "TOTAL_LIGHTS", 0 },
+		{ "USE_TEXTURE", 1 },
+		{ "USE_LIGHTING", 2 },
+		{ "USE_VERTEX_PULLING", 3 },
+	};
+}
@@ -0,0 +1,380 @@
+///////////////////////////////////////////////////////////////////////////////
+// cookedtexture.cpp
+// ============
+// cook texture images offline and map the cooked files at runtime
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CookedTexture.h"
+
+#include "stb_image.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// the level pixels start on this alignment in the file
+	const uint64_t g_LevelAlignment = 16;
+}
+
+/***********************************************************
+ *  CookedTexture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CookedTexture::CookedTexture()
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_hFile = NULL;
+	m_hMapping = NULL;
+#endif
+}
+
+/***********************************************************
+ *  ~CookedTexture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CookedTexture::~CookedTexture()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a cooked texture file and
+ *  checking that its header and level table fit the file, so
+ *  a damaged file is never read past its end.
+ ***********************************************************/
+bool CookedTexture::Open(const std::string& path)
+{
+	Close();
+
+	if (MapFile(path) == false)
+	{
+		return(false);
+	}
+	m_path = path;
+
+	const COOKED_TEXTURE_HEADER* pHeader = (const COOKED_TEXTURE_HEADER*)m_pData;
+	bool bValid =
+		(m_size >= sizeof(COOKED_TEXTURE_HEADER)) &&
+		(pHeader->magic == COOKED_TEXTURE_MAGIC) &&
+		(pHeader->version == COOKED_TEXTURE_VERSION) &&
+		(pHeader->levelCount > 0) && (pHeader->levelCount <= 32) &&
+		(m_size >= sizeof(COOKED_TEXTURE_HEADER) + pHeader->levelCount * sizeof(COOKED_TEXTURE_LEVEL));
+
+	const COOKED_TEXTURE_LEVEL* pLevels = (const COOKED_TEXTURE_LEVEL*)(m_pData + sizeof(COOKED_TEXTURE_HEADER));
+	for (uint32_t i = 0; (bValid) && (i < pHeader->levelCount); i++)
+	{
+		bValid = (pLevels[i].offset <= m_size) && (pLevels[i].size <= m_size - pLevels[i].offset);
+	}
+
+	if (!bValid)
+	{
+		printf("Cooked texture %s is not valid\n", path.c_str());
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the cooked file.
+ ***********************************************************/
+void CookedTexture::Close()
+{
+#ifdef _WIN32
+	if (m_pData != NULL)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (m_hMapping != NULL)
+	{
+		CloseHandle((HANDLE)m_hMapping);
+		m_hMapping = NULL;
+	}
+	if (m_hFile != NULL)
+	{
+		CloseHandle((HANDLE)m_hFile);
+		m_hFile = NULL;
+	}
+#else
+	if (m_pData != NULL)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+#endif
+	m_pData = NULL;
+	m_size = 0;
+	m_path.clear();
+}
+
+/***********************************************************
+ *  GetTextureData()
+ *
+ *  This method is used for describing the mapped levels as
+ *  texture data.  Every level is given, so no mipmaps are
+ *  generated after the upload.
+ ***********************************************************/
+bool CookedTexture::GetTextureData(TEXTURE_DATA& data) const
+{
+	if (m_pData == NULL)
+	{
+		return(false);
+	}
+
+	const COOKED_TEXTURE_HEADER* pHeader = (const COOKED_TEXTURE_HEADER*)m_pData;
+	const COOKED_TEXTURE_LEVEL* pLevels = (const COOKED_TEXTURE_LEVEL*)(m_pData + sizeof(COOKED_TEXTURE_HEADER));
+
+	data.filename = m_path;
+	data.width = (int)pHeader->width;
+	data.height = (int)pHeader->height;
+	data.internalFormat = pHeader->internalFormat;
+	data.pixelFormat = pHeader->pixelFormat;
+	data.bGenerateMipmaps = false;
+	data.levels.clear();
+	for (uint32_t i = 0; i < pHeader->levelCount; i++)
+	{
+		data.levels.push_back({ (int)pLevels[i].width, (int)pLevels[i].height, m_pData + pLevels[i].offset, (size_t)pLevels[i].size });
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  MapFile()
+ *
+ *  This method is used for mapping the whole file into
+ *  memory, read only.
+ ***********************************************************/
+bool CookedTexture::MapFile(const std::string& path)
+{
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	HANDLE hMapping = NULL;
+	if ((GetFileSizeEx(hFile, &fileSize)) && (fileSize.QuadPart > 0))
+	{
+		hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (hMapping == NULL)
+	{
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pData == NULL)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return(false);
+	}
+
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_pData = (const unsigned char*)pData;
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileStat;
+	if ((fstat(file, &fileStat) != 0) || (fileStat.st_size <= 0))
+	{
+		close(file);
+		return(false);
+	}
+
+	// the mapping stays valid after the file is closed
+	void* pData = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pData == MAP_FAILED)
+	{
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)pData;
+	m_size = (size_t)fileStat.st_size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetCookedPath()
+ *
+ *  This method is used for getting the path of the cooked
+ *  file that belongs next to a source image.
+ ***********************************************************/
+std::string CookedTexture::GetCookedPath(const std::string& sourcePath)
+{
+	size_t dotPos = sourcePath.find_last_of('.');
+	size_t slashPos = sourcePath.find_last_of("/\\");
+	if ((dotPos == std::string::npos) || ((slashPos != std::string::npos) && (dotPos < slashPos)))
+	{
+		return(sourcePath + ".ctex");
+	}
+
+	return(sourcePath.substr(0, dotPos) + ".ctex");
+}
+
+/***********************************************************
+ *  Cook()
+ *
+ *  This method is used for cooking a source image.  The
+ *  image is decoded and flipped the way the runtime loader
+ *  would, its mipmap chain is built down to 1x1 with the
+ *  passed in filter, and every level is written into the
+ *  cooked file, after being block compressed when a
+ *  compressor is passed in.
+ ***********************************************************/
+bool CookedTexture::Cook(
+	const std::string& sourcePath,
+	const std::string& cookedPath,
+	MipGenerator::MIP_FILTER mipFilter,
+	TextureCompressor* pCompressor,
+	TextureCompressor::COMPRESSION_FORMAT format,
+	TextureCompressor::COMPRESSION_QUALITY quality)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load_thread(1);
+	if (stbi_info(sourcePath.c_str(), &width, &height, &colorChannels) == 0)
+	{
+		printf("Could not read image %s: %s\n", sourcePath.c_str(), stbi_failure_reason());
+		return(false);
+	}
+
+	// grey images are expanded, since only RGB and RGBA are handled
+	int channels = ((colorChannels == 2) || (colorChannels == 4)) ? 4 : 3;
+	unsigned char* pImage = stbi_load(sourcePath.c_str(), &width, &height, &colorChannels, channels);
+	if (pImage == NULL)
+	{
+		printf("Could not decode image %s: %s\n", sourcePath.c_str(), stbi_failure_reason());
+		return(false);
+	}
+
+	TEXTURE_DATA texture;
+	texture.filename = sourcePath;
+	texture.width = width;
+	texture.height = height;
+	texture.internalFormat = (channels == 4) ? GL_RGBA8 : GL_RGB8;
+	texture.pixelFormat = (channels == 4) ? GL_RGBA : GL_RGB;
+	texture.levels.push_back({ width, height, pImage, (size_t)width * height * channels });
+	texture.bGenerateMipmaps = true;
+	texture.pOwner = std::shared_ptr<const void>(pImage, [](const void* pixels) { stbi_image_free((void*)pixels); });
+
+	// build the mipmap chain down to 1x1
+	int levelCount = GetMipLevelCount(width, height);
+	{
+		MipGenerator mipGenerator;
+		TEXTURE_DATA mipmapped;
+		if (mipGenerator.Generate(texture, mipFilter, true, mipmapped) == false)
+		{
+			return(false);
+		}
+		texture = mipmapped;
+	}
+
+	if (NULL != pCompressor)
+	{
+		TEXTURE_DATA compressed;
+		if (pCompressor->Compress(texture, format, quality, compressed) == false)
+		{
+			return(false);
+		}
+		texture = compressed;
+	}
+
+	// lay the levels out after the header and the level table
+	std::vector<COOKED_TEXTURE_LEVEL> levels(levelCount);
+	uint64_t offset = sizeof(COOKED_TEXTURE_HEADER) + levelCount * sizeof(COOKED_TEXTURE_LEVEL);
+	for (int level = 0; level < levelCount; level++)
+	{
+		offset = (offset + g_LevelAlignment - 1) / g_LevelAlignment * g_LevelAlignment;
+		levels[level].width = (uint32_t)texture.levels[level].width;
+		levels[level].height = (uint32_t)texture.levels[level].height;
+		levels[level].offset = offset;
+		levels[level].size = texture.levels[level].size;
+		offset += levels[level].size;
+	}
+
+	COOKED_TEXTURE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = COOKED_TEXTURE_MAGIC;
+	header.version = COOKED_TEXTURE_VERSION;
+	header.width = (uint32_t)width;
+	header.height = (uint32_t)height;
+	header.internalFormat = texture.internalFormat;
+	header.pixelFormat = texture.pixelFormat;
+	header.levelCount = (uint32_t)levelCount;
+
+	FILE* pFile = fopen(cookedPath.c_str(), "wb");
+	if (pFile == NULL)
+	{
+		printf("Could not write cooked texture %s\n", cookedPath.c_str());
+		return(false);
+	}
+
+	bool bWritten =
+		(fwrite(&header, sizeof(header), 1, pFile) == 1) &&
+		(fwrite(&levels[0], sizeof(COOKED_TEXTURE_LEVEL), levelCount, pFile) == (size_t)levelCount);
+	for (int level = 0; (bWritten) && (level < levelCount); level++)
+	{
+		// pad up to the aligned offset of the level
+		static const unsigned char padding[g_LevelAlignment] = { 0 };
+		long position = ftell(pFile);
+		size_t paddingSize = (size_t)(levels[level].offset - (uint64_t)position);
+		bWritten =
+			(fwrite(padding, 1, paddingSize, pFile) == paddingSize) &&
+			(fwrite(texture.levels[level].pixels, 1, texture.levels[level].size, pFile) == texture.levels[level].size);
+	}
+	bWritten = (fclose(pFile) == 0) && (bWritten);
+
+	if (!bWritten)
+	{
+		printf("Could not write cooked texture %s\n", cookedPath.c_str());
+		remove(cookedPath.c_str());
+		return(false);
+	}
+
+	printf("Cooked %s into %s: %dx%d, %d channels, %d levels%s\n",
+		sourcePath.c_str(), cookedPath.c_str(), width, height, channels, levelCount,
+		(NULL != pCompressor) ? ", block compressed" : "");
+
+	return(true);
+}
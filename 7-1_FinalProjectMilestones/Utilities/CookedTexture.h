@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// cookedtexture.h
+// ============
+// cook texture images offline and map the cooked files at runtime
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureData.h"
+#include "TextureCompressor.h"
+#include "MipGenerator.h"
+
+#include <stdint.h>
+#include <string>
+
+/***********************************************************
+ *  CookedTexture
+ *
+ *  This class reads cooked texture files, which hold the
+ *  pixels of a texture already flipped for OpenGL, with every
+ *  mipmap level, so nothing is decoded or generated when the
+ *  texture is loaded.  The file is memory mapped and its
+ *  levels are uploaded straight from the mapping.  The static
+ *  Cook() method writes the files, as an offline step.
+ *
+ *  File layout, little endian:
+ *    COOKED_TEXTURE_HEADER
+ *    COOKED_TEXTURE_LEVEL for each level, largest first
+ *    the pixels of each level, at the level's offset
+ ***********************************************************/
+class CookedTexture
+{
+public:
+	// the file header
+	struct COOKED_TEXTURE_HEADER
+	{
+		// COOKED_TEXTURE_MAGIC
+		uint32_t magic;
+		// COOKED_TEXTURE_VERSION
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		// sized format of the texture storage
+		uint32_t internalFormat;
+		// GL_RGB or GL_RGBA, or 0 for block compressed pixels
+		uint32_t pixelFormat;
+		uint32_t levelCount;
+		uint32_t reserved;
+	};
+
+	// where the pixels of a level are in the file
+	struct COOKED_TEXTURE_LEVEL
+	{
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	// "CTEX" read as a little endian number
+	static const uint32_t COOKED_TEXTURE_MAGIC = 0x58455443;
+	static const uint32_t COOKED_TEXTURE_VERSION = 1;
+
+	// constructor
+	CookedTexture();
+	// destructor
+	~CookedTexture();
+
+	// map a cooked file and check its contents
+	bool Open(const std::string& path);
+	// unmap the file
+	void Close();
+	// describe the mapped levels - the texture data points into
+	// the mapping, so the mapping must outlive it
+	bool GetTextureData(TEXTURE_DATA& data) const;
+	// get the mapped file contents, or NULL
+	inline const unsigned char* GetData() const
+	{
+		return(m_pData);
+	}
+	// get the size of the mapped file
+	inline size_t GetSize() const
+	{
+		return(m_size);
+	}
+
+	// get the path of the cooked file for a source image, which
+	// is the image path with the .ctex extension
+	static std::string GetCookedPath(const std::string& sourcePath);
+	// decode a source image and write it as a cooked file, block
+	// compressed when a compressor is passed in
+	static bool Cook(
+		const std::string& sourcePath,
+		const std::string& cookedPath,
+		MipGenerator::MIP_FILTER mipFilter = MipGenerator::FILTER_KAISER,
+		TextureCompressor* pCompressor = NULL,
+		TextureCompressor::COMPRESSION_FORMAT format = TextureCompressor::FORMAT_AUTO,
+		TextureCompressor::COMPRESSION_QUALITY quality = TextureCompressor::QUALITY_HIGH);
+
+private:
+	// the path of the mapped file
+	std::string m_path;
+	// the mapped file contents, or NULL
+	const unsigned char* m_pData;
+	size_t m_size;
+#ifdef _WIN32
+	// the file and mapping objects
+	void* m_hFile;
+	void* m_hMapping;
+#endif
+
+	// map the whole file read only
+	bool MapFile(const std::string& path);
+};
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// framedatabuffer.cpp
+// ============
+// manage the per-frame camera uniform block shared by all shader programs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameDataBuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	// the longest time to wait for the GPU to release a segment
+	const GLuint64 g_FenceTimeoutNs = 1000000000;
+}
+
+/***********************************************************
+ *  FrameDataBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameDataBuffer::FrameDataBuffer()
+{
+	m_bufferID = 0;
+	m_segmentSize = 0;
+	m_pMappedData = NULL;
+	m_currentSegment = -1;
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		m_fences[i] = NULL;
+	}
+}
+
+/***********************************************************
+ *  ~FrameDataBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameDataBuffer::~FrameDataBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the uniform buffer.  When
+ *  buffer storage is available the buffer is mapped once for
+ *  its whole lifetime, otherwise each update falls back to
+ *  glBufferSubData.
+ ***********************************************************/
+bool FrameDataBuffer::Create()
+{
+	GLint alignment = 0;
+
+	Destroy();
+
+	// each segment must start on the uniform buffer offset alignment
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment <= 0)
+	{
+		alignment = 256;
+	}
+	m_segmentSize = ((sizeof(FRAME_DATA) + alignment - 1) / alignment) * alignment;
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+
+	if (GLEW_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, m_segmentSize * RING_SIZE, NULL, flags);
+		m_pMappedData = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, m_segmentSize * RING_SIZE, flags);
+	}
+	else
+	{
+		glBufferData(GL_UNIFORM_BUFFER, m_segmentSize * RING_SIZE, NULL, GL_DYNAMIC_DRAW);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if ((GLEW_ARB_buffer_storage) && (NULL == m_pMappedData))
+	{
+		printf("Could not map the frame data buffer\n");
+		Destroy();
+		return(false);
+	}
+
+	printf("Created frame data buffer: %d segments of %d bytes, %s\n",
+		RING_SIZE,
+		(int)m_segmentSize,
+		(NULL != m_pMappedData) ? "persistently mapped" : "buffer sub data");
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the uniform buffer and
+ *  any fences that are still pending.
+ ***********************************************************/
+void FrameDataBuffer::Destroy()
+{
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		if (NULL != m_fences[i])
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = NULL;
+		}
+	}
+
+	if (0 != m_bufferID)
+	{
+		if (NULL != m_pMappedData)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_bufferID);
+	}
+
+	m_bufferID = 0;
+	m_pMappedData = NULL;
+	m_currentSegment = -1;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for writing the frame data into the
+ *  next ring segment and binding that segment to the
+ *  FrameData binding point.  The segment used by the previous
+ *  frame is fenced first, since all of the draws that read
+ *  it have been submitted by now.
+ ***********************************************************/
+void FrameDataBuffer::Update(const FRAME_DATA& frameData)
+{
+	if (0 == m_bufferID)
+	{
+		return;
+	}
+
+	if (NULL != m_pMappedData)
+	{
+		// fence the segment that the previous frame's draws read
+		if (m_currentSegment >= 0)
+		{
+			m_fences[m_currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+	}
+
+	m_currentSegment = (m_currentSegment + 1) % RING_SIZE;
+	GLintptr offset = m_currentSegment * m_segmentSize;
+
+	if (NULL != m_pMappedData)
+	{
+		// wait until the GPU is done with this segment
+		if (NULL != m_fences[m_currentSegment])
+		{
+			glClientWaitSync(m_fences[m_currentSegment], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeoutNs);
+			glDeleteSync(m_fences[m_currentSegment]);
+			m_fences[m_currentSegment] = NULL;
+		}
+		memcpy(m_pMappedData + offset, &frameData, sizeof(FRAME_DATA));
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(FRAME_DATA), &frameData);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, BINDING_POINT, m_bufferID, offset, sizeof(FRAME_DATA));
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// framedatabuffer.h
+// ============
+// manage the per-frame camera uniform block shared by all shader programs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+// std140 layout of the FrameData uniform block that is
+// declared in the vertex and fragment shaders
+struct FRAME_DATA
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	// xyz holds the camera position, w is padding
+	glm::vec4 viewPosition;
+};
+static_assert(sizeof(FRAME_DATA) == 144, "FRAME_DATA must match the std140 FrameData block");
+
+/***********************************************************
+ *  FrameDataBuffer
+ *
+ *  This class owns a ring-buffered uniform buffer for the
+ *  FrameData block.  Each frame writes into the next ring
+ *  segment through a persistent mapping and binds that
+ *  segment to the FrameData binding point, so every program
+ *  that declares the block sees the same camera data without
+ *  any per-program uniform uploads.
+ ***********************************************************/
+class FrameDataBuffer
+{
+public:
+	// binding point of the FrameData block in the shaders
+	static const GLuint BINDING_POINT = 0;
+	// number of frames that can be in flight at once
+	static const int RING_SIZE = 3;
+
+	// constructor
+	FrameDataBuffer();
+	// destructor
+	~FrameDataBuffer();
+
+	// create the buffer object - requires a current GL context
+	bool Create();
+	// free the buffer object and the fences
+	void Destroy();
+	// write the frame data and bind it for the coming draws
+	void Update(const FRAME_DATA& frameData);
+
+private:
+	// uniform buffer holding all of the ring segments
+	GLuint m_bufferID;
+	// size of one segment, padded to the uniform offset alignment
+	GLsizeiptr m_segmentSize;
+	// persistent mapping of the whole buffer, or NULL when the
+	// driver does not support buffer storage
+	unsigned char* m_pMappedData;
+	// fences guarding the segments that the GPU may still read
+	GLsync m_fences[RING_SIZE];
+	// index of the segment written by the last update
+	int m_currentSegment;
+};
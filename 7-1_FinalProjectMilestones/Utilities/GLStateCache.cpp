@@ -0,0 +1,313 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// shadow copies of OpenGL state, for dropping writes that change nothing
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	// names of the counted call kinds, for the log
+	const char* g_StateCallNames[GLStateCache::CALL_COUNT] =
+	{
+		"program",
+		"texture",
+		"enable",
+		"uniform",
+		"other"
+	};
+}
+
+/***********************************************************
+ *  GLStateCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLStateCache::GLStateCache()
+{
+	Invalidate();
+	memset(&m_frameStats, 0, sizeof(m_frameStats));
+	memset(&m_lastFrameStats, 0, sizeof(m_lastFrameStats));
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting every shadow copy, so
+ *  the next call for each piece of state is always issued.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	m_currentProgram = 0;
+	m_bProgramKnown = false;
+	m_activeTextureUnit = GL_TEXTURE0;
+	m_bActiveTextureKnown = false;
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		for (int target = 0; target < TARGET_COUNT; target++)
+		{
+			m_boundTextures[unit][target] = 0;
+			m_bTextureKnown[unit][target] = false;
+		}
+	}
+	m_enableFlags.clear();
+	m_bClearColorKnown = false;
+	m_bBlendFuncKnown = false;
+}
+
+/***********************************************************
+ *  ForgetTexture()
+ *
+ *  This method is used for dropping the shadow copies of the
+ *  units that hold a texture.  OpenGL binds 0 wherever a
+ *  deleted texture was bound, and a new texture can get the
+ *  same name, which would otherwise look bound already.
+ ***********************************************************/
+void GLStateCache::ForgetTexture(GLuint textureID)
+{
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		for (int target = 0; target < TARGET_COUNT; target++)
+		{
+			if (m_boundTextures[unit][target] == textureID)
+			{
+				m_boundTextures[unit][target] = 0;
+				m_bTextureKnown[unit][target] = false;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the counts of a new
+ *  frame.  The counts of the frame that just finished are
+ *  kept for GetLastFrameStats().
+ ***********************************************************/
+void GLStateCache::BeginFrame()
+{
+	m_lastFrameStats = m_frameStats;
+	memset(&m_frameStats, 0, sizeof(m_frameStats));
+}
+
+/***********************************************************
+ *  LogFrameStats()
+ *
+ *  This method is used for printing the issued and skipped
+ *  call counts of the last finished frame.
+ ***********************************************************/
+void GLStateCache::LogFrameStats() const
+{
+	unsigned int totalIssued = 0;
+	unsigned int totalSkipped = 0;
+
+	printf("GL state calls per frame (issued/skipped):");
+	for (int call = 0; call < CALL_COUNT; call++)
+	{
+		printf(" %s %u/%u", g_StateCallNames[call], m_lastFrameStats.issued[call], m_lastFrameStats.skipped[call]);
+		totalIssued += m_lastFrameStats.issued[call];
+		totalSkipped += m_lastFrameStats.skipped[call];
+	}
+	printf(", total %u/%u\n", totalIssued, totalSkipped);
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for binding a shader program.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint programID)
+{
+	if ((m_bProgramKnown) && (m_currentProgram == programID))
+	{
+		CountCall(CALL_PROGRAM, false);
+		return;
+	}
+
+	glUseProgram(programID);
+	m_currentProgram = programID;
+	m_bProgramKnown = true;
+	CountCall(CALL_PROGRAM, true);
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This method is used for selecting the active texture unit.
+ ***********************************************************/
+void GLStateCache::ActiveTexture(GLenum textureUnit)
+{
+	if ((m_bActiveTextureKnown) && (m_activeTextureUnit == textureUnit))
+	{
+		CountCall(CALL_TEXTURE, false);
+		return;
+	}
+
+	glActiveTexture(textureUnit);
+	m_activeTextureUnit = textureUnit;
+	m_bActiveTextureKnown = true;
+	CountCall(CALL_TEXTURE, true);
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding a texture to the active
+ *  texture unit.  Targets and units without a shadow copy
+ *  are always bound.
+ ***********************************************************/
+void GLStateCache::BindTexture(GLenum target, GLuint textureID)
+{
+	int unit = m_bActiveTextureKnown ? (int)(m_activeTextureUnit - GL_TEXTURE0) : -1;
+	int slot = GetTargetSlot(target);
+
+	if ((unit < 0) || (unit >= MAX_TEXTURE_UNITS) || (slot < 0))
+	{
+		glBindTexture(target, textureID);
+		CountCall(CALL_TEXTURE, true);
+		return;
+	}
+
+	if ((m_bTextureKnown[unit][slot]) && (m_boundTextures[unit][slot] == textureID))
+	{
+		CountCall(CALL_TEXTURE, false);
+		return;
+	}
+
+	glBindTexture(target, textureID);
+	m_boundTextures[unit][slot] = textureID;
+	m_bTextureKnown[unit][slot] = true;
+	CountCall(CALL_TEXTURE, true);
+}
+
+/***********************************************************
+ *  BindTextureUnit()
+ *
+ *  This method is used for binding a texture to the passed
+ *  in texture unit.  The active unit is only switched when
+ *  the binding actually changes.
+ ***********************************************************/
+void GLStateCache::BindTextureUnit(GLuint unit, GLenum target, GLuint textureID)
+{
+	int slot = GetTargetSlot(target);
+	if ((unit < (GLuint)MAX_TEXTURE_UNITS) && (slot >= 0) &&
+		(m_bTextureKnown[unit][slot]) && (m_boundTextures[unit][slot] == textureID))
+	{
+		CountCall(CALL_TEXTURE, false);
+		return;
+	}
+
+	ActiveTexture(GL_TEXTURE0 + unit);
+	BindTexture(target, textureID);
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for turning on an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Enable(GLenum capability)
+{
+	SetCapability(capability, true);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for turning off an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Disable(GLenum capability)
+{
+	SetCapability(capability, false);
+}
+
+/***********************************************************
+ *  SetCapability()
+ *
+ *  This method is used for changing an enable flag when its
+ *  shadow copy is unknown or different.
+ ***********************************************************/
+void GLStateCache::SetCapability(GLenum capability, bool bEnabled)
+{
+	std::unordered_map<GLenum, bool>::iterator it = m_enableFlags.find(capability);
+	if ((it != m_enableFlags.end()) && (it->second == bEnabled))
+	{
+		CountCall(CALL_ENABLE, false);
+		return;
+	}
+
+	if (bEnabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+	m_enableFlags[capability] = bEnabled;
+	CountCall(CALL_ENABLE, true);
+}
+
+/***********************************************************
+ *  ClearColor()
+ *
+ *  This method is used for setting the color buffer clear
+ *  value.
+ ***********************************************************/
+void GLStateCache::ClearColor(float red, float green, float blue, float alpha)
+{
+	if ((m_bClearColorKnown) &&
+		(m_clearColor[0] == red) && (m_clearColor[1] == green) &&
+		(m_clearColor[2] == blue) && (m_clearColor[3] == alpha))
+	{
+		CountCall(CALL_OTHER, false);
+		return;
+	}
+
+	glClearColor(red, green, blue, alpha);
+	m_clearColor[0] = red;
+	m_clearColor[1] = green;
+	m_clearColor[2] = blue;
+	m_clearColor[3] = alpha;
+	m_bClearColorKnown = true;
+	CountCall(CALL_OTHER, true);
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method is used for setting the blending factors.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if ((m_bBlendFuncKnown) &&
+		(m_blendFunc[0] == sourceFactor) && (m_blendFunc[1] == destinationFactor))
+	{
+		CountCall(CALL_OTHER, false);
+		return;
+	}
+
+	glBlendFunc(sourceFactor, destinationFactor);
+	m_blendFunc[0] = sourceFactor;
+	m_blendFunc[1] = destinationFactor;
+	m_bBlendFuncKnown = true;
+	CountCall(CALL_OTHER, true);
+}
+
+/***********************************************************
+ *  GetTargetSlot()
+ *
+ *  This method is used for getting the shadow slot of a
+ *  texture target, or -1 when the target is not tracked.
+ ***********************************************************/
+int GLStateCache::GetTargetSlot(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return(TARGET_2D);
+	case GL_TEXTURE_2D_ARRAY: return(TARGET_2D_ARRAY);
+	default: return(-1);
+	}
+}
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// shadow copies of OpenGL state, for dropping writes that change nothing
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <unordered_map>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class keeps shadow copies of the OpenGL state that
+ *  the application changes often - the bound program, the
+ *  texture bindings, the enable flags and a few fixed values.
+ *  A call that would set a value that is already current is
+ *  dropped.  Every call is counted as issued or skipped, and
+ *  the counts of the last finished frame can be read back.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// kinds of state calls that are counted separately
+	enum STATE_CALL
+	{
+		CALL_PROGRAM = 0,
+		CALL_TEXTURE,
+		CALL_ENABLE,
+		CALL_UNIFORM,
+		CALL_OTHER,
+		CALL_COUNT
+	};
+
+	// counts of the calls made during one frame
+	struct FRAME_STATS
+	{
+		unsigned int issued[CALL_COUNT];
+		unsigned int skipped[CALL_COUNT];
+	};
+
+	// the most texture units that are tracked
+	static const int MAX_TEXTURE_UNITS = 32;
+
+	// constructor
+	GLStateCache();
+
+	// forget every shadow copy, after GL state was changed
+	// by code that does not go through this cache
+	void Invalidate();
+	// forget the bindings of a texture that is about to be
+	// deleted, since deleting it binds 0 in its place
+	void ForgetTexture(GLuint textureID);
+
+	// start counting a new frame
+	void BeginFrame();
+	// get the counts of the last finished frame
+	inline const FRAME_STATS& GetLastFrameStats() const
+	{
+		return(m_lastFrameStats);
+	}
+	// print the counts of the last finished frame
+	void LogFrameStats() const;
+
+	// count a call that was made or dropped outside of this class
+	inline void CountCall(STATE_CALL call, bool bIssued)
+	{
+		if (bIssued)
+			m_frameStats.issued[call]++;
+		else
+			m_frameStats.skipped[call]++;
+	}
+
+	// state setters - each one only calls OpenGL on a change
+	void UseProgram(GLuint programID);
+	void ActiveTexture(GLenum textureUnit);
+	void BindTexture(GLenum target, GLuint textureID);
+	void BindTextureUnit(GLuint unit, GLenum target, GLuint textureID);
+	void Enable(GLenum capability);
+	void Disable(GLenum capability);
+	void ClearColor(float red, float green, float blue, float alpha);
+	void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+	// get the bound program
+	inline GLuint GetCurrentProgram() const
+	{
+		return(m_currentProgram);
+	}
+
+private:
+	// texture targets that have shadow copies per unit
+	enum TEXTURE_TARGET
+	{
+		TARGET_2D = 0,
+		TARGET_2D_ARRAY,
+		TARGET_COUNT
+	};
+
+	// shadow copies of the state - a value of false in the
+	// matching "known" flag means the state must be written
+	GLuint m_currentProgram;
+	bool m_bProgramKnown;
+	GLenum m_activeTextureUnit;
+	bool m_bActiveTextureKnown;
+	GLuint m_boundTextures[MAX_TEXTURE_UNITS][TARGET_COUNT];
+	bool m_bTextureKnown[MAX_TEXTURE_UNITS][TARGET_COUNT];
+	std::unordered_map<GLenum, bool> m_enableFlags;
+	float m_clearColor[4];
+	bool m_bClearColorKnown;
+	GLenum m_blendFunc[2];
+	bool m_bBlendFuncKnown;
+
+	// counts for the frame in progress and the last frame
+	FRAME_STATS m_frameStats;
+	FRAME_STATS m_lastFrameStats;
+
+	// set the enable flag through glEnable or glDisable
+	void SetCapability(GLenum capability, bool bEnabled);
+	// get the shadow slot of a texture target, or -1
+	static int GetTargetSlot(GLenum target);
+};
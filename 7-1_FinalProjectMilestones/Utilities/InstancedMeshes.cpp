@@ -0,0 +1,545 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.cpp
+// ============
+// draw the basic meshes from one shared buffer with multi-draw indirect
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InstancedMeshes.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+
+namespace
+{
+	// the vertex buffer binding points of the mesh vertices and
+	// of the instances
+	const GLuint g_VertexBinding = 0;
+	const GLuint g_InstanceBinding = 1;
+	// the vertex attribute locations of the mesh vertices
+	const GLuint g_PositionLocation = 0;
+	const GLuint g_NormalLocation = 1;
+	const GLuint g_TextureCoordinateLocation = 2;
+	// the floats of each vertex of the meshes before they are
+	// packed - position, normal and texture coordinate
+	const int g_VertexFloats = 8;
+	// the fewest instances and draw commands that the buffers of
+	// the frame have room for
+	const size_t g_MinInstanceCapacity = 256;
+	const size_t g_MinCommandCapacity = 64;
+	// the divisions around the cylinder and the sphere, and from
+	// pole to pole of the sphere
+	const int g_RoundSlices = 36;
+	const int g_SphereStacks = 18;
+	const float g_Pi = 3.14159265f;
+
+	// a unit box centered on the origin, with four vertices for
+	// each face so every face has its own normal
+	const GLfloat g_BoxVertices[] =
+	{
+		// front
+		-0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,   0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,   1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,   1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,   0.0f, 1.0f,
+		// back
+		 0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,   0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,   1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,   1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,   0.0f, 1.0f,
+		// left
+		-0.5f, -0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,   1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,   1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,   0.0f, 1.0f,
+		// right
+		 0.5f, -0.5f,  0.5f,   1.0f,  0.0f,  0.0f,   0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,   1.0f,  0.0f,  0.0f,   1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,   1.0f,  0.0f,  0.0f,   1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,   1.0f,  0.0f,  0.0f,   0.0f, 1.0f,
+		// top
+		-0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,   0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,   1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f,   1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f,   0.0f, 1.0f,
+		// bottom
+		-0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,   0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,   1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,   1.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,   0.0f, 1.0f,
+	};
+	const GLushort g_BoxIndices[] =
+	{
+		0, 1, 2, 0, 2, 3,
+		4, 5, 6, 4, 6, 7,
+		8, 9, 10, 8, 10, 11,
+		12, 13, 14, 12, 14, 15,
+		16, 17, 18, 16, 18, 19,
+		20, 21, 22, 20, 22, 23,
+	};
+
+	// a plane two units across in X and Z, facing up
+	const GLfloat g_PlaneVertices[] =
+	{
+		-1.0f, 0.0f,  1.0f,   0.0f, 1.0f, 0.0f,   0.0f, 0.0f,
+		 1.0f, 0.0f,  1.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+		 1.0f, 0.0f, -1.0f,   0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
+		-1.0f, 0.0f, -1.0f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+	};
+	const GLushort g_PlaneIndices[] =
+	{
+		0, 1, 2, 0, 2, 3,
+	};
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  This function is used for adding a vertex to the floats
+	 *  of a generated mesh.
+	 ***********************************************************/
+	void AddVertex(std::vector<GLfloat>& vertices, glm::vec3 position, glm::vec3 normal, glm::vec2 textureCoordinate)
+	{
+		GLfloat vertex[] =
+		{
+			position.x, position.y, position.z,
+			normal.x, normal.y, normal.z,
+			textureCoordinate.x, textureCoordinate.y
+		};
+		vertices.insert(vertices.end(), vertex, vertex + g_VertexFloats);
+	}
+
+	/***********************************************************
+	 *  BuildCylinder()
+	 *
+	 *  This function is used for generating a cylinder with a
+	 *  radius of one, standing on the origin one unit tall.  The
+	 *  texture wraps once around the side, and each cap maps the
+	 *  middle of the texture onto its disc.
+	 ***********************************************************/
+	void BuildCylinder(std::vector<GLfloat>& vertices, std::vector<GLushort>& indices)
+	{
+		// the side, a column of two vertices per slice with the
+		// seam repeated so the texture wraps
+		for (int slice = 0; slice <= g_RoundSlices; slice++)
+		{
+			float angle = 2.0f * g_Pi * slice / g_RoundSlices;
+			glm::vec3 normal(sinf(angle), 0.0f, cosf(angle));
+			float u = (float)slice / g_RoundSlices;
+			AddVertex(vertices, normal + glm::vec3(0.0f, 1.0f, 0.0f), normal, glm::vec2(u, 1.0f));
+			AddVertex(vertices, normal, normal, glm::vec2(u, 0.0f));
+		}
+		for (int slice = 0; slice < g_RoundSlices; slice++)
+		{
+			GLushort top = (GLushort)(slice * 2);
+			GLushort quad[] = { top, (GLushort)(top + 1), (GLushort)(top + 3), top, (GLushort)(top + 3), (GLushort)(top + 2) };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+
+		// the caps, a fan around a middle vertex each, wound to
+		// face up and down
+		for (int cap = 0; cap < 2; cap++)
+		{
+			float height = (cap == 0) ? 1.0f : 0.0f;
+			glm::vec3 normal(0.0f, (cap == 0) ? 1.0f : -1.0f, 0.0f);
+			GLushort middle = (GLushort)(vertices.size() / g_VertexFloats);
+			AddVertex(vertices, glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+			for (int slice = 0; slice <= g_RoundSlices; slice++)
+			{
+				float angle = 2.0f * g_Pi * slice / g_RoundSlices;
+				AddVertex(
+					vertices,
+					glm::vec3(sinf(angle), height, cosf(angle)),
+					normal,
+					glm::vec2(0.5f + 0.5f * sinf(angle), 0.5f + 0.5f * cosf(angle)));
+			}
+			for (int slice = 0; slice < g_RoundSlices; slice++)
+			{
+				GLushort rim = (GLushort)(middle + 1 + slice);
+				GLushort fan[] = { middle, rim, (GLushort)(rim + 1) };
+				if (cap == 1)
+				{
+					fan[1] = (GLushort)(rim + 1);
+					fan[2] = rim;
+				}
+				indices.insert(indices.end(), fan, fan + 3);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  BuildSphere()
+	 *
+	 *  This function is used for generating a sphere with a
+	 *  radius of one around the origin, in rows from the top
+	 *  pole to the bottom one.  The texture wraps once around
+	 *  it, with the seam repeated.
+	 ***********************************************************/
+	void BuildSphere(std::vector<GLfloat>& vertices, std::vector<GLushort>& indices)
+	{
+		for (int stack = 0; stack <= g_SphereStacks; stack++)
+		{
+			float polar = g_Pi * stack / g_SphereStacks;
+			for (int slice = 0; slice <= g_RoundSlices; slice++)
+			{
+				float angle = 2.0f * g_Pi * slice / g_RoundSlices;
+				glm::vec3 position(sinf(polar) * sinf(angle), cosf(polar), sinf(polar) * cosf(angle));
+				AddVertex(
+					vertices,
+					position,
+					position,
+					glm::vec2((float)slice / g_RoundSlices, 1.0f - (float)stack / g_SphereStacks));
+			}
+		}
+		for (int stack = 0; stack < g_SphereStacks; stack++)
+		{
+			for (int slice = 0; slice < g_RoundSlices; slice++)
+			{
+				GLushort top = (GLushort)(stack * (g_RoundSlices + 1) + slice);
+				GLushort bottom = (GLushort)(top + g_RoundSlices + 1);
+				GLushort quad[] = { top, bottom, (GLushort)(bottom + 1), top, (GLushort)(bottom + 1), (GLushort)(top + 1) };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  InstancedMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InstancedMeshes::InstancedMeshes()
+{
+	for (int i = 0; i < INSTANCED_MESH_COUNT; i++)
+	{
+		m_meshes[i].firstIndex = 0;
+		m_meshes[i].indexCount = 0;
+		m_meshes[i].baseVertex = 0;
+	}
+	m_vertexFetch = FETCH_VERTEX_ARRAY;
+	m_vao = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+	m_instanceBufferID = 0;
+	m_indirectBufferID = 0;
+	m_instanceCapacity = 0;
+	m_commandCapacity = 0;
+	m_frameInstances = 0;
+	m_frameCommands = 0;
+	m_drawCalls = 0;
+}
+
+/***********************************************************
+ *  ~InstancedMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InstancedMeshes::~InstancedMeshes()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the shared buffers with
+ *  every mesh, the buffers of the frame, and the vertex
+ *  array.  The vertex array takes the mesh vertices from one
+ *  buffer binding and the instances from the other, which
+ *  advances once per instance from the base instance of each
+ *  command.  When the vertices are pulled, the vertex buffer
+ *  is bound as a storage buffer as well.  The vertex array
+ *  keeps its vertex attributes either way, so programs built
+ *  without vertex pulling, like the fallback program while
+ *  the variants compile, still draw the meshes.  Returns
+ *  false when vertex attribute binding or multi-draw indirect
+ *  is missing, and the meshes are drawn one at a time then.
+ ***********************************************************/
+bool InstancedMeshes::Create(VERTEX_FETCH fetch)
+{
+	Destroy();
+
+	if ((!GLEW_ARB_vertex_attrib_binding) || (!GLEW_ARB_multi_draw_indirect))
+	{
+		printf("Instanced meshes need ARB_vertex_attrib_binding and ARB_multi_draw_indirect - drawing each mesh separately\n");
+		return(false);
+	}
+
+	m_vertexFetch = fetch;
+	if ((FETCH_VERTEX_PULLING == fetch) && (!GLEW_ARB_shader_storage_buffer_object))
+	{
+		printf("Vertex pulling needs ARB_shader_storage_buffer_object - fetching vertex attributes\n");
+		m_vertexFetch = FETCH_VERTEX_ARRAY;
+	}
+
+	std::vector<PACKED_VERTEX> vertices;
+	std::vector<GLushort> indices;
+	std::vector<GLfloat> roundVertices;
+	std::vector<GLushort> roundIndices;
+
+	AddMesh(
+		INSTANCED_BOX,
+		g_BoxVertices,
+		sizeof(g_BoxVertices) / sizeof(g_BoxVertices[0]),
+		g_BoxIndices,
+		sizeof(g_BoxIndices) / sizeof(g_BoxIndices[0]),
+		vertices,
+		indices);
+	AddMesh(
+		INSTANCED_PLANE,
+		g_PlaneVertices,
+		sizeof(g_PlaneVertices) / sizeof(g_PlaneVertices[0]),
+		g_PlaneIndices,
+		sizeof(g_PlaneIndices) / sizeof(g_PlaneIndices[0]),
+		vertices,
+		indices);
+	BuildCylinder(roundVertices, roundIndices);
+	AddMesh(INSTANCED_CYLINDER, roundVertices.data(), roundVertices.size(), roundIndices.data(), roundIndices.size(), vertices, indices);
+	roundVertices.clear();
+	roundIndices.clear();
+	BuildSphere(roundVertices, roundIndices);
+	AddMesh(INSTANCED_SPHERE, roundVertices.data(), roundVertices.size(), roundIndices.data(), roundIndices.size(), vertices, indices);
+
+	glGenVertexArrays(1, &m_vao);
+	glBindVertexArray(m_vao);
+
+	glGenBuffers(1, &m_vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PACKED_VERTEX), vertices.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &m_indexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_instanceBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	glBufferData(GL_ARRAY_BUFFER, g_MinInstanceCapacity * sizeof(INSTANCE_DATA), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	m_instanceCapacity = g_MinInstanceCapacity;
+
+	glGenBuffers(1, &m_indirectBufferID);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBufferID);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, g_MinCommandCapacity * sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	m_commandCapacity = g_MinCommandCapacity;
+
+	// the mesh vertices, unpacked by the vertex fetch
+	glBindVertexBuffer(g_VertexBinding, m_vertexBufferID, 0, sizeof(PACKED_VERTEX));
+	glVertexAttribFormat(g_PositionLocation, 3, GL_FLOAT, GL_FALSE, (GLuint)offsetof(PACKED_VERTEX, position));
+	glVertexAttribFormat(g_NormalLocation, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLuint)offsetof(PACKED_VERTEX, normal));
+	glVertexAttribFormat(g_TextureCoordinateLocation, 2, GL_HALF_FLOAT, GL_FALSE, (GLuint)offsetof(PACKED_VERTEX, textureCoordinate));
+	glVertexAttribBinding(g_PositionLocation, g_VertexBinding);
+	glVertexAttribBinding(g_NormalLocation, g_VertexBinding);
+	glVertexAttribBinding(g_TextureCoordinateLocation, g_VertexBinding);
+	glEnableVertexAttribArray(g_PositionLocation);
+	glEnableVertexAttribArray(g_NormalLocation);
+	glEnableVertexAttribArray(g_TextureCoordinateLocation);
+
+	// the instances - the model matrix is read a column per
+	// location, and the texture and material as integers
+	glBindVertexBuffer(g_InstanceBinding, m_instanceBufferID, 0, sizeof(INSTANCE_DATA));
+	glVertexBindingDivisor(g_InstanceBinding, 1);
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glVertexAttribFormat(MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, (GLuint)(offsetof(INSTANCE_DATA, model) + column * sizeof(glm::vec4)));
+		glVertexAttribBinding(MODEL_LOCATION + column, g_InstanceBinding);
+		glEnableVertexAttribArray(MODEL_LOCATION + column);
+	}
+	glVertexAttribFormat(COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, (GLuint)offsetof(INSTANCE_DATA, color));
+	glVertexAttribIFormat(MATERIAL_LOCATION, 1, GL_INT, (GLuint)offsetof(INSTANCE_DATA, materialIndex));
+	glVertexAttribFormat(ATLAS_RECT_LOCATION, 4, GL_FLOAT, GL_FALSE, (GLuint)offsetof(INSTANCE_DATA, atlasRect));
+	glVertexAttribFormat(UV_SCALE_LOCATION, 2, GL_FLOAT, GL_FALSE, (GLuint)offsetof(INSTANCE_DATA, uvScale));
+	glVertexAttribIFormat(TEXTURE_LOCATION, 2, GL_INT, (GLuint)offsetof(INSTANCE_DATA, texture));
+	GLuint instanceLocations[] = { COLOR_LOCATION, MATERIAL_LOCATION, ATLAS_RECT_LOCATION, UV_SCALE_LOCATION, TEXTURE_LOCATION };
+	for (size_t i = 0; i < sizeof(instanceLocations) / sizeof(instanceLocations[0]); i++)
+	{
+		glVertexAttribBinding(instanceLocations[i], g_InstanceBinding);
+		glEnableVertexAttribArray(instanceLocations[i]);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if (FETCH_VERTEX_PULLING == m_vertexFetch)
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VERTEX_STORAGE_BINDING, m_vertexBufferID);
+	}
+
+	printf("Created instanced meshes: %d vertices and %d indices in shared buffers, %d instances of %d bytes, %s\n",
+		(int)vertices.size(),
+		(int)indices.size(),
+		(int)m_instanceCapacity,
+		(int)sizeof(INSTANCE_DATA),
+		(FETCH_VERTEX_PULLING == m_vertexFetch) ? "vertex pulling" : "vertex attributes");
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for packing a mesh into the vertices
+ *  and appending it to the indices of the shared buffers.
+ *  The indices of each mesh count from its own first vertex,
+ *  which its draw commands pass as the base vertex.
+ ***********************************************************/
+void InstancedMeshes::AddMesh(
+	INSTANCED_MESH mesh,
+	const GLfloat* vertices,
+	size_t vertexFloats,
+	const GLushort* indices,
+	size_t indexCount,
+	std::vector<PACKED_VERTEX>& allVertices,
+	std::vector<GLushort>& allIndices)
+{
+	MESH_RANGE& range = m_meshes[mesh];
+	range.firstIndex = (GLuint)allIndices.size();
+	range.indexCount = (GLuint)indexCount;
+	range.baseVertex = (GLint)allVertices.size();
+
+	for (size_t i = 0; i + g_VertexFloats <= vertexFloats; i += g_VertexFloats)
+	{
+		const GLfloat* vertex = vertices + i;
+		PACKED_VERTEX packed;
+		packed.position[0] = vertex[0];
+		packed.position[1] = vertex[1];
+		packed.position[2] = vertex[2];
+		packed.normal = glm::packSnorm3x10_1x2(glm::vec4(vertex[3], vertex[4], vertex[5], 0.0f));
+		packed.textureCoordinate = glm::packHalf2x16(glm::vec2(vertex[6], vertex[7]));
+		allVertices.push_back(packed);
+	}
+	allIndices.insert(allIndices.end(), indices, indices + indexCount);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the buffers and the
+ *  vertex array.
+ ***********************************************************/
+void InstancedMeshes::Destroy()
+{
+	if (0 != m_vao)
+	{
+		glDeleteVertexArrays(1, &m_vao);
+	}
+	GLuint buffers[] = { m_vertexBufferID, m_indexBufferID, m_instanceBufferID, m_indirectBufferID };
+	for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+	{
+		if (0 != buffers[i])
+		{
+			glDeleteBuffers(1, &buffers[i]);
+		}
+	}
+
+	m_vao = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+	m_instanceBufferID = 0;
+	m_indirectBufferID = 0;
+	m_instanceCapacity = 0;
+	m_commandCapacity = 0;
+}
+
+/***********************************************************
+ *  MakeCommand()
+ *
+ *  This method is used for getting a draw command for a run
+ *  of instances with one of the meshes.  The caller counts
+ *  the instances into it.
+ ***********************************************************/
+DRAW_ELEMENTS_INDIRECT_COMMAND InstancedMeshes::MakeCommand(INSTANCED_MESH mesh, GLuint baseInstance) const
+{
+	DRAW_ELEMENTS_INDIRECT_COMMAND command;
+	command.count = m_meshes[mesh].indexCount;
+	command.instanceCount = 0;
+	command.firstIndex = m_meshes[mesh].firstIndex;
+	command.baseVertex = m_meshes[mesh].baseVertex;
+	command.baseInstance = baseInstance;
+	return(command);
+}
+
+/***********************************************************
+ *  UploadFrame()
+ *
+ *  This method is used for writing the instances and the
+ *  draw commands of the frame into their buffers.  The old
+ *  storage is given back first, so the driver does not wait
+ *  for the draws of the last frame that still read it, and a
+ *  buffer grows to twice what it ran out of room for.
+ ***********************************************************/
+void InstancedMeshes::UploadFrame(
+	const std::vector<INSTANCE_DATA>& instances,
+	const std::vector<DRAW_ELEMENTS_INDIRECT_COMMAND>& commands)
+{
+	m_frameInstances = (int)instances.size();
+	m_frameCommands = (int)commands.size();
+	m_drawCalls = 0;
+
+	if ((0 == m_vao) || (instances.empty()) || (commands.empty()))
+	{
+		return;
+	}
+
+	if (instances.size() > m_instanceCapacity)
+	{
+		m_instanceCapacity = instances.size() * 2;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(INSTANCE_DATA), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(INSTANCE_DATA), instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (commands.size() > m_commandCapacity)
+	{
+		m_commandCapacity = commands.size() * 2;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBufferID);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commandCapacity * sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND), commands.data());
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/***********************************************************
+ *  DrawCommands()
+ *
+ *  This method is used for submitting a run of the uploaded
+ *  draw commands with one multi-draw call.
+ ***********************************************************/
+void InstancedMeshes::DrawCommands(int firstCommand, int commandCount)
+{
+	if ((0 == m_vao) || (commandCount <= 0))
+	{
+		return;
+	}
+
+	glBindVertexArray(m_vao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBufferID);
+	glMultiDrawElementsIndirect(
+		GL_TRIANGLES,
+		GL_UNSIGNED_SHORT,
+		(const void*)((size_t)firstCommand * sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND)),
+		commandCount,
+		0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+
+	m_drawCalls++;
+}
+
+/***********************************************************
+ *  LogStats()
+ *
+ *  This method is used for printing the instances and the
+ *  draw commands of the last frame, and the draw calls that
+ *  submitted them.
+ ***********************************************************/
+void InstancedMeshes::LogStats() const
+{
+	printf("Instanced meshes: %d instances in %d indirect draws, submitted with %d draw calls\n",
+		m_frameInstances,
+		m_frameCommands,
+		m_drawCalls);
+}
@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.h
+// ============
+// draw the basic meshes from one shared buffer with multi-draw indirect
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// a vertex of the shared mesh buffer, packed into 20 bytes -
+// the vertex shaders read it as vertex attributes, or pull it
+// from a storage buffer and unpack it the same way
+struct PACKED_VERTEX
+{
+	GLfloat position[3];
+	// the normal as signed normalized 10-bit x, y and z, from
+	// the lowest bits up
+	GLuint normal;
+	// the texture coordinate as two half floats, u in the low
+	// bits
+	GLuint textureCoordinate;
+};
+static_assert(sizeof(PACKED_VERTEX) == 20, "PACKED_VERTEX must match the PackedVertex struct in the vertex shaders");
+
+// the per-instance vertex attributes of an instanced draw, as
+// read by the vertex shaders
+struct INSTANCE_DATA
+{
+	glm::mat4 model;
+	glm::vec4 color;
+	// the rectangle of the texture in its layer, as an offset
+	// in xy and a scale in zw
+	glm::vec4 atlasRect;
+	glm::vec2 uvScale;
+	// the index of the texture array and the layer of the
+	// texture in it
+	glm::ivec2 texture;
+	// index of the material in the material table, or -1
+	GLint materialIndex;
+	GLint padding[3];
+};
+static_assert(sizeof(INSTANCE_DATA) == 128, "INSTANCE_DATA must match the instance attribute offsets");
+
+// a draw of a run of instances with one mesh, in the layout
+// that glMultiDrawElementsIndirect reads
+struct DRAW_ELEMENTS_INDIRECT_COMMAND
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+static_assert(sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND) == 20, "DRAW_ELEMENTS_INDIRECT_COMMAND must match the GL layout");
+
+/***********************************************************
+ *  InstancedMeshes
+ *
+ *  This class owns copies of the basic meshes, with all of
+ *  their vertices suballocated from one vertex buffer and
+ *  all of their indices from one index buffer, behind a
+ *  single vertex array.  The instances of a frame and the
+ *  indirect draw commands that draw them are written once
+ *  per frame.  Each command draws a run of instances with
+ *  one mesh, selected by its first index and base vertex,
+ *  and the instance attributes are read from its base
+ *  instance on, so any number of commands that share a
+ *  program are submitted with one glMultiDrawElementsIndirect
+ *  and nothing is rebound between them.  The vertices are
+ *  either fetched as vertex attributes, or pulled by the
+ *  vertex shaders from the vertex buffer bound as a storage
+ *  buffer, by gl_VertexID, which counts from the base vertex
+ *  of each draw.  The meshes have the same shape and texture
+ *  coordinates as the ShapeMeshes meshes.
+ ***********************************************************/
+class InstancedMeshes
+{
+public:
+	// the meshes in the shared buffers
+	enum INSTANCED_MESH
+	{
+		INSTANCED_BOX = 0,
+		INSTANCED_CYLINDER,
+		INSTANCED_PLANE,
+		INSTANCED_SPHERE,
+		INSTANCED_MESH_COUNT
+	};
+
+	// how the vertex shaders read the mesh vertices
+	enum VERTEX_FETCH
+	{
+		// as vertex attributes at locations 0 to 2
+		FETCH_VERTEX_ARRAY = 0,
+		// from the storage buffer at VERTEX_STORAGE_BINDING, in
+		// the shader variants built with USE_VERTEX_PULLING
+		FETCH_VERTEX_PULLING
+	};
+
+	// binding point of the MeshVertices storage block in the
+	// vertex shaders
+	static const GLuint VERTEX_STORAGE_BINDING = 0;
+
+	// the attribute locations of the instance data in the vertex
+	// shaders - the model matrix takes four locations
+	static const GLuint MODEL_LOCATION = 3;
+	static const GLuint COLOR_LOCATION = 7;
+	static const GLuint MATERIAL_LOCATION = 8;
+	static const GLuint ATLAS_RECT_LOCATION = 9;
+	static const GLuint UV_SCALE_LOCATION = 10;
+	static const GLuint TEXTURE_LOCATION = 11;
+
+	// constructor
+	InstancedMeshes();
+	// destructor
+	~InstancedMeshes();
+
+	// create the shared buffers and the vertex array - requires
+	// a current GL context with vertex attribute binding and
+	// multi-draw indirect, and falls back to fetching vertex
+	// attributes when storage buffers are missing
+	bool Create(VERTEX_FETCH fetch);
+	// free the buffers and the vertex array
+	void Destroy();
+
+	// get a command that draws the mesh for the instances from
+	// the base instance on, with no instances yet
+	DRAW_ELEMENTS_INDIRECT_COMMAND MakeCommand(INSTANCED_MESH mesh, GLuint baseInstance) const;
+	// write the instances and the draw commands of the frame,
+	// which the following draws read
+	void UploadFrame(
+		const std::vector<INSTANCE_DATA>& instances,
+		const std::vector<DRAW_ELEMENTS_INDIRECT_COMMAND>& commands);
+	// submit a run of the uploaded draw commands
+	void DrawCommands(int firstCommand, int commandCount);
+	// print the draw calls, commands and instances of the last
+	// frame
+	void LogStats() const;
+
+	// get how the vertex shaders read the mesh vertices
+	inline VERTEX_FETCH GetVertexFetch() const
+	{
+		return(m_vertexFetch);
+	}
+
+private:
+	// the part of the shared buffers that holds a mesh
+	struct MESH_RANGE
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		GLint baseVertex;
+	};
+
+	MESH_RANGE m_meshes[INSTANCED_MESH_COUNT];
+	VERTEX_FETCH m_vertexFetch;
+	GLuint m_vao;
+	// the vertices and the indices of every mesh
+	GLuint m_vertexBufferID;
+	GLuint m_indexBufferID;
+	// the instances and the draw commands of the frame
+	GLuint m_instanceBufferID;
+	GLuint m_indirectBufferID;
+	// number of instances and of commands that the buffers of
+	// the frame have room for
+	size_t m_instanceCapacity;
+	size_t m_commandCapacity;
+	// the instances and the commands of the last upload, and
+	// the draw calls that submitted them
+	int m_frameInstances;
+	int m_frameCommands;
+	int m_drawCalls;
+
+	// pack a mesh into the vertices and indices of the shared
+	// buffers
+	void AddMesh(
+		INSTANCED_MESH mesh,
+		const GLfloat* vertices,
+		size_t vertexFloats,
+		const GLushort* indices,
+		size_t indexCount,
+		std::vector<PACKED_VERTEX>& allVertices,
+		std::vector<GLushort>& allIndices);
+};
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// materialtable.cpp
+// ============
+// keep the scene materials in a uniform block indexed by material number
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MaterialTable.h"
+
+#include <stdio.h>
+
+/***********************************************************
+ *  MaterialTable()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MaterialTable::MaterialTable()
+{
+	m_bufferID = 0;
+	m_materialCount = 0;
+}
+
+/***********************************************************
+ *  ~MaterialTable()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MaterialTable::~MaterialTable()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the uniform buffer with
+ *  the materials and binding it to the MaterialTable binding
+ *  point.  The buffer always has room for the whole array
+ *  that the shaders declare, with the unused materials left
+ *  at zero, and it is never written again, so it is created
+ *  as immutable storage when the driver supports it.
+ ***********************************************************/
+bool MaterialTable::Create(const std::vector<MATERIAL_DATA>& materials)
+{
+	Destroy();
+
+	if (materials.size() > MAX_MATERIALS)
+	{
+		printf("Too many materials - the shaders take at most %d materials\n", MAX_MATERIALS);
+		return(false);
+	}
+
+	std::vector<MATERIAL_DATA> table(MAX_MATERIALS, MATERIAL_DATA{ glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) });
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		table[i] = materials[i];
+	}
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	if (GLEW_ARB_buffer_storage)
+	{
+		glBufferStorage(GL_UNIFORM_BUFFER, sizeof(MATERIAL_DATA) * table.size(), table.data(), 0);
+	}
+	else
+	{
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(MATERIAL_DATA) * table.size(), table.data(), GL_STATIC_DRAW);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, m_bufferID);
+	m_materialCount = (int)materials.size();
+
+	printf("Created material table: %d of %d materials\n", m_materialCount, MAX_MATERIALS);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the uniform buffer.
+ ***********************************************************/
+void MaterialTable::Destroy()
+{
+	if (0 != m_bufferID)
+	{
+		glDeleteBuffers(1, &m_bufferID);
+	}
+
+	m_bufferID = 0;
+	m_materialCount = 0;
+}
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// materialtable.h
+// ============
+// keep the scene materials in a uniform block indexed by material number
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// std140 layout of one element of the materials array in the
+// MaterialTable uniform block declared in the fragment shaders
+struct MATERIAL_DATA
+{
+	// rgb holds the ambient color, a the ambient strength
+	glm::vec4 ambient;
+	// rgb holds the diffuse color, a is padding
+	glm::vec4 diffuse;
+	// rgb holds the specular color, a the shininess
+	glm::vec4 specular;
+};
+static_assert(sizeof(MATERIAL_DATA) == 48, "MATERIAL_DATA must match the std140 Material struct");
+
+/***********************************************************
+ *  MaterialTable
+ *
+ *  This class owns a uniform buffer that holds every scene
+ *  material, packed when the scene is prepared.  The buffer
+ *  stays bound to the MaterialTable binding point, so every
+ *  program that declares the block reads the same table, and
+ *  a draw selects its material with a single integer instead
+ *  of writing the material into uniforms.
+ ***********************************************************/
+class MaterialTable
+{
+public:
+	// binding point of the MaterialTable block in the shaders
+	static const GLuint BINDING_POINT = 1;
+	// the size of the materials array in the shaders
+	static const int MAX_MATERIALS = 256;
+
+	// constructor
+	MaterialTable();
+	// destructor
+	~MaterialTable();
+
+	// create the buffer with the passed in materials and bind
+	// it - requires a current GL context, and returns false
+	// when there are more materials than the shaders hold
+	bool Create(const std::vector<MATERIAL_DATA>& materials);
+	// free the buffer object
+	void Destroy();
+
+	// get the number of materials in the table
+	inline int GetMaterialCount() const
+	{
+		return(m_materialCount);
+	}
+
+private:
+	// uniform buffer holding the materials
+	GLuint m_bufferID;
+	// number of materials written into the buffer
+	int m_materialCount;
+};
@@ -0,0 +1,429 @@
+///////////////////////////////////////////////////////////////////////////////
+// mipgenerator.cpp
+// ============
+// build the mipmap chain of texture data on worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MipGenerator.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#include <algorithm>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MIP_GENERATOR_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define MIP_GENERATOR_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// number of destination rows in one band of work
+	const int g_BandRows = 16;
+	// the shape of the Kaiser window
+	const double g_KaiserAlpha = 4.0;
+	// half the width of the Kaiser filter, in destination pixels
+	const double g_KaiserRadius = 1.5;
+
+	// the generated levels, along with the owner of level 0,
+	// which the result shares with the source
+	struct GENERATED_LEVELS
+	{
+		std::shared_ptr<const void> pSourceOwner;
+		std::vector<unsigned char> pixels;
+	};
+
+	/***********************************************************
+	 *  BesselI0()
+	 *
+	 *  This function is used for the modified Bessel function
+	 *  of order 0, which shapes the Kaiser window.
+	 ***********************************************************/
+	double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return(sum);
+	}
+
+	/***********************************************************
+	 *  AccumulateRow()
+	 *
+	 *  This function is used for adding a weighted row of
+	 *  floats to another row, eight at a time with AVX2 or four
+	 *  at a time with SSE2.  The count is a multiple of 4.
+	 ***********************************************************/
+	void AccumulateRow(float* pDestination, const float* pSource, float weight, size_t count)
+	{
+		size_t i = 0;
+#ifdef MIP_GENERATOR_AVX2
+		__m256 weight8 = _mm256_set1_ps(weight);
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 sum = _mm256_add_ps(_mm256_loadu_ps(pDestination + i), _mm256_mul_ps(_mm256_loadu_ps(pSource + i), weight8));
+			_mm256_storeu_ps(pDestination + i, sum);
+		}
+#endif
+#ifdef MIP_GENERATOR_SSE2
+		__m128 weight4 = _mm_set1_ps(weight);
+		for (; i < count; i += 4)
+		{
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(pDestination + i), _mm_mul_ps(_mm_loadu_ps(pSource + i), weight4));
+			_mm_storeu_ps(pDestination + i, sum);
+		}
+#else
+		for (; i < count; i++)
+		{
+			pDestination[i] += pSource[i] * weight;
+		}
+#endif
+	}
+}
+
+/***********************************************************
+ *  MipGenerator()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MipGenerator::MipGenerator(unsigned int threadCount)
+{
+	m_nextBand = 0;
+	m_finishedBands = 0;
+	m_bStopRequested = false;
+
+	// the box filter averages the two pixels under each one
+	m_boxKernel.firstOffset = 0;
+	m_boxKernel.weights.push_back(0.5f);
+	m_boxKernel.weights.push_back(0.5f);
+
+	// the Kaiser filter reaches two pixels further on each side,
+	// with the weights taken at the distance of each source
+	// pixel center from the destination pixel center
+	m_kaiserKernel.firstOffset = -2;
+	double weightSum = 0.0;
+	std::vector<double> weights;
+	for (int offset = -2; offset <= 3; offset++)
+	{
+		double distance = (offset - 0.5) / 2.0;
+		double sinc = sin(3.14159265358979 * distance) / (3.14159265358979 * distance);
+		double window = BesselI0(g_KaiserAlpha * sqrt(1.0 - (distance / g_KaiserRadius) * (distance / g_KaiserRadius))) / BesselI0(g_KaiserAlpha);
+		weights.push_back(sinc * window);
+		weightSum += sinc * window;
+	}
+	for (size_t i = 0; i < weights.size(); i++)
+	{
+		m_kaiserKernel.weights.push_back((float)(weights[i] / weightSum));
+	}
+
+	for (int i = 0; i < 256; i++)
+	{
+		double value = i / 255.0;
+		m_toLinear[i] = (float)((value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4));
+	}
+	for (int i = 0; i < 4096; i++)
+	{
+		double value = i / 4095.0;
+		double encoded = (value <= 0.0031308) ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+		m_toSRGB[i] = (unsigned char)(encoded * 255.0 + 0.5);
+	}
+
+	if (threadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads : 1;
+	}
+
+	// the calling thread filters too
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&MipGenerator::WorkerThread, this));
+	}
+}
+
+/***********************************************************
+ *  ~MipGenerator()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MipGenerator::~MipGenerator()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopRequested = true;
+	}
+	m_workReady.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for building every level below level
+ *  0, down to 1x1.  The levels are built one after another,
+ *  each from the level above it, and the rows of each level
+ *  are split into bands that are filtered in parallel.  The
+ *  call returns once every level is done.  The result owns
+ *  the new levels and keeps level 0 of the source alive.
+ ***********************************************************/
+bool MipGenerator::Generate(
+	const TEXTURE_DATA& source,
+	MIP_FILTER filter,
+	bool bSRGB,
+	TEXTURE_DATA& result)
+{
+	if (((source.pixelFormat != GL_RGB) && (source.pixelFormat != GL_RGBA)) || (source.levels.empty()))
+	{
+		printf("Only mipmaps of uncompressed RGB and RGBA textures can be generated\n");
+		return(false);
+	}
+
+	int channels = (source.pixelFormat == GL_RGBA) ? 4 : 3;
+	int levelCount = GetMipLevelCount(source.width, source.height);
+	const FILTER_KERNEL* pKernel = (filter == FILTER_KAISER) ? &m_kaiserKernel : &m_boxKernel;
+
+	// lay the new levels out one after another in one buffer
+	std::vector<TEXTURE_LEVEL> levels;
+	levels.push_back(source.levels[0]);
+	std::vector<size_t> offsets;
+	size_t totalSize = 0;
+	for (int level = 1; level < levelCount; level++)
+	{
+		TEXTURE_LEVEL next;
+		next.width = std::max(source.width >> level, 1);
+		next.height = std::max(source.height >> level, 1);
+		next.size = (size_t)next.width * next.height * channels;
+		next.pixels = NULL;
+		offsets.push_back(totalSize);
+		totalSize += next.size;
+		levels.push_back(next);
+	}
+
+	std::shared_ptr<GENERATED_LEVELS> pGenerated = std::make_shared<GENERATED_LEVELS>();
+	pGenerated->pSourceOwner = source.pOwner;
+	pGenerated->pixels.resize(totalSize);
+	for (int level = 1; level < levelCount; level++)
+	{
+		levels[level].pixels = &pGenerated->pixels[offsets[level - 1]];
+	}
+
+	std::lock_guard<std::mutex> generateLock(m_generateMutex);
+
+	for (int level = 1; level < levelCount; level++)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bands.clear();
+			for (int firstRow = 0; firstRow < levels[level].height; firstRow += g_BandRows)
+			{
+				FILTER_BAND band;
+				band.pSource = levels[level - 1].pixels;
+				band.sourceWidth = levels[level - 1].width;
+				band.sourceHeight = levels[level - 1].height;
+				band.pDestination = (unsigned char*)levels[level].pixels;
+				band.width = levels[level].width;
+				band.channels = channels;
+				band.firstRow = firstRow;
+				band.rowCount = std::min(g_BandRows, levels[level].height - firstRow);
+				band.pKernel = pKernel;
+				band.bSRGB = bSRGB;
+				m_bands.push_back(band);
+			}
+			m_nextBand = 0;
+			m_finishedBands = 0;
+		}
+		m_workReady.notify_all();
+
+		FilterBands();
+
+		// the next level is filtered from this one
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bandsDone.wait(lock, [this]() { return(m_finishedBands == m_bands.size()); });
+		m_bands.clear();
+		m_nextBand = 0;
+		m_finishedBands = 0;
+	}
+
+	result.filename = source.filename;
+	result.width = source.width;
+	result.height = source.height;
+	result.internalFormat = source.internalFormat;
+	result.pixelFormat = source.pixelFormat;
+	result.levels = levels;
+	result.bGenerateMipmaps = false;
+	result.pOwner = pGenerated;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FilterBands()
+ *
+ *  This method is used for taking bands off the current
+ *  level and filtering them until none are left.
+ ***********************************************************/
+void MipGenerator::FilterBands()
+{
+	for (;;)
+	{
+		FILTER_BAND band;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_nextBand >= m_bands.size())
+			{
+				return;
+			}
+			band = m_bands[m_nextBand];
+			m_nextBand++;
+		}
+
+		FilterBand(band);
+
+		bool bLastBand = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finishedBands++;
+			bLastBand = (m_finishedBands == m_bands.size());
+		}
+		if (bLastBand)
+		{
+			m_bandsDone.notify_all();
+		}
+	}
+}
+
+/***********************************************************
+ *  FilterBand()
+ *
+ *  This method is used for filtering the rows of a band.
+ *  The filter is separable: each source row that a band
+ *  needs is converted to linear RGBA floats and filtered
+ *  across once, then kept while the rows below it use it,
+ *  and each destination row adds up the filtered source rows
+ *  under it.  Pixels past the edges repeat the edge pixels.
+ ***********************************************************/
+void MipGenerator::FilterBand(const FILTER_BAND& band) const
+{
+	const FILTER_KERNEL& kernel = *band.pKernel;
+	int taps = (int)kernel.weights.size();
+	size_t rowFloats = (size_t)band.width * 4;
+
+	std::vector<float> linearRow((size_t)band.sourceWidth * 4);
+	std::vector<std::vector<float>> filteredRows(taps, std::vector<float>(rowFloats));
+	std::vector<int> filteredSourceRows(taps, -1);
+	std::vector<float> destinationRow(rowFloats);
+
+	for (int y = band.firstRow; y < band.firstRow + band.rowCount; y++)
+	{
+		std::fill(destinationRow.begin(), destinationRow.end(), 0.0f);
+
+		for (int tap = 0; tap < taps; tap++)
+		{
+			int sourceY = std::min(std::max(y * 2 + kernel.firstOffset + tap, 0), band.sourceHeight - 1);
+
+			// the rows under a destination row are consecutive, so
+			// each has its own slot
+			int slot = sourceY % taps;
+			if (filteredSourceRows[slot] != sourceY)
+			{
+				const unsigned char* pRow = band.pSource + (size_t)sourceY * band.sourceWidth * band.channels;
+				for (int x = 0; x < band.sourceWidth; x++)
+				{
+					const unsigned char* pPixel = pRow + x * band.channels;
+					for (int c = 0; c < 3; c++)
+					{
+						linearRow[x * 4 + c] = band.bSRGB ? m_toLinear[pPixel[c]] : pPixel[c] / 255.0f;
+					}
+					linearRow[x * 4 + 3] = (band.channels == 4) ? pPixel[3] / 255.0f : 1.0f;
+				}
+
+				float* pFiltered = &filteredRows[slot][0];
+				for (int x = 0; x < band.width; x++)
+				{
+#ifdef MIP_GENERATOR_SSE2
+					__m128 sum = _mm_setzero_ps();
+					for (int t = 0; t < taps; t++)
+					{
+						int sourceX = std::min(std::max(x * 2 + kernel.firstOffset + t, 0), band.sourceWidth - 1);
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&linearRow[sourceX * 4]), _mm_set1_ps(kernel.weights[t])));
+					}
+					_mm_storeu_ps(pFiltered + x * 4, sum);
+#else
+					float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					for (int t = 0; t < taps; t++)
+					{
+						int sourceX = std::min(std::max(x * 2 + kernel.firstOffset + t, 0), band.sourceWidth - 1);
+						for (int c = 0; c < 4; c++)
+						{
+							sum[c] += linearRow[sourceX * 4 + c] * kernel.weights[t];
+						}
+					}
+					for (int c = 0; c < 4; c++)
+					{
+						pFiltered[x * 4 + c] = sum[c];
+					}
+#endif
+				}
+				filteredSourceRows[slot] = sourceY;
+			}
+
+			AccumulateRow(&destinationRow[0], &filteredRows[slot][0], kernel.weights[tap], rowFloats);
+		}
+
+		// the sharper filter can overshoot, so the values are
+		// clamped before they are encoded
+		unsigned char* pDestination = band.pDestination + (size_t)y * band.width * band.channels;
+		for (int x = 0; x < band.width; x++)
+		{
+			for (int c = 0; c < band.channels; c++)
+			{
+				float value = std::min(std::max(destinationRow[x * 4 + c], 0.0f), 1.0f);
+				if ((band.bSRGB) && (c < 3))
+				{
+					pDestination[x * band.channels + c] = m_toSRGB[(int)(value * 4095.0f + 0.5f)];
+				}
+				else
+				{
+					pDestination[x * band.channels + c] = (unsigned char)(value * 255.0f + 0.5f);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method is the main loop of a worker thread, which
+ *  helps with each level as it is queued.
+ ***********************************************************/
+void MipGenerator::WorkerThread()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workReady.wait(lock, [this]() { return(m_bStopRequested || (m_nextBand < m_bands.size())); });
+			if (m_bStopRequested)
+			{
+				return;
+			}
+		}
+
+		FilterBands();
+	}
+}
@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// mipgenerator.h
+// ============
+// build the mipmap chain of texture data on worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureData.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/***********************************************************
+ *  MipGenerator
+ *
+ *  This class builds every mipmap level of uncompressed
+ *  texture data on the CPU, so the mipmaps look the same on
+ *  every driver and do not depend on glGenerateMipmap().  The
+ *  colors are filtered in linear space when the pixels are
+ *  sRGB encoded, and alpha is always filtered as is.  Each
+ *  level is built from the one above it, cut into bands of
+ *  rows that a pool of worker threads and the calling thread
+ *  filter in parallel, with SSE2 and AVX2 kernels when they
+ *  are available.
+ ***********************************************************/
+class MipGenerator
+{
+public:
+	// the downsampling filters
+	enum MIP_FILTER
+	{
+		// the average of each 2x2 square of pixels
+		FILTER_BOX,
+		// a Kaiser windowed sinc over 6x6 pixels, which keeps
+		// the smaller levels sharper
+		FILTER_KAISER
+	};
+
+	// constructor - a thread count of 0 uses one thread for
+	// each hardware thread, leaving one for the main thread
+	MipGenerator(unsigned int threadCount = 0);
+	// destructor
+	~MipGenerator();
+
+	// build the levels below level 0 of uncompressed texture
+	// data - the result shares level 0 with the source
+	bool Generate(
+		const TEXTURE_DATA& source,
+		MIP_FILTER filter,
+		bool bSRGB,
+		TEXTURE_DATA& result);
+
+	// get the number of threads that filter, including the
+	// calling thread
+	inline unsigned int GetThreadCount() const
+	{
+		return((unsigned int)m_threads.size() + 1);
+	}
+
+private:
+	// the taps of the separable filter, as offsets from the
+	// first source pixel of each destination pixel
+	struct FILTER_KERNEL
+	{
+		int firstOffset;
+		std::vector<float> weights;
+	};
+
+	// a band of destination rows in one level
+	struct FILTER_BAND
+	{
+		const unsigned char* pSource;
+		int sourceWidth;
+		int sourceHeight;
+		unsigned char* pDestination;
+		int width;
+		int channels;
+		int firstRow;
+		int rowCount;
+		const FILTER_KERNEL* pKernel;
+		bool bSRGB;
+	};
+
+	// the worker threads
+	std::vector<std::thread> m_threads;
+	// guards the bands and the counters
+	std::mutex m_mutex;
+	// only one texture is generated at a time
+	std::mutex m_generateMutex;
+	// signals the workers that there are bands, or that they
+	// should exit
+	std::condition_variable m_workReady;
+	// signals the caller that the last band was filtered
+	std::condition_variable m_bandsDone;
+	// the bands of the level being built
+	std::vector<FILTER_BAND> m_bands;
+	// index of the next band to filter
+	size_t m_nextBand;
+	// number of bands that are filtered
+	size_t m_finishedBands;
+	// set when the workers should exit
+	bool m_bStopRequested;
+
+	// the kernels of the filters
+	FILTER_KERNEL m_boxKernel;
+	FILTER_KERNEL m_kaiserKernel;
+	// sRGB encoded values to linear values
+	float m_toLinear[256];
+	// linear values, in steps of 1/4095, to sRGB encoded values
+	unsigned char m_toSRGB[4096];
+
+	// filter the bands until none are left
+	void FilterBands();
+	// filter the rows of one band
+	void FilterBand(const FILTER_BAND& band) const;
+	// the main loop of a worker thread
+	void WorkerThread();
+};
@@ -0,0 +1,302 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// sort the draws of a frame by 64-bit keys to minimize state changes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	// the width of each field of a sort key - the values are
+	// stored plus one, so -1 for none sorts first, and larger
+	// values share the last one
+	const int g_ProgramBits = 8;
+	const int g_TextureBits = 12;
+	const int g_MaterialBits = 9;
+	const int g_MeshBits = 4;
+	const int g_DepthBits = 24;
+
+	// the pass is the top two bits of every key
+	const int g_PassShift = 62;
+
+	// where the fields of a key start - opaque keys put the
+	// state above the depth, and transparent keys the depth
+	// above the state
+	struct KEY_LAYOUT
+	{
+		int programShift;
+		int textureShift;
+		int materialShift;
+		int meshShift;
+		int depthShift;
+	};
+	const KEY_LAYOUT g_OpaqueLayout = { 54, 42, 33, 29, 5 };
+	const KEY_LAYOUT g_TransparentLayout = { 30, 18, 9, 5, 38 };
+
+	/***********************************************************
+	 *  PackField()
+	 *
+	 *  This function is used for placing a handle into a field
+	 *  of a key.
+	 ***********************************************************/
+	inline uint64_t PackField(int value, int bits, int shift)
+	{
+		uint64_t mask = ((uint64_t)1 << bits) - 1;
+		uint64_t field = (value < 0) ? 0 : (uint64_t)value + 1;
+		return(((field < mask) ? field : mask) << shift);
+	}
+
+	/***********************************************************
+	 *  GetField()
+	 *
+	 *  This function is used for reading a field of a key.
+	 ***********************************************************/
+	inline int GetField(uint64_t key, int bits, int shift)
+	{
+		return((int)((key >> shift) & (((uint64_t)1 << bits) - 1)));
+	}
+
+	/***********************************************************
+	 *  GetDepthBits()
+	 *
+	 *  This function is used for turning a depth into the
+	 *  unsigned bits of a key field that sort in the same order
+	 *  as the depths.  The sign bit of a positive float is set,
+	 *  and every bit of a negative one is flipped, so the bits
+	 *  of any two floats compare like the floats, and the top
+	 *  bits of the result keep that order.
+	 ***********************************************************/
+	inline uint32_t GetDepthBits(float depth)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &depth, sizeof(bits));
+		bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+		return(bits >> (32 - g_DepthBits));
+	}
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for dropping the draws of the last
+ *  frame.  The memory of the queue is kept for the next one.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_entries.clear();
+}
+
+/***********************************************************
+ *  Push()
+ *
+ *  This method is used for adding a draw to the queue, with
+ *  its sort key built from its state.
+ ***********************************************************/
+void RenderQueue::Push(const DRAW_KEY& key, uint32_t payload)
+{
+	QUEUE_ENTRY entry;
+	entry.key = MakeSortKey(key);
+	entry.payload = payload;
+	m_entries.push_back(entry);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for sorting the draws by their keys.
+ *  The state changes are counted in the order the draws were
+ *  pushed first, to show what the sorting saved, and then in
+ *  the sorted order that they are drawn in.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	QUEUE_STATS unsorted = CountStateChanges();
+
+	RadixSort();
+
+	m_stats = CountStateChanges();
+	m_stats.unsortedChanges =
+		unsorted.programChanges +
+		unsorted.textureChanges +
+		unsorted.materialChanges +
+		unsorted.meshChanges;
+}
+
+/***********************************************************
+ *  LogStats()
+ *
+ *  This method is used for printing the state changes that
+ *  the last sorted frame needed.
+ ***********************************************************/
+void RenderQueue::LogStats() const
+{
+	int sortedChanges =
+		m_stats.programChanges +
+		m_stats.textureChanges +
+		m_stats.materialChanges +
+		m_stats.meshChanges;
+
+	printf("Render queue: %d draws, %d program, %d texture, %d material and %d mesh changes - %d state changes sorted, %d unsorted\n",
+		m_stats.draws,
+		m_stats.programChanges,
+		m_stats.textureChanges,
+		m_stats.materialChanges,
+		m_stats.meshChanges,
+		sortedChanges,
+		m_stats.unsortedChanges);
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method is used for building the sort key of a draw.
+ *  Transparent draws are drawn from the farthest, so their
+ *  depth bits are flipped.
+ ***********************************************************/
+uint64_t RenderQueue::MakeSortKey(const DRAW_KEY& key)
+{
+	bool bTransparent = (key.pass == PASS_TRANSPARENT);
+	const KEY_LAYOUT& layout = bTransparent ? g_TransparentLayout : g_OpaqueLayout;
+
+	uint32_t depthMask = (1u << g_DepthBits) - 1;
+	uint32_t depth = GetDepthBits(key.depth);
+	if (bTransparent)
+	{
+		depth = depthMask - depth;
+	}
+
+	uint64_t sortKey = (uint64_t)key.pass << g_PassShift;
+	sortKey |= PackField(key.program, g_ProgramBits, layout.programShift);
+	sortKey |= PackField(key.texture, g_TextureBits, layout.textureShift);
+	sortKey |= PackField(key.material, g_MaterialBits, layout.materialShift);
+	sortKey |= PackField(key.mesh, g_MeshBits, layout.meshShift);
+	sortKey |= (uint64_t)(depth & depthMask) << layout.depthShift;
+
+	return(sortKey);
+}
+
+/***********************************************************
+ *  RadixSort()
+ *
+ *  This method is used for sorting the entries by key with a
+ *  least significant digit radix sort, one byte per pass.
+ *  The counts of every byte are gathered in a single read of
+ *  the keys, and a byte that is the same in every key is
+ *  skipped, since its pass would not move anything.  Each
+ *  pass is stable, so draws with the same key stay in the
+ *  order they were pushed.
+ ***********************************************************/
+void RenderQueue::RadixSort()
+{
+	size_t count = m_entries.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	size_t counts[8][256];
+	memset(counts, 0, sizeof(counts));
+	for (size_t i = 0; i < count; i++)
+	{
+		uint64_t key = m_entries[i].key;
+		for (int digit = 0; digit < 8; digit++)
+		{
+			counts[digit][(key >> (digit * 8)) & 0xff]++;
+		}
+	}
+
+	m_scratch.resize(count);
+	QUEUE_ENTRY* pSource = m_entries.data();
+	QUEUE_ENTRY* pDestination = m_scratch.data();
+
+	for (int digit = 0; digit < 8; digit++)
+	{
+		int shift = digit * 8;
+		if (counts[digit][(pSource[0].key >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		// the first slot of each byte value
+		size_t offsets[256];
+		size_t offset = 0;
+		for (int value = 0; value < 256; value++)
+		{
+			offsets[value] = offset;
+			offset += counts[digit][value];
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			pDestination[offsets[(pSource[i].key >> shift) & 0xff]++] = pSource[i];
+		}
+
+		QUEUE_ENTRY* pSorted = pDestination;
+		pDestination = pSource;
+		pSource = pSorted;
+	}
+
+	// an odd number of passes leaves the result in the scratch
+	// buffer
+	if (pSource != m_entries.data())
+	{
+		m_entries.swap(m_scratch);
+	}
+}
+
+/***********************************************************
+ *  CountStateChanges()
+ *
+ *  This method is used for counting how often the program,
+ *  texture, material and mesh change between the draws in
+ *  their current order.  The first draw sets each of them.
+ ***********************************************************/
+RenderQueue::QUEUE_STATS RenderQueue::CountStateChanges() const
+{
+	QUEUE_STATS stats;
+	memset(&stats, 0, sizeof(stats));
+	stats.draws = (int)m_entries.size();
+
+	int program = -1;
+	int texture = -1;
+	int material = -1;
+	int mesh = -1;
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		uint64_t key = m_entries[i].key;
+		const KEY_LAYOUT& layout = (GetField(key, 2, g_PassShift) == PASS_TRANSPARENT) ? g_TransparentLayout : g_OpaqueLayout;
+
+		int field = GetField(key, g_ProgramBits, layout.programShift);
+		stats.programChanges += (field != program) ? 1 : 0;
+		program = field;
+
+		field = GetField(key, g_TextureBits, layout.textureShift);
+		stats.textureChanges += (field != texture) ? 1 : 0;
+		texture = field;
+
+		field = GetField(key, g_MaterialBits, layout.materialShift);
+		stats.materialChanges += (field != material) ? 1 : 0;
+		material = field;
+
+		field = GetField(key, g_MeshBits, layout.meshShift);
+		stats.meshChanges += (field != mesh) ? 1 : 0;
+		mesh = field;
+	}
+
+	return(stats);
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// sort the draws of a frame by 64-bit keys to minimize state changes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class collects the draws of a frame as 64-bit sort
+ *  keys, each with a small payload that identifies the draw
+ *  to its owner, and radix sorts them before they are drawn.
+ *  The key holds the pass in its top bits, so the opaque
+ *  draws come before the transparent ones.  Opaque draws are
+ *  then ordered by program, texture, material and mesh, so
+ *  each state is changed as rarely as possible, and front to
+ *  back within the same state, so the depth test rejects the
+ *  hidden pixels early.  Transparent draws are ordered back
+ *  to front first, since they blend over what is behind them,
+ *  and by state only at the same depth.  The state changes
+ *  that the sorted order needs are counted for each frame.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// the passes that the draws are sorted into, in the order
+	// they are drawn
+	enum RENDER_PASS
+	{
+		PASS_OPAQUE = 0,
+		PASS_TRANSPARENT
+	};
+
+	// the state of a draw that its sort key is built from
+	struct DRAW_KEY
+	{
+		RENDER_PASS pass;
+		// handles of the shader program, the texture and the
+		// material, and the number of the mesh, each -1 for none
+		int program;
+		int texture;
+		int material;
+		int mesh;
+		// the distance of the draw from the camera, as any value
+		// that grows with the distance
+		float depth;
+	};
+
+	// the state changes needed to draw a frame
+	struct QUEUE_STATS
+	{
+		int draws;
+		int programChanges;
+		int textureChanges;
+		int materialChanges;
+		int meshChanges;
+		// all of the changes above had the draws been made in the
+		// order they were pushed
+		int unsortedChanges;
+	};
+
+	// constructor
+	RenderQueue();
+
+	// drop the draws of the last frame
+	void Clear();
+	// add a draw - the payload is handed back in sorted order
+	void Push(const DRAW_KEY& key, uint32_t payload);
+	// sort the draws by their keys and count the state changes
+	// of the sorted order
+	void Sort();
+	// print the state changes of the last sorted frame
+	void LogStats() const;
+
+	// get the number of draws
+	inline size_t GetCount() const
+	{
+		return(m_entries.size());
+	}
+	// get the payload of a draw, in sorted order after Sort()
+	inline uint32_t GetPayload(size_t index) const
+	{
+		return(m_entries[index].payload);
+	}
+	// get the state changes of the last sorted frame
+	inline const QUEUE_STATS& GetStats() const
+	{
+		return(m_stats);
+	}
+
+	// build the sort key of a draw
+	static uint64_t MakeSortKey(const DRAW_KEY& key);
+
+private:
+	// a draw in the queue
+	struct QUEUE_ENTRY
+	{
+		uint64_t key;
+		uint32_t payload;
+	};
+
+	// the draws of the frame
+	std::vector<QUEUE_ENTRY> m_entries;
+	// the second buffer that the radix sort passes write into,
+	// kept between frames so sorting does not allocate
+	std::vector<QUEUE_ENTRY> m_scratch;
+	// the state changes of the last sorted frame
+	QUEUE_STATS m_stats;
+
+	// sort the entries by key, one byte of the key per pass
+	void RadixSort();
+	// count the state changes between the entries in their
+	// current order
+	QUEUE_STATS CountStateChanges() const;
+};
@@ -0,0 +1,343 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderfilewatcher.cpp
+// ============
+// watch shader source files for changes on a background thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderFileWatcher.h"
+
+#include <stdio.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// how long a file must be quiet before its change is reported
+	const std::chrono::milliseconds g_QuietPeriod(100);
+	// how often the watcher thread checks for changes and for
+	// the stop request
+	const int g_WakeIntervalMs = 50;
+	// how often the file times are compared when polling
+	const std::chrono::milliseconds g_PollInterval(500);
+}
+
+/***********************************************************
+ *  ShaderFileWatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderFileWatcher::ShaderFileWatcher()
+{
+	m_bStopRequested = false;
+#ifdef __linux__
+	m_inotifyFD = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~ShaderFileWatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderFileWatcher::~ShaderFileWatcher()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the watcher thread.  The
+ *  callback is called on the watcher thread, so it must not
+ *  make any OpenGL calls.
+ ***********************************************************/
+bool ShaderFileWatcher::Start(ChangeCallback callback)
+{
+	if (IsRunning())
+	{
+		return(true);
+	}
+
+	m_callback = callback;
+	m_bStopRequested = false;
+
+#ifdef __linux__
+	m_inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotifyFD < 0)
+	{
+		printf("inotify is not available, polling the shader files instead\n");
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto it = m_files.begin(); it != m_files.end(); ++it)
+		{
+			WatchDirectory(it->first);
+		}
+	}
+#endif
+
+	m_thread = std::thread(&ShaderFileWatcher::WatchThread, this);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the watcher thread.  The
+ *  thread wakes up regularly, so this waits at most one wake
+ *  interval.
+ ***********************************************************/
+void ShaderFileWatcher::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	m_bStopRequested = true;
+	m_thread.join();
+
+#ifdef __linux__
+	if (m_inotifyFD >= 0)
+	{
+		close(m_inotifyFD);
+		m_inotifyFD = -1;
+	}
+	m_watchedDirectories.clear();
+#endif
+}
+
+/***********************************************************
+ *  WatchFile()
+ *
+ *  This method is used for adding a file to the watch list.
+ *  Adding a file that is already watched does nothing.
+ ***********************************************************/
+void ShaderFileWatcher::WatchFile(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_files.find(path) != m_files.end())
+	{
+		return;
+	}
+
+	std::error_code error;
+	WATCHED_FILE file;
+	file.writeTime = std::filesystem::last_write_time(path, error);
+	file.bExists = !error;
+	m_files[path] = file;
+
+#ifdef __linux__
+	if (m_inotifyFD >= 0)
+	{
+		WatchDirectory(path);
+	}
+#endif
+}
+
+#ifdef __linux__
+/***********************************************************
+ *  WatchDirectory()
+ *
+ *  This method is used for adding an inotify watch for the
+ *  directory of a file.  Directories are watched instead of
+ *  the files, since many editors save by writing a new file
+ *  and renaming it over the old one.  Called with the watch
+ *  lists locked.
+ ***********************************************************/
+void ShaderFileWatcher::WatchDirectory(const std::string& path)
+{
+	std::string directory = GetDirectory(path);
+	for (auto it = m_watchedDirectories.begin(); it != m_watchedDirectories.end(); ++it)
+	{
+		if (it->second == directory)
+		{
+			return;
+		}
+	}
+
+	int watch = inotify_add_watch(
+		m_inotifyFD,
+		directory.empty() ? "." : directory.c_str(),
+		IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (watch < 0)
+	{
+		printf("Could not watch the shader directory %s\n", directory.c_str());
+		return;
+	}
+
+	m_watchedDirectories[watch] = directory;
+}
+
+/***********************************************************
+ *  ReadNotifyEvents()
+ *
+ *  This method is used for reading the queued inotify events
+ *  and marking the watched files they name as changed.
+ ***********************************************************/
+void ShaderFileWatcher::ReadNotifyEvents()
+{
+	alignas(struct inotify_event) char buffer[4096];
+
+	for (;;)
+	{
+		ssize_t length = read(m_inotifyFD, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (char* pEvent = buffer; pEvent < buffer + length; )
+		{
+			const struct inotify_event* pNotify = (const struct inotify_event*)pEvent;
+			pEvent += sizeof(struct inotify_event) + pNotify->len;
+
+			auto directory = m_watchedDirectories.find(pNotify->wd);
+			if ((directory == m_watchedDirectories.end()) || (pNotify->len == 0))
+			{
+				continue;
+			}
+
+			std::string path = directory->second + pNotify->name;
+			if (m_files.find(path) != m_files.end())
+			{
+				m_pendingChanges[path] = std::chrono::steady_clock::now();
+			}
+		}
+	}
+}
+#endif
+
+/***********************************************************
+ *  WatchThread()
+ *
+ *  This method is the main loop of the watcher thread.  It
+ *  waits for inotify events, or polls the file times when
+ *  inotify is not available, and reports the files that
+ *  have been quiet long enough.
+ ***********************************************************/
+void ShaderFileWatcher::WatchThread()
+{
+	std::chrono::steady_clock::time_point lastPoll = std::chrono::steady_clock::now();
+
+	while (!m_bStopRequested)
+	{
+#ifdef __linux__
+		if (m_inotifyFD >= 0)
+		{
+			struct pollfd notify;
+			notify.fd = m_inotifyFD;
+			notify.events = POLLIN;
+			notify.revents = 0;
+			if (poll(&notify, 1, g_WakeIntervalMs) > 0)
+			{
+				ReadNotifyEvents();
+			}
+			ReportChanges();
+			continue;
+		}
+#endif
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(g_WakeIntervalMs));
+		if (std::chrono::steady_clock::now() - lastPoll >= g_PollInterval)
+		{
+			PollFiles();
+			lastPoll = std::chrono::steady_clock::now();
+		}
+		ReportChanges();
+	}
+}
+
+/***********************************************************
+ *  PollFiles()
+ *
+ *  This method is used for comparing the write time of each
+ *  watched file with the time seen by the last poll.
+ ***********************************************************/
+void ShaderFileWatcher::PollFiles()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (auto it = m_files.begin(); it != m_files.end(); ++it)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(it->first, error);
+		if (error)
+		{
+			it->second.bExists = false;
+			continue;
+		}
+
+		if ((it->second.bExists == false) || (writeTime != it->second.writeTime))
+		{
+			it->second.writeTime = writeTime;
+			it->second.bExists = true;
+			m_pendingChanges[it->first] = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportChanges()
+ *
+ *  This method is used for calling back with the changed
+ *  files that have not been written for the quiet period.
+ *  The callback runs without the watch lists locked, so it
+ *  may add more files to watch.
+ ***********************************************************/
+void ShaderFileWatcher::ReportChanges()
+{
+	std::vector<std::string> changedFiles;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto it = m_pendingChanges.begin(); it != m_pendingChanges.end(); )
+		{
+			if (now - it->second >= g_QuietPeriod)
+			{
+				changedFiles.push_back(it->first);
+				it = m_pendingChanges.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < changedFiles.size(); i++)
+	{
+		if (m_callback)
+		{
+			m_callback(changedFiles[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  GetDirectory()
+ *
+ *  This method is used for getting the directory part of a
+ *  path, including the trailing slash, so that joining it
+ *  with a file name gives back the same path string.
+ ***********************************************************/
+std::string ShaderFileWatcher::GetDirectory(const std::string& path)
+{
+	size_t slashPos = path.find_last_of("/\\");
+	if (slashPos == std::string::npos)
+	{
+		return(std::string());
+	}
+
+	return(path.substr(0, slashPos + 1));
+}
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderfilewatcher.h
+// ============
+// watch shader source files for changes on a background thread
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <filesystem>
+
+/***********************************************************
+ *  ShaderFileWatcher
+ *
+ *  This class runs a thread that watches a list of files and
+ *  calls back, on that thread, once a file has been written.
+ *  On Linux the directories of the files are watched with
+ *  inotify, elsewhere the file times are polled.  Editors
+ *  often write a file in several steps, so a change is only
+ *  reported after the file has been quiet for a moment.
+ ***********************************************************/
+class ShaderFileWatcher
+{
+public:
+	// called on the watcher thread with the path of a changed file
+	typedef std::function<void(const std::string&)> ChangeCallback;
+
+	// constructor
+	ShaderFileWatcher();
+	// destructor
+	~ShaderFileWatcher();
+
+	// start the watcher thread
+	bool Start(ChangeCallback callback);
+	// stop the watcher thread and wait for it to exit
+	void Stop();
+	// add a file to the watch list - may be called from any thread
+	void WatchFile(const std::string& path);
+
+	// check whether the watcher thread is running
+	inline bool IsRunning() const
+	{
+		return(m_thread.joinable());
+	}
+
+private:
+	// properties for a watched file
+	struct WATCHED_FILE
+	{
+		// write time seen by the last poll
+		std::filesystem::file_time_type writeTime;
+		// whether the write time could be read
+		bool bExists;
+	};
+
+	// the watcher thread
+	std::thread m_thread;
+	// set when the thread should exit
+	std::atomic<bool> m_bStopRequested;
+	// guards the watch lists
+	std::mutex m_mutex;
+	// the watched files, keyed by path
+	std::unordered_map<std::string, WATCHED_FILE> m_files;
+	// changed files waiting for the quiet period to pass
+	std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_pendingChanges;
+	// the function called for each changed file
+	ChangeCallback m_callback;
+
+#ifdef __linux__
+	// the inotify instance, or -1 when polling
+	int m_inotifyFD;
+	// watched directories, keyed by watch descriptor
+	std::unordered_map<int, std::string> m_watchedDirectories;
+
+	// add an inotify watch for the directory of the file
+	void WatchDirectory(const std::string& path);
+	// read the pending inotify events without blocking
+	void ReadNotifyEvents();
+#endif
+
+	// the main loop of the watcher thread
+	void WatchThread();
+	// compare the write times of the watched files
+	void PollFiles();
+	// report the changes that have been quiet long enough
+	void ReportChanges();
+	// get the directory part of a path, with the trailing slash
+	static std::string GetDirectory(const std::string& path);
+};
@@ -1,119 +1,1805 @@
-#include <stdio.h>
-#include <string>
-#include <vector>
-#include <iostream>
-#include <fstream>
-#include <algorithm>
-#include <sstream>
-using namespace std;
-
-#include <stdlib.h>
-#include <string.h>
-
-#include <GL/glew.h>
-
-#include "ShaderManager.h"
-
-/***********************************************************
- *  LoadShaders()
- *
- *  This method is called to load the shader data from 
- *  external GLSL compatible files.
- ***********************************************************/
-GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
-
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-	// Read the Vertex Shader code from the file
-	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if(VertexShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << VertexShaderStream.rdbuf();
-		VertexShaderCode = sstr.str();
-		VertexShaderStream.close();
-	}else{
-		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
-		getchar();
-		return 0;
-	}
-
-	// Read the Fragment Shader code from the file
-	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if(FragmentShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << FragmentShaderStream.rdbuf();
-		FragmentShaderCode = sstr.str();
-		FragmentShaderStream.close();
-	}
-
-	GLint Result = GL_FALSE;
-	int InfoLogLength;
-
-
-	// Compile Vertex Shader
-	printf("Compiling shader : %s...", vertex_file_path);
-	char const * VertexSourcePointer = VertexShaderCode.c_str();
-	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
-	glCompileShader(VertexShaderID);
-
-	// Check Vertex Shader
-	glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
-		printf("\n%s\n", &VertexShaderErrorMessage[0]);
-	}
-
-	printf("success\n");
-
-	// Compile Fragment Shader
-	printf("Compiling shader : %s...", fragment_file_path);
-	char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
-	glCompileShader(FragmentShaderID);
-
-	// Check Fragment Shader
-	glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
-		printf("\n%s\n", &FragmentShaderErrorMessage[0]);
-	}
-
-	printf("success\n");
-
-	// Link the program
-	printf("Linking shader program...");
-	GLuint ProgramID = glCreateProgram();
-	m_programID = ProgramID;
-	glAttachShader(ProgramID, VertexShaderID);
-	glAttachShader(ProgramID, FragmentShaderID);
-	glLinkProgram(ProgramID);
-
-	// Check the program
-	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 1 ){
-		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
-		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
-		printf("\n%s\n", &ProgramErrorMessage[0]);
-	}
-
-	printf("success\n");
-	
-	glDetachShader(ProgramID, VertexShaderID);
-	glDetachShader(ProgramID, FragmentShaderID);
-	
-	glDeleteShader(VertexShaderID);
-	glDeleteShader(FragmentShaderID);
-
-	return ProgramID;
-}
-
-
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <chrono>
+#include <filesystem>
+using namespace std;
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+
+#include "ShaderManager.h"
+
+// GL_KHR_parallel_shader_compile and GL_ARB_parallel_shader_compile
+// share this token, but older GLEW headers define neither
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace
+{
+	// identifies the files written into the program cache
+	const uint32_t g_ProgramBinaryMagic = 0x43425053; // "SPBC"
+	// FNV-1a 64-bit offset basis for the program cache key
+	const uint64_t g_FNV64OffsetBasis = 14695981039346656037ull;
+	// first word of every SPIR-V module
+	const uint32_t g_SpirvMagic = 0x07230203;
+	// the deepest that shader #include directives may nest
+	const int g_MaxIncludeDepth = 16;
+
+	// header written in front of each cached program binary
+	struct PROGRAM_BINARY_HEADER
+	{
+		uint32_t magic;
+		uint32_t binaryFormat;
+		uint64_t cacheKey;
+		uint32_t length;
+		uint32_t reserved;
+	};
+
+	/***********************************************************
+	 *  HashBytes64()
+	 *
+	 *  This function is used for continuing a 64-bit FNV-1a
+	 *  hash over the passed in bytes.
+	 ***********************************************************/
+	uint64_t HashBytes64(const char* data, size_t length, uint64_t hash)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (uint64_t)(unsigned char)data[i];
+			hash *= 1099511628211ull;
+		}
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  EnableParallelShaderCompile()
+	 *
+	 *  This function is used for letting the driver compile
+	 *  shaders on as many threads as it wants.  Returns false
+	 *  when the driver has no parallel shader compile support,
+	 *  in which case asking for the compile status blocks.
+	 ***********************************************************/
+	bool EnableParallelShaderCompile()
+	{
+#ifdef GL_KHR_parallel_shader_compile
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+			printf("Using GL_KHR_parallel_shader_compile\n");
+			return(true);
+		}
+#endif
+#ifdef GL_ARB_parallel_shader_compile
+		if (GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+			printf("Using GL_ARB_parallel_shader_compile\n");
+			return(true);
+		}
+#endif
+		printf("Parallel shader compile is not available, compiling one program per frame\n");
+		return(false);
+	}
+
+	/***********************************************************
+	 *  GetDefineBlock()
+	 *
+	 *  This function is used for turning a list of defines into
+	 *  the block of #define lines injected into the sources.
+	 ***********************************************************/
+	std::string GetDefineBlock(const ShaderManager::ShaderDefines& defines)
+	{
+		std::string defineBlock;
+		for (size_t i = 0; i < defines.size(); i++)
+		{
+			defineBlock += "#define " + defines[i].name + " " + defines[i].value + "\n";
+		}
+		return(defineBlock);
+	}
+
+	/***********************************************************
+	 *  GetDefinesSummary()
+	 *
+	 *  This function is used for turning a define block into a
+	 *  short single-line summary for the log.
+	 ***********************************************************/
+	std::string GetDefinesSummary(const std::string& defines)
+	{
+		std::string summary;
+		std::istringstream defineStream(defines);
+		std::string line;
+		while (std::getline(defineStream, line))
+		{
+			if (line.compare(0, 8, "#define ") == 0)
+			{
+				if (!summary.empty())
+				{
+					summary += ", ";
+				}
+				summary += line.substr(8);
+			}
+		}
+		return(summary.empty() ? std::string("base") : summary);
+	}
+
+	/***********************************************************
+	 *  GetFirstArrayIndex()
+	 *
+	 *  This function is used for getting the first array index
+	 *  in a uniform name, such as 2 for "lights[2].color", or 0
+	 *  when the name has no array index.
+	 ***********************************************************/
+	int GetFirstArrayIndex(const char* name)
+	{
+		const char* bracket = strchr(name, '[');
+		return((NULL != bracket) ? atoi(bracket + 1) : 0);
+	}
+
+	/***********************************************************
+	 *  GetUniformTypeName()
+	 *
+	 *  This function is used for getting the GLSL name of a
+	 *  uniform type for reporting type mismatches.
+	 ***********************************************************/
+	const char* GetUniformTypeName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_BOOL: return("bool");
+		case GL_INT: return("int");
+		case GL_FLOAT: return("float");
+		case GL_FLOAT_VEC2: return("vec2");
+		case GL_FLOAT_VEC3: return("vec3");
+		case GL_FLOAT_VEC4: return("vec4");
+		case GL_FLOAT_MAT2: return("mat2");
+		case GL_FLOAT_MAT3: return("mat3");
+		case GL_FLOAT_MAT4: return("mat4");
+		case GL_SAMPLER_2D: return("sampler2D");
+		default: return("unknown");
+		}
+	}
+}
+
+/***********************************************************
+ *  ShaderManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderManager::ShaderManager()
+{
+	m_programID = 0;
+	m_pActiveProgram = NULL;
+	m_pendingCompiles = 0;
+	m_bQueueDrainReported = true;
+	m_bCompilerThreadsSet = false;
+	m_bParallelCompile = false;
+	m_uniformCacheMisses = 0;
+	m_programCacheDirectory = "shadercache";
+	m_bUseSpirv = false;
+}
+
+/***********************************************************
+ *  ~ShaderManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderManager::~ShaderManager()
+{
+	// the watcher thread calls back into this object
+	if (m_pFileWatcher)
+	{
+		m_pFileWatcher->Stop();
+	}
+
+	// free the programs, so that short lived managers like the
+	// ones in the shader benchmark do not leak them
+	for (size_t i = 0; i < m_programs.size(); i++)
+	{
+		CancelCompile(*m_programs[i]);
+		if (m_programs[i]->programID != 0)
+		{
+			glDeleteProgram(m_programs[i]->programID);
+			m_programs[i]->programID = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  LoadShaders()
+ *
+ *  This method is called to load the shader data from 
+ *  external GLSL compatible files.  The files are loaded as
+ *  the base variant, with no defines, which becomes the
+ *  active program.  The base variant is compiled right away,
+ *  since it is the fallback that is drawn with while the
+ *  specialized variants are still compiling.
+ ***********************************************************/
+GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+
+	m_vertexPath = vertex_file_path;
+	m_fragmentPath = fragment_file_path;
+
+	int handle = LoadProgram(vertex_file_path, fragment_file_path, ShaderDefines(), true);
+	if ((handle < 0) || (m_programs[handle]->programID == 0))
+	{
+		printf("Impossible to load %s and %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path, fragment_file_path);
+		getchar();
+		return 0;
+	}
+
+	UseProgram(handle);
+
+	return m_programID;
+}
+
+/***********************************************************
+ *  LoadShaderVariant()
+ *
+ *  This method is used for queueing a variant of the shader
+ *  files that were passed to LoadShaders, specialized by the
+ *  passed in defines.  With SPIR-V shaders set, the variant
+ *  is specialized from the SPIR-V modules instead.  A variant that is already loaded is
+ *  not compiled again.  The variant can be drawn with once
+ *  PollCompileQueue() has seen its compile finish.
+ ***********************************************************/
+int ShaderManager::LoadShaderVariant(const ShaderDefines& defines)
+{
+	// the SPIR-V modules are preferred when they were set, and
+	// the GLSL files are used for anything they cannot provide
+	if (m_bUseSpirv)
+	{
+		int handle = LoadSpirvProgramEntry(defines);
+		if (handle >= 0)
+		{
+			return(handle);
+		}
+	}
+
+	return(LoadProgram(m_vertexPath.c_str(), m_fragmentPath.c_str(), defines, false));
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method is used for registering a program built from
+ *  the passed in shader files and defines, and returns its
+ *  handle.  Handles stay valid for the life of the manager,
+ *  and loading the same files with the same defines again
+ *  returns the existing handle.  A program with defines
+ *  falls back to the base program of the same files, if that
+ *  one was loaded, while it is still compiling.
+ ***********************************************************/
+int ShaderManager::LoadProgram(
+	const char* vertexPath,
+	const char* fragmentPath,
+	const ShaderDefines& defines,
+	bool bWaitForCompile)
+{
+	int handle = LoadProgramEntry(vertexPath, fragmentPath, GetDefineBlock(defines));
+	if ((handle >= 0) && (bWaitForCompile) && (m_programs[handle]->pendingProgramID != 0))
+	{
+		FinishCompile(*m_programs[handle]);
+	}
+
+	return(handle);
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for activating a loaded program, so
+ *  the coming draws and uniform writes use it.  A program
+ *  that is still compiling is replaced by its fallback.  The
+ *  state cache skips the bind when the program is already
+ *  current.  Returns the handle that was activated, or -1
+ *  when there is nothing ready to draw with.
+ ***********************************************************/
+int ShaderManager::UseProgram(int handle)
+{
+	if ((handle >= 0) && (handle < (int)m_programs.size()) &&
+		(m_programs[handle]->programID == 0))
+	{
+		handle = m_programs[handle]->fallback;
+	}
+	if ((handle < 0) || (handle >= (int)m_programs.size()) ||
+		(m_programs[handle]->programID == 0))
+	{
+		return(-1);
+	}
+
+	m_pActiveProgram = m_programs[handle].get();
+	m_programID = m_pActiveProgram->programID;
+	m_stateCache.UseProgram(m_programID);
+
+	return(handle);
+}
+
+/***********************************************************
+ *  IsProgramReady()
+ *
+ *  This method is used for checking whether a program has
+ *  been linked and can be drawn with.
+ ***********************************************************/
+bool ShaderManager::IsProgramReady(int handle) const
+{
+	return((handle >= 0) &&
+		(handle < (int)m_programs.size()) &&
+		(m_programs[handle]->programID != 0));
+}
+
+/***********************************************************
+ *  GetCurrentProgram()
+ *
+ *  This method is used for getting the handle of the active
+ *  program, or -1 before any program was activated.
+ ***********************************************************/
+int ShaderManager::GetCurrentProgram() const
+{
+	return((NULL != m_pActiveProgram) ? m_pActiveProgram->handle : -1);
+}
+
+/***********************************************************
+ *  GetProgramReflection()
+ *
+ *  This method is used for getting the active uniforms,
+ *  uniform blocks and vertex attributes of a linked program.
+ *  Returns NULL for a program that is not linked yet.
+ ***********************************************************/
+const ShaderManager::PROGRAM_REFLECTION* ShaderManager::GetProgramReflection(int handle) const
+{
+	if (IsProgramReady(handle) == false)
+	{
+		return(NULL);
+	}
+
+	return(&m_programs[handle]->reflection);
+}
+
+/***********************************************************
+ *  LoadProgramEntry()
+ *
+ *  This method is used for adding one program to the
+ *  registry.  A linked program binary from an earlier run is
+ *  restored from the program cache when the preprocessed
+ *  sources and the driver have not changed, otherwise the
+ *  compile is submitted to the driver without waiting.
+ ***********************************************************/
+int ShaderManager::LoadProgramEntry(
+	const std::string& vertexPath,
+	const std::string& fragmentPath,
+	const std::string& defines)
+{
+	std::string registryKey = vertexPath + "|" + fragmentPath + "|" + defines;
+	std::unordered_map<std::string, int>::iterator existing = m_programHandles.find(registryKey);
+	if (existing != m_programHandles.end())
+	{
+		return(existing->second);
+	}
+
+	// expand the includes and inject the defines into both shaders
+	std::string VertexShaderCode;
+	std::string FragmentShaderCode;
+	RELOAD_SOURCE source;
+	if ((PreprocessShader(vertexPath, defines, source.files, VertexShaderCode) == false) ||
+		(PreprocessShader(fragmentPath, defines, source.files, FragmentShaderCode) == false))
+	{
+		return(-1);
+	}
+
+	std::unique_ptr<SHADER_PROGRAM> program = NewProgram(vertexPath, fragmentPath, defines);
+
+	// programs with defines fall back to the base program of
+	// the same shader files while they compile
+	if (defines.empty() == false)
+	{
+		existing = m_programHandles.find(vertexPath + "|" + fragmentPath + "|");
+		if (existing != m_programHandles.end())
+		{
+			program->fallback = existing->second;
+		}
+	}
+
+	// try the program cache before compiling anything
+	uint64_t cacheKey = GetProgramCacheKey(VertexShaderCode, FragmentShaderCode, defines);
+	if (LoadCachedProgram(*program, cacheKey) == false)
+	{
+		SubmitCompile(*program, VertexShaderCode, FragmentShaderCode, cacheKey);
+	}
+
+	// the watcher thread rebuilds the sources from these when
+	// any of the files changes
+	source.vertexPath = vertexPath;
+	source.fragmentPath = fragmentPath;
+	source.defines = defines;
+
+	return(AddProgram(std::move(program), registryKey, source));
+}
+
+/***********************************************************
+ *  LoadSpirvProgramEntry()
+ *
+ *  This method is used for adding a program specialized from
+ *  the SPIR-V modules to the registry.  Each define is passed
+ *  as the specialization constant registered for its name, so
+ *  a variant with a define that has no constant cannot be
+ *  made from the modules and -1 is returned.
+ ***********************************************************/
+int ShaderManager::LoadSpirvProgramEntry(const ShaderDefines& defines)
+{
+	std::vector<GLuint> constantIDs;
+	std::vector<GLuint> constantValues;
+	for (size_t i = 0; i < defines.size(); i++)
+	{
+		size_t c = 0;
+		while ((c < m_spirvConstants.size()) && (defines[i].name != m_spirvConstants[c].define))
+		{
+			c++;
+		}
+		if (c == m_spirvConstants.size())
+		{
+			printf("SPIR-V shaders have no specialization constant for %s, using GLSL\n", defines[i].name.c_str());
+			return(-1);
+		}
+
+		constantIDs.push_back(m_spirvConstants[c].constantID);
+		constantValues.push_back((GLuint)strtoul(defines[i].value.c_str(), NULL, 10));
+	}
+
+	std::string defineBlock = GetDefineBlock(defines);
+	std::string registryKey = "spirv|" + m_spirvVertexPath + "|" + m_spirvFragmentPath + "|" + defineBlock;
+	std::unordered_map<std::string, int>::iterator existing = m_programHandles.find(registryKey);
+	if (existing != m_programHandles.end())
+	{
+		return(existing->second);
+	}
+
+	std::unique_ptr<SHADER_PROGRAM> program = NewProgram(m_spirvVertexPath, m_spirvFragmentPath, defineBlock);
+	program->bSpirv = true;
+
+	// the base GLSL program is drawn with while this one links
+	existing = m_programHandles.find(m_vertexPath + "|" + m_fragmentPath + "|");
+	if (existing != m_programHandles.end())
+	{
+		program->fallback = existing->second;
+	}
+
+	uint64_t cacheKey = GetProgramCacheKey(m_spirvVertexCode, m_spirvFragmentCode, defineBlock);
+	if (LoadCachedProgram(*program, cacheKey) == false)
+	{
+		SubmitSpirvCompile(*program, constantIDs, constantValues, cacheKey);
+	}
+
+	// the SPIR-V modules are not watched for hot reload
+	return(AddProgram(std::move(program), registryKey, RELOAD_SOURCE()));
+}
+
+/***********************************************************
+ *  NewProgram()
+ *
+ *  This method is used for creating a program entry that has
+ *  not been compiled yet.
+ ***********************************************************/
+std::unique_ptr<ShaderManager::SHADER_PROGRAM> ShaderManager::NewProgram(
+	const std::string& vertexPath,
+	const std::string& fragmentPath,
+	const std::string& defines) const
+{
+	std::unique_ptr<SHADER_PROGRAM> program(new SHADER_PROGRAM());
+	program->programID = 0;
+	program->handle = (int)m_programs.size();
+	program->fallback = -1;
+	program->bSpirv = false;
+	program->vertexPath = vertexPath;
+	program->fragmentPath = fragmentPath;
+	program->defines = defines;
+	program->cacheKey = 0;
+	program->generation = 0;
+	program->pendingProgramID = 0;
+	program->pendingVertexShaderID = 0;
+	program->pendingFragmentShaderID = 0;
+	program->pendingCacheKey = 0;
+	program->queueTime = std::chrono::steady_clock::now();
+
+	return(program);
+}
+
+/***********************************************************
+ *  LoadCachedProgram()
+ *
+ *  This method is used for installing a program from the
+ *  program cache.  Returns false on a cache miss.
+ ***********************************************************/
+bool ShaderManager::LoadCachedProgram(SHADER_PROGRAM& program, uint64_t cacheKey)
+{
+	GLuint ProgramID = LoadProgramBinary(cacheKey);
+	if (ProgramID == 0)
+	{
+		return(false);
+	}
+
+	InstallProgram(program, ProgramID, cacheKey);
+
+	double loadMs = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - program.queueTime).count();
+	printf("Shader program %d [%s]: program cache hit, loaded in %.2f ms\n",
+		program.handle,
+		GetDefinesSummary(program.defines).c_str(),
+		loadMs);
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddProgram()
+ *
+ *  This method is used for adding a new program entry to the
+ *  registry, and returns its handle.
+ ***********************************************************/
+int ShaderManager::AddProgram(
+	std::unique_ptr<SHADER_PROGRAM> program,
+	const std::string& registryKey,
+	const RELOAD_SOURCE& source)
+{
+	int handle = program->handle;
+	m_programs.push_back(std::move(program));
+	m_programHandles[registryKey] = handle;
+
+	if ((m_pFileWatcher) && (m_pFileWatcher->IsRunning()))
+	{
+		for (size_t i = 0; i < source.files.size(); i++)
+		{
+			m_pFileWatcher->WatchFile(source.files[i]);
+		}
+	}
+
+	// the reload sources are indexed by handle
+	std::lock_guard<std::mutex> lock(m_reloadMutex);
+	m_reloadSources.push_back(source);
+
+	return(handle);
+}
+
+/***********************************************************
+ *  SetSpirvShaders()
+ *
+ *  This method is used for switching the shader variants to
+ *  precompiled SPIR-V modules.  The variant defines that are
+ *  listed are passed to the modules as specialization
+ *  constants.  Returns false, and keeps using the GLSL files,
+ *  when the driver has no GL_ARB_gl_spirv or the modules
+ *  cannot be read.
+ ***********************************************************/
+bool ShaderManager::SetSpirvShaders(
+	const char* vertexPath,
+	const char* fragmentPath,
+	const SPECIALIZATION_CONSTANT_DESC* pConstants,
+	size_t count)
+{
+	m_bUseSpirv = false;
+
+	if (!GLEW_ARB_gl_spirv)
+	{
+		printf("GL_ARB_gl_spirv is not supported, using the GLSL shaders\n");
+		return(false);
+	}
+
+	if ((ReadSpirvModule(vertexPath, m_spirvVertexCode) == false) ||
+		(ReadSpirvModule(fragmentPath, m_spirvFragmentCode) == false))
+	{
+		printf("Using the GLSL shaders\n");
+		return(false);
+	}
+
+	m_spirvVertexPath = vertexPath;
+	m_spirvFragmentPath = fragmentPath;
+	m_spirvConstants.assign(pConstants, pConstants + count);
+	m_bUseSpirv = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadSpirvModule()
+ *
+ *  This method is used for reading a SPIR-V module and
+ *  checking its header.
+ ***********************************************************/
+bool ShaderManager::ReadSpirvModule(const std::string& path, std::string& code) const
+{
+	std::ifstream moduleStream(path, std::ios::in | std::ios::binary);
+	if (!moduleStream.is_open())
+	{
+		printf("Impossible to open %s. Run build_spirv to compile the SPIR-V shaders\n", path.c_str());
+		return(false);
+	}
+
+	code.assign(std::istreambuf_iterator<char>(moduleStream), std::istreambuf_iterator<char>());
+
+	uint32_t magic = 0;
+	if ((code.size() < 20) || (code.size() % 4 != 0))
+	{
+		printf("%s is not a SPIR-V module\n", path.c_str());
+		return(false);
+	}
+	memcpy(&magic, code.data(), sizeof(magic));
+	if (magic != g_SpirvMagic)
+	{
+		printf("%s is not a SPIR-V module\n", path.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  PollCompileQueue()
+ *
+ *  This method is used for finishing the programs whose
+ *  compile has completed, and is called once per frame.  With
+ *  parallel shader compile the driver is asked for completion
+ *  without blocking.  Without it there is no way to ask, so
+ *  one program is finished per call, which bounds the stall
+ *  in any frame to a single compile.  Returns the number of
+ *  programs still compiling.
+ ***********************************************************/
+int ShaderManager::PollCompileQueue()
+{
+	bool bFinishedOne = false;
+
+	// start compiling the programs whose files were changed
+	ProcessReloadRequests();
+
+	for (size_t i = 0; i < m_programs.size(); i++)
+	{
+		SHADER_PROGRAM& program = *m_programs[i];
+		if (program.pendingProgramID == 0)
+		{
+			continue;
+		}
+
+		bool bComplete = false;
+		if (m_bParallelCompile)
+		{
+			// this query never waits for the driver
+			GLint completionStatus = GL_FALSE;
+			glGetProgramiv(program.pendingProgramID, GL_COMPLETION_STATUS_KHR, &completionStatus);
+			bComplete = (completionStatus == GL_TRUE);
+		}
+		else
+		{
+			bComplete = (bFinishedOne == false);
+		}
+
+		if (bComplete)
+		{
+			FinishCompile(program);
+			bFinishedOne = true;
+		}
+	}
+
+	// once the queue drains, every program that was asked for
+	// is known, so the handles none of them use are reported
+	if ((m_pendingCompiles == 0) && (m_bQueueDrainReported == false))
+	{
+		double queueMs = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - m_compileQueueStart).count();
+		printf("All %d shader programs are ready after %.2f ms\n", (int)m_programs.size(), queueMs);
+		ReportInactiveUniforms();
+		m_bQueueDrainReported = true;
+	}
+
+	return(m_pendingCompiles);
+}
+
+/***********************************************************
+ *  PreprocessShader()
+ *
+ *  This method is used for preparing a shader file for
+ *  compiling.  The #include directives are expanded and the
+ *  define block is injected right after the #version line.
+ *  The file and the files it includes are appended to the
+ *  included files list.  Only files are read here, so this
+ *  can run on the watcher thread.
+ ***********************************************************/
+bool ShaderManager::PreprocessShader(
+	const std::string& path,
+	const std::string& defines,
+	std::vector<std::string>& includedFiles,
+	std::string& output) const
+{
+	std::vector<std::string> shaderFiles;
+
+	output.clear();
+	bool bSuccess = ExpandShaderIncludes(path, defines, shaderFiles, 0, output);
+
+	for (size_t i = 0; i < shaderFiles.size(); i++)
+	{
+		if (std::find(includedFiles.begin(), includedFiles.end(), shaderFiles[i]) == includedFiles.end())
+		{
+			includedFiles.push_back(shaderFiles[i]);
+		}
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  ExpandShaderIncludes()
+ *
+ *  This method is used for appending a shader file to the
+ *  preprocessor output.  An #include "file" line is replaced
+ *  by the contents of that file, found relative to the file
+ *  that includes it.  Each file is only included once, and
+ *  #line directives keep the compiler messages pointing at
+ *  the right file and line.
+ ***********************************************************/
+bool ShaderManager::ExpandShaderIncludes(
+	const std::string& path,
+	const std::string& defines,
+	std::vector<std::string>& includedFiles,
+	int depth,
+	std::string& output) const
+{
+	if (depth > g_MaxIncludeDepth)
+	{
+		printf("Shader includes are nested too deeply at %s\n", path.c_str());
+		return(false);
+	}
+
+	std::ifstream shaderStream(path, std::ios::in);
+	if (!shaderStream.is_open())
+	{
+		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", path.c_str());
+		return(false);
+	}
+
+	// the index of the file is used as the #line source number
+	int fileIndex = (int)includedFiles.size();
+	includedFiles.push_back(path);
+
+	std::string directory;
+	size_t slashPos = path.find_last_of("/\\");
+	if (slashPos != std::string::npos)
+	{
+		directory = path.substr(0, slashPos + 1);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(shaderStream, line))
+	{
+		lineNumber++;
+		if ((!line.empty()) && (line[line.length() - 1] == '\r'))
+		{
+			line.erase(line.length() - 1);
+		}
+
+		size_t first = line.find_first_not_of(" \t");
+		if ((first != std::string::npos) && (line.compare(first, 8, "#version") == 0))
+		{
+			output += line + "\n";
+			if (depth == 0)
+			{
+				output += defines;
+			}
+			output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+		}
+		else if ((first != std::string::npos) && (line.compare(first, 8, "#include") == 0))
+		{
+			size_t open = line.find('"', first);
+			size_t close = (open != std::string::npos) ? line.find('"', open + 1) : std::string::npos;
+			if (close == std::string::npos)
+			{
+				printf("%s(%d): malformed #include\n", path.c_str(), lineNumber);
+				return(false);
+			}
+
+			std::string includePath = directory + line.substr(open + 1, close - open - 1);
+			if (std::find(includedFiles.begin(), includedFiles.end(), includePath) == includedFiles.end())
+			{
+				if (ExpandShaderIncludes(includePath, defines, includedFiles, depth + 1, output) == false)
+				{
+					return(false);
+				}
+			}
+			output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+		}
+		else
+		{
+			output += line + "\n";
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SubmitCompile()
+ *
+ *  This method is used for handing the vertex and fragment
+ *  shader source code to the driver and starting the link.
+ *  Nothing here asks for the compile or link status, since
+ *  that would wait for the driver to finish - the result is
+ *  collected later by FinishCompile().
+ ***********************************************************/
+void ShaderManager::SubmitCompile(
+	SHADER_PROGRAM& program,
+	const std::string& VertexShaderCode,
+	const std::string& FragmentShaderCode,
+	uint64_t cacheKey)
+{
+	PrepareCompileQueue(program);
+
+	// Create the shaders
+	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+
+	// Compile Vertex Shader
+	char const * VertexSourcePointer = VertexShaderCode.c_str();
+	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
+	glCompileShader(VertexShaderID);
+
+	// Compile Fragment Shader
+	char const * FragmentSourcePointer = FragmentShaderCode.c_str();
+	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
+	glCompileShader(FragmentShaderID);
+
+	SubmitLink(program, VertexShaderID, FragmentShaderID, cacheKey);
+}
+
+/***********************************************************
+ *  PrepareCompileQueue()
+ *
+ *  This method is used for counting a new compile on the
+ *  queue, and starts the compile time of the program.  The
+ *  first compile also sets up the driver's compiler threads,
+ *  before any shader is compiled.
+ ***********************************************************/
+void ShaderManager::PrepareCompileQueue(SHADER_PROGRAM& program)
+{
+	// let the driver use as many compiler threads as it likes
+	if (m_bCompilerThreadsSet == false)
+	{
+		m_bParallelCompile = EnableParallelShaderCompile();
+		m_bCompilerThreadsSet = true;
+	}
+
+	if (m_bQueueDrainReported == true)
+	{
+		m_compileQueueStart = std::chrono::steady_clock::now();
+		m_bQueueDrainReported = false;
+	}
+	m_pendingCompiles++;
+	program.queueTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  SubmitSpirvCompile()
+ *
+ *  This method is used for handing the SPIR-V modules to the
+ *  driver and specializing them with the passed in constants.
+ *  Specializing replaces the GLSL parse and compile, which is
+ *  where most of the startup time of the GLSL path goes.
+ ***********************************************************/
+void ShaderManager::SubmitSpirvCompile(
+	SHADER_PROGRAM& program,
+	const std::vector<GLuint>& constantIDs,
+	const std::vector<GLuint>& constantValues,
+	uint64_t cacheKey)
+{
+	PrepareCompileQueue(program);
+
+	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+	GLuint constantCount = (GLuint)constantIDs.size();
+	const GLuint* pConstantIDs = constantIDs.empty() ? NULL : &constantIDs[0];
+	const GLuint* pConstantValues = constantValues.empty() ? NULL : &constantValues[0];
+
+	glShaderBinary(1, &VertexShaderID, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB,
+		m_spirvVertexCode.data(), (GLsizei)m_spirvVertexCode.size());
+	glSpecializeShaderARB(VertexShaderID, "main", constantCount, pConstantIDs, pConstantValues);
+
+	glShaderBinary(1, &FragmentShaderID, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB,
+		m_spirvFragmentCode.data(), (GLsizei)m_spirvFragmentCode.size());
+	glSpecializeShaderARB(FragmentShaderID, "main", constantCount, pConstantIDs, pConstantValues);
+
+	SubmitLink(program, VertexShaderID, FragmentShaderID, cacheKey);
+}
+
+/***********************************************************
+ *  SubmitLink()
+ *
+ *  This method is used for linking the compiled shaders into
+ *  a program without waiting for the result, and putting the
+ *  program on the compile queue.
+ ***********************************************************/
+void ShaderManager::SubmitLink(
+	SHADER_PROGRAM& program,
+	GLuint VertexShaderID,
+	GLuint FragmentShaderID,
+	uint64_t cacheKey)
+{
+	// Link the program
+	GLuint ProgramID = glCreateProgram();
+	glAttachShader(ProgramID, VertexShaderID);
+	glAttachShader(ProgramID, FragmentShaderID);
+	// ask the driver to keep the binary so it can be cached
+	glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(ProgramID);
+
+	program.pendingProgramID = ProgramID;
+	program.pendingVertexShaderID = VertexShaderID;
+	program.pendingFragmentShaderID = FragmentShaderID;
+	program.pendingCacheKey = cacheKey;
+
+	printf("Queued shader program %d [%s] for compiling%s\n",
+		program.handle,
+		GetDefinesSummary(program.defines).c_str(),
+		program.bSpirv ? " from SPIR-V" : "");
+}
+
+/***********************************************************
+ *  FinishCompile()
+ *
+ *  This method is used for collecting the result of a
+ *  submitted compile.  The compile and link logs are printed,
+ *  and a program that linked becomes the live program of the
+ *  handle.  A program that failed is deleted and the handle
+ *  keeps whatever program it had before.
+ ***********************************************************/
+bool ShaderManager::FinishCompile(SHADER_PROGRAM& program)
+{
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	GLuint ProgramID = program.pendingProgramID;
+	GLuint VertexShaderID = program.pendingVertexShaderID;
+	GLuint FragmentShaderID = program.pendingFragmentShaderID;
+
+	program.pendingProgramID = 0;
+	program.pendingVertexShaderID = 0;
+	program.pendingFragmentShaderID = 0;
+	m_pendingCompiles--;
+
+	// Check Vertex Shader
+	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
+		printf("%s:\n%s\n", program.vertexPath.c_str(), &VertexShaderErrorMessage[0]);
+	}
+
+	// Check Fragment Shader
+	glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
+		printf("%s:\n%s\n", program.fragmentPath.c_str(), &FragmentShaderErrorMessage[0]);
+	}
+
+	// Check the program
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
+		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		printf("%s\n", &ProgramErrorMessage[0]);
+	}
+
+	glDetachShader(ProgramID, VertexShaderID);
+	glDetachShader(ProgramID, FragmentShaderID);
+	
+	glDeleteShader(VertexShaderID);
+	glDeleteShader(FragmentShaderID);
+
+	double compileMs = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - program.queueTime).count();
+
+	// a program that failed to link is of no use to anyone
+	if (Result != GL_TRUE)
+	{
+		printf("Shader program %d [%s]: failed to link\n",
+			program.handle,
+			GetDefinesSummary(program.defines).c_str());
+		glDeleteProgram(ProgramID);
+		return(false);
+	}
+
+	SaveProgramBinary(ProgramID, program.pendingCacheKey);
+	InstallProgram(program, ProgramID, program.pendingCacheKey);
+
+	printf("Shader program %d [%s]: program cache miss, compiled in %.2f ms\n",
+		program.handle,
+		GetDefinesSummary(program.defines).c_str(),
+		compileMs);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CancelCompile()
+ *
+ *  This method is used for throwing away a compile that was
+ *  submitted but not finished, when newer sources replace it.
+ ***********************************************************/
+void ShaderManager::CancelCompile(SHADER_PROGRAM& program)
+{
+	if (program.pendingProgramID == 0)
+	{
+		return;
+	}
+
+	glDeleteShader(program.pendingVertexShaderID);
+	glDeleteShader(program.pendingFragmentShaderID);
+	glDeleteProgram(program.pendingProgramID);
+
+	program.pendingProgramID = 0;
+	program.pendingVertexShaderID = 0;
+	program.pendingFragmentShaderID = 0;
+	m_pendingCompiles--;
+}
+
+/***********************************************************
+ *  InstallProgram()
+ *
+ *  This method is used for making a linked program the live
+ *  program of its handle.  The swap happens between two draw
+ *  calls on the GL thread, so no draw ever sees a half
+ *  replaced program.  The older program, if any, is deleted.
+ ***********************************************************/
+void ShaderManager::InstallProgram(SHADER_PROGRAM& program, GLuint programID, uint64_t cacheKey)
+{
+	// the handle may be replacing an older program
+	if (program.programID != 0)
+	{
+		glDeleteProgram(program.programID);
+	}
+	program.programID = programID;
+	program.cacheKey = cacheKey;
+	program.generation++;
+
+	// look up the uniform locations once, right after linking,
+	// and report any registered uniform handles that do not match
+	ReflectProgram(program);
+	ValidateExpectedUniforms(program);
+
+	// the active program may have been the one replaced
+	if (m_pActiveProgram == &program)
+	{
+		m_programID = programID;
+		m_stateCache.UseProgram(m_programID);
+	}
+}
+
+/***********************************************************
+ *  GetProgramGeneration()
+ *
+ *  This method is used for getting the number of times the
+ *  program of a handle was linked.  A program that is not
+ *  linked yet has generation 0.
+ ***********************************************************/
+unsigned int ShaderManager::GetProgramGeneration(int handle) const
+{
+	if ((handle < 0) || (handle >= (int)m_programs.size()))
+	{
+		return(0);
+	}
+
+	return(m_programs[handle]->generation);
+}
+
+/***********************************************************
+ *  EnableHotReload()
+ *
+ *  This method is used for starting the shader file watcher.
+ *  The files of every registered program, and the files they
+ *  include, are watched, as are those of programs registered
+ *  later.  When one of them changes, the affected programs
+ *  are recompiled without stopping the app.
+ ***********************************************************/
+bool ShaderManager::EnableHotReload()
+{
+	if (!m_pFileWatcher)
+	{
+		m_pFileWatcher.reset(new ShaderFileWatcher());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_reloadMutex);
+		for (size_t i = 0; i < m_reloadSources.size(); i++)
+		{
+			for (size_t f = 0; f < m_reloadSources[i].files.size(); f++)
+			{
+				m_pFileWatcher->WatchFile(m_reloadSources[i].files[f]);
+			}
+		}
+	}
+
+	bool bStarted = m_pFileWatcher->Start(
+		[this](const std::string& path)
+		{
+			OnShaderFileChanged(path);
+		});
+	if (bStarted)
+	{
+		printf("Shader hot reload is watching for changes\n");
+	}
+
+	return(bStarted);
+}
+
+/***********************************************************
+ *  OnShaderFileChanged()
+ *
+ *  This method is called on the watcher thread when a shader
+ *  file changes.  The sources of every program that uses the
+ *  file are rebuilt right here, so the GL thread only has to
+ *  hand them to the driver.  A program whose sources cannot
+ *  be read keeps running with its current program.
+ ***********************************************************/
+void ShaderManager::OnShaderFileChanged(const std::string& path)
+{
+	std::vector<int> handles;
+	std::vector<RELOAD_SOURCE> sources;
+
+	printf("Shader file changed: %s\n", path.c_str());
+
+	{
+		std::lock_guard<std::mutex> lock(m_reloadMutex);
+		for (size_t i = 0; i < m_reloadSources.size(); i++)
+		{
+			const std::vector<std::string>& files = m_reloadSources[i].files;
+			if (std::find(files.begin(), files.end(), path) != files.end())
+			{
+				handles.push_back((int)i);
+				sources.push_back(m_reloadSources[i]);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		RELOAD_REQUEST request;
+		std::vector<std::string> files;
+
+		request.handle = handles[i];
+		if ((PreprocessShader(sources[i].vertexPath, sources[i].defines, files, request.vertexCode) == false) ||
+			(PreprocessShader(sources[i].fragmentPath, sources[i].defines, files, request.fragmentCode) == false))
+		{
+			printf("Shader program %d: could not read the sources, keeping the current program\n", request.handle);
+			continue;
+		}
+
+		// an edit may have added includes, which are watched too
+		for (size_t f = 0; f < files.size(); f++)
+		{
+			m_pFileWatcher->WatchFile(files[f]);
+		}
+
+		std::lock_guard<std::mutex> lock(m_reloadMutex);
+		m_reloadSources[request.handle].files = files;
+
+		// a newer edit replaces a request that was not taken yet
+		bool bReplaced = false;
+		for (size_t r = 0; r < m_reloadRequests.size(); r++)
+		{
+			if (m_reloadRequests[r].handle == request.handle)
+			{
+				m_reloadRequests[r] = request;
+				bReplaced = true;
+			}
+		}
+		if (bReplaced == false)
+		{
+			m_reloadRequests.push_back(request);
+		}
+	}
+}
+
+/***********************************************************
+ *  ProcessReloadRequests()
+ *
+ *  This method is used for taking the sources rebuilt by the
+ *  watcher thread and starting their compile, and is called
+ *  from PollCompileQueue() on the GL thread.  The compile
+ *  does not block; the new program replaces the old one once
+ *  it links, and a program that fails leaves the old one in
+ *  place.  Sources that match a cached binary are swapped in
+ *  right away.
+ ***********************************************************/
+void ShaderManager::ProcessReloadRequests()
+{
+	std::vector<RELOAD_REQUEST> requests;
+	{
+		std::lock_guard<std::mutex> lock(m_reloadMutex);
+		requests.swap(m_reloadRequests);
+	}
+
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		SHADER_PROGRAM& program = *m_programs[requests[i].handle];
+
+		uint64_t cacheKey = GetProgramCacheKey(requests[i].vertexCode, requests[i].fragmentCode, program.defines);
+		if ((program.programID != 0) && (program.pendingProgramID == 0) && (cacheKey == program.cacheKey))
+		{
+			// the file was saved without changing what this program uses
+			continue;
+		}
+
+		// the newer sources replace a compile that is still running
+		CancelCompile(program);
+
+		GLuint ProgramID = LoadProgramBinary(cacheKey);
+		if (ProgramID != 0)
+		{
+			InstallProgram(program, ProgramID, cacheKey);
+			printf("Shader program %d [%s]: reloaded from the program cache\n",
+				program.handle,
+				GetDefinesSummary(program.defines).c_str());
+		}
+		else
+		{
+			SubmitCompile(program, requests[i].vertexCode, requests[i].fragmentCode, cacheKey);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetProgramCacheDirectory()
+ *
+ *  This method is used for setting the directory where the
+ *  linked program binaries are cached.  An empty path turns
+ *  the program cache off.
+ ***********************************************************/
+void ShaderManager::SetProgramCacheDirectory(const std::string& directory)
+{
+	m_programCacheDirectory = directory;
+}
+
+/***********************************************************
+ *  GetProgramCacheKey()
+ *
+ *  This method is used for building the program cache key.
+ *  The key covers the shader sources, the preprocessor
+ *  defines and the driver strings, so a driver update or a
+ *  source edit never restores a stale binary.
+ ***********************************************************/
+uint64_t ShaderManager::GetProgramCacheKey(
+	const std::string& vertexCode,
+	const std::string& fragmentCode,
+	const std::string& defines) const
+{
+	uint64_t hash = HashBytes64(vertexCode.data(), vertexCode.size(), g_FNV64OffsetBasis);
+	hash = HashBytes64(fragmentCode.data(), fragmentCode.size(), hash);
+	hash = HashBytes64(defines.data(), defines.size(), hash);
+
+	const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (size_t i = 0; i < sizeof(driverStrings) / sizeof(driverStrings[0]); i++)
+	{
+		const char* value = (const char*)glGetString(driverStrings[i]);
+		if (NULL != value)
+		{
+			hash = HashBytes64(value, strlen(value), hash);
+		}
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  GetProgramCachePath()
+ *
+ *  This method is used for getting the file path of the
+ *  cached program binary for the passed in cache key.
+ ***********************************************************/
+std::string ShaderManager::GetProgramCachePath(uint64_t cacheKey) const
+{
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.bin", (unsigned long long)cacheKey);
+	return((std::filesystem::path(m_programCacheDirectory) / fileName).string());
+}
+
+/***********************************************************
+ *  LoadProgramBinary()
+ *
+ *  This method is used for restoring a linked program from
+ *  the program cache.  Returns 0 when there is no cached
+ *  binary, or when the driver rejects it, in which case the
+ *  caller falls back to compiling the sources.
+ ***********************************************************/
+GLuint ShaderManager::LoadProgramBinary(uint64_t cacheKey)
+{
+	if (m_programCacheDirectory.empty())
+	{
+		return(0);
+	}
+
+	std::string cachePath = GetProgramCachePath(cacheKey);
+	std::ifstream cacheStream(cachePath, std::ios::in | std::ios::binary);
+	if (!cacheStream.is_open())
+	{
+		return(0);
+	}
+
+	PROGRAM_BINARY_HEADER header;
+	cacheStream.read((char*)&header, sizeof(header));
+	if ((!cacheStream) ||
+		(header.magic != g_ProgramBinaryMagic) ||
+		(header.cacheKey != cacheKey) ||
+		(header.length == 0))
+	{
+		printf("Ignoring invalid program cache file %s\n", cachePath.c_str());
+		return(0);
+	}
+
+	std::vector<char> binary(header.length);
+	cacheStream.read(&binary[0], header.length);
+	if (!cacheStream)
+	{
+		printf("Ignoring truncated program cache file %s\n", cachePath.c_str());
+		return(0);
+	}
+
+	GLuint ProgramID = glCreateProgram();
+	glProgramBinary(ProgramID, header.binaryFormat, &binary[0], header.length);
+
+	GLint Result = GL_FALSE;
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	if (Result != GL_TRUE)
+	{
+		// the driver can reject a binary even when the key
+		// matches, so the stale file is removed and rebuilt
+		printf("Driver rejected cached program %s, recompiling\n", cachePath.c_str());
+		glDeleteProgram(ProgramID);
+		cacheStream.close();
+		std::error_code error;
+		std::filesystem::remove(cachePath, error);
+		return(0);
+	}
+
+	return(ProgramID);
+}
+
+/***********************************************************
+ *  SaveProgramBinary()
+ *
+ *  This method is used for writing the binary of a linked
+ *  program into the program cache.
+ ***********************************************************/
+bool ShaderManager::SaveProgramBinary(GLuint programID, uint64_t cacheKey)
+{
+	GLint Result = GL_FALSE;
+	GLint binaryLength = 0;
+	GLint formatCount = 0;
+
+	if ((m_programCacheDirectory.empty()) || (programID == 0))
+	{
+		return(false);
+	}
+
+	// drivers without any binary formats cannot cache programs
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	glGetProgramiv(programID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if ((formatCount <= 0) || (Result != GL_TRUE) || (binaryLength <= 0))
+	{
+		return(false);
+	}
+
+	std::vector<char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	GLsizei writtenLength = 0;
+	glGetProgramBinary(programID, binaryLength, &writtenLength, &binaryFormat, &binary[0]);
+	if (writtenLength <= 0)
+	{
+		return(false);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_programCacheDirectory, error);
+
+	std::string cachePath = GetProgramCachePath(cacheKey);
+	std::ofstream cacheStream(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!cacheStream.is_open())
+	{
+		printf("Could not write program cache file %s\n", cachePath.c_str());
+		return(false);
+	}
+
+	PROGRAM_BINARY_HEADER header;
+	header.magic = g_ProgramBinaryMagic;
+	header.binaryFormat = binaryFormat;
+	header.cacheKey = cacheKey;
+	header.length = (uint32_t)writtenLength;
+	cacheStream.write((const char*)&header, sizeof(header));
+	cacheStream.write(&binary[0], writtenLength);
+
+	return(cacheStream.good());
+}
+
+/***********************************************************
+ *  RegisterUniforms()
+ *
+ *  This method is used for registering the uniform handles
+ *  that the application uses, so they can be checked against
+ *  the active uniforms every time a program is linked.
+ ***********************************************************/
+void ShaderManager::RegisterUniforms(const UNIFORM_DESC* pUniforms, size_t count)
+{
+	m_expectedUniforms.insert(m_expectedUniforms.end(), pUniforms, pUniforms + count);
+}
+
+/***********************************************************
+ *  ReflectProgram()
+ *
+ *  This method is used for listing the active uniforms,
+ *  uniform blocks and vertex attributes of the linked
+ *  program.  The uniform locations are stored keyed by the
+ *  hash of the uniform name, so the uniform setters do not
+ *  need to query the driver by name.
+ ***********************************************************/
+void ShaderManager::ReflectProgram(SHADER_PROGRAM& program) const
+{
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+
+	// the values of the old program do not carry over
+	program.uniformLocations.clear();
+	program.uniformValues.clear();
+	program.reflection.uniforms.clear();
+	program.reflection.uniformBlocks.clear();
+	program.reflection.attributes.clear();
+
+	ReflectProgramInterfaces(program);
+
+	// SPIR-V programs do not have to carry uniform names
+	if (program.bSpirv)
+	{
+		ReflectSpirvUniforms(program);
+		return;
+	}
+
+	glGetProgramiv(program.programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program.programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	if ((uniformCount <= 0) || (maxNameLength <= 0))
+	{
+		return;
+	}
+
+	std::vector<GLchar> nameBuffer(maxNameLength + 1);
+	// the names are only kept while building, to detect hash collisions
+	std::unordered_map<uint32_t, std::string> cachedNames;
+	program.uniformLocations.reserve(uniformCount * 2);
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum uniformType = 0;
+
+		glGetActiveUniform(program.programID, i, maxNameLength, &nameLength, &arraySize, &uniformType, &nameBuffer[0]);
+		std::string uniformName(&nameBuffer[0], nameLength);
+
+		// uniforms inside of uniform blocks have no location
+		GLint location = glGetUniformLocation(program.programID, uniformName.c_str());
+		program.reflection.uniforms.push_back({ uniformName, location, uniformType, arraySize });
+		if (location < 0)
+		{
+			continue;
+		}
+
+		std::vector<std::string> names;
+		names.push_back(uniformName);
+
+		// arrays of basic types are reported as "name[0]", so the
+		// bare name and every other element are registered as well
+		size_t arrayPos = uniformName.rfind("[0]");
+		if ((arrayPos != std::string::npos) && (arrayPos + 3 == uniformName.length()))
+		{
+			std::string baseName = uniformName.substr(0, arrayPos);
+			names.push_back(baseName);
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				names.push_back(baseName + "[" + std::to_string(element) + "]");
+			}
+		}
+
+		for (size_t n = 0; n < names.size(); n++)
+		{
+			uint32_t hash = HashUniformName(names[n].c_str());
+			std::unordered_map<uint32_t, std::string>::iterator collision = cachedNames.find(hash);
+			if ((collision != cachedNames.end()) && (collision->second != names[n]))
+			{
+				printf("ERROR: uniform names %s and %s have the same hash\n", collision->second.c_str(), names[n].c_str());
+				continue;
+			}
+			cachedNames[hash] = names[n];
+
+			UNIFORM_INFO info;
+			info.location = (n == 0) ? location : glGetUniformLocation(program.programID, names[n].c_str());
+			info.type = uniformType;
+			info.pValue = GetUniformValue(program, info.location);
+			program.uniformLocations[hash] = info;
+		}
+	}
+
+	printf("Cached %d uniform locations\n", (int)program.uniformLocations.size());
+}
+
+/***********************************************************
+ *  ReflectSpirvUniforms()
+ *
+ *  This method is used for filling the uniform location cache
+ *  of a SPIR-V program.  The driver is not required to know
+ *  the uniform names of SPIR-V modules, so the active
+ *  uniforms are listed by location and matched against the
+ *  explicit locations of the registered uniform handles.
+ ***********************************************************/
+void ShaderManager::ReflectSpirvUniforms(SHADER_PROGRAM& program) const
+{
+	GLint uniformCount = 0;
+	std::unordered_map<GLint, GLenum> activeLocations;
+
+	glGetProgramInterfaceiv(program.programID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		const GLenum properties[] = { GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE };
+		GLint values[3] = { -1, 0, 0 };
+
+		glGetProgramResourceiv(program.programID, GL_UNIFORM, i, 3, properties, 3, NULL, values);
+		program.reflection.uniforms.push_back({ std::string(), values[0], (GLenum)values[1], values[2] });
+
+		// each element of an array of basic types has its own location
+		for (GLint element = 0; (values[0] >= 0) && (element < std::max(values[2], 1)); element++)
+		{
+			activeLocations[values[0] + element] = (GLenum)values[1];
+		}
+	}
+
+	for (size_t i = 0; i < m_expectedUniforms.size(); i++)
+	{
+		const UNIFORM_DESC& expected = m_expectedUniforms[i];
+		std::unordered_map<GLint, GLenum>::iterator active = activeLocations.find(expected.location);
+		if ((expected.location < 0) || (active == activeLocations.end()))
+		{
+			continue;
+		}
+
+		UNIFORM_INFO info;
+		info.location = expected.location;
+		info.type = active->second;
+		info.pValue = GetUniformValue(program, info.location);
+		program.uniformLocations[expected.hash] = info;
+	}
+
+	printf("Cached %d uniform locations\n", (int)program.uniformLocations.size());
+}
+
+/***********************************************************
+ *  ReflectProgramInterfaces()
+ *
+ *  This method is used for listing the uniform blocks and
+ *  the vertex attributes of the linked program.
+ ***********************************************************/
+void ShaderManager::ReflectProgramInterfaces(SHADER_PROGRAM& program) const
+{
+	GLint count = 0;
+	GLint maxNameLength = 0;
+	std::vector<GLchar> nameBuffer;
+
+	glGetProgramiv(program.programID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+	glGetProgramiv(program.programID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+	nameBuffer.resize(maxNameLength + 1);
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei nameLength = 0;
+		PROGRAM_REFLECTION::UNIFORM_BLOCK block;
+
+		glGetActiveUniformBlockName(program.programID, i, maxNameLength, &nameLength, &nameBuffer[0]);
+		block.name.assign(&nameBuffer[0], nameLength);
+		glGetActiveUniformBlockiv(program.programID, i, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+		glGetActiveUniformBlockiv(program.programID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+		program.reflection.uniformBlocks.push_back(block);
+	}
+
+	glGetProgramiv(program.programID, GL_ACTIVE_ATTRIBUTES, &count);
+	glGetProgramiv(program.programID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+	nameBuffer.resize(maxNameLength + 1);
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		PROGRAM_REFLECTION::ATTRIBUTE attribute;
+
+		glGetActiveAttrib(program.programID, i, maxNameLength, &nameLength, &arraySize, &attribute.type, &nameBuffer[0]);
+		attribute.name.assign(&nameBuffer[0], nameLength);
+		attribute.location = glGetAttribLocation(program.programID, attribute.name.c_str());
+		program.reflection.attributes.push_back(attribute);
+	}
+}
+
+/***********************************************************
+ *  ValidateExpectedUniforms()
+ *
+ *  This method is used for checking the registered uniform
+ *  handles against a linked program.  Handles whose type does
+ *  not match the GLSL declaration, or whose explicit location
+ *  does not match the layout qualifier, are reported.  A handle
+ *  that is not active is not an error here, since variants
+ *  compile out the uniforms they do not use - those are
+ *  reported by ReportInactiveUniforms().  Returns the number
+ *  of problems found.
+ ***********************************************************/
+int ShaderManager::ValidateExpectedUniforms(const SHADER_PROGRAM& program) const
+{
+	int problems = 0;
+
+	for (size_t i = 0; i < m_expectedUniforms.size(); i++)
+	{
+		const UNIFORM_DESC& expected = m_expectedUniforms[i];
+		auto it = program.uniformLocations.find(expected.hash);
+		if (it == program.uniformLocations.end())
+		{
+			continue;
+		}
+		else if (it->second.type != expected.glType)
+		{
+			printf("ERROR: uniform %s is declared as %s in the shader but is set as %s\n",
+				expected.name,
+				GetUniformTypeName(it->second.type),
+				GetUniformTypeName(expected.glType));
+			problems++;
+		}
+		else if ((expected.location >= 0) && (it->second.location != expected.location))
+		{
+			printf("ERROR: uniform %s is at location %d in the shader but its handle expects %d\n",
+				expected.name,
+				it->second.location,
+				expected.location);
+			problems++;
+		}
+	}
+
+	return(problems);
+}
+
+/***********************************************************
+ *  ReportInactiveUniforms()
+ *
+ *  This method is used for reporting the registered uniform
+ *  handles that are not active in any of the loaded shader
+ *  programs, which usually means a misspelled name or a
+ *  uniform that was removed from the shaders.
+ ***********************************************************/
+int ShaderManager::ReportInactiveUniforms() const
+{
+	int inactive = 0;
+
+	for (size_t i = 0; i < m_expectedUniforms.size(); i++)
+	{
+		// arrays are sized for what the scene uses, so elements
+		// past the first are allowed to be missing
+		if (GetFirstArrayIndex(m_expectedUniforms[i].name) > 0)
+		{
+			continue;
+		}
+
+		bool bFound = false;
+		for (size_t p = 0; (p < m_programs.size()) && (bFound == false); p++)
+		{
+			const SHADER_PROGRAM& program = *m_programs[p];
+			auto it = program.uniformLocations.find(m_expectedUniforms[i].hash);
+			bFound = ((it != program.uniformLocations.end()) && (it->second.location >= 0));
+		}
+
+		if (bFound == false)
+		{
+			printf("WARNING: uniform %s is not active in any shader program\n", m_expectedUniforms[i].name);
+			inactive++;
+		}
+	}
+
+	return(inactive);
+}
+
+/***********************************************************
+ *  GetUniformInfo()
+ *
+ *  This method is used for getting a uniform from the cache
+ *  by its name hash.  Names that were not found at link time
+ *  are queried once, counted as a miss, and remembered so the
+ *  driver is not asked again.
+ ***********************************************************/
+ShaderManager::UNIFORM_INFO* ShaderManager::GetUniformInfo(uint32_t hash, const char* name) const
+{
+	if (NULL == m_pActiveProgram)
+	{
+		return(NULL);
+	}
+
+	auto it = m_pActiveProgram->uniformLocations.find(hash);
+	if (it != m_pActiveProgram->uniformLocations.end())
+	{
+		return(&it->second);
+	}
+
+	m_uniformCacheMisses++;
+
+	UNIFORM_INFO info;
+	info.location = glGetUniformLocation(m_pActiveProgram->programID, name);
+	info.type = 0;
+	info.pValue = GetUniformValue(*m_pActiveProgram, info.location);
+
+	return(&(m_pActiveProgram->uniformLocations[hash] = info));
+}
+
+/***********************************************************
+ *  GetUniformValue()
+ *
+ *  This method is used for getting the value shadow of a
+ *  uniform location in the passed in program.  Inactive
+ *  uniforms have no shadow.
+ ***********************************************************/
+ShaderManager::UNIFORM_VALUE* ShaderManager::GetUniformValue(const SHADER_PROGRAM& program, GLint location) const
+{
+	if (location < 0)
+	{
+		return(NULL);
+	}
+
+	auto it = program.uniformValues.find(location);
+	if (it == program.uniformValues.end())
+	{
+		UNIFORM_VALUE value;
+		value.size = 0;
+		it = program.uniformValues.emplace(location, value).first;
+	}
+
+	return(&it->second);
+}
+
+/***********************************************************
+ *  UpdateUniformShadow()
+ *
+ *  This method is used for checking a uniform write against
+ *  the last value written to the same location.  The write
+ *  is skipped when the value is unchanged or the uniform is
+ *  not active, otherwise the shadow takes the new value.
+ *  Returns true when the write must be issued.
+ ***********************************************************/
+bool ShaderManager::UpdateUniformShadow(const UNIFORM_INFO* pInfo, const void* pValue, GLsizei size) const
+{
+	if ((NULL == pInfo) || (NULL == pInfo->pValue))
+	{
+		m_stateCache.CountCall(GLStateCache::CALL_UNIFORM, false);
+		return(false);
+	}
+
+	UNIFORM_VALUE* pShadow = pInfo->pValue;
+	if ((pShadow->size == size) && (memcmp(pShadow->data, pValue, size) == 0))
+	{
+		m_stateCache.CountCall(GLStateCache::CALL_UNIFORM, false);
+		return(false);
+	}
+
+	if (size <= (GLsizei)sizeof(pShadow->data))
+	{
+		memcpy(pShadow->data, pValue, size);
+		pShadow->size = size;
+	}
+	else
+	{
+		pShadow->size = 0;
+	}
+	m_stateCache.CountCall(GLStateCache::CALL_UNIFORM, true);
+
+	return(true);
+}
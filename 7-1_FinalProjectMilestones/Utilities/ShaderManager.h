@@ -1,103 +1,596 @@
-#pragma once
-
-#include <GL/glew.h>        // GLEW library
-
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include <string>
-#include <fstream>
-#include <sstream>
-#include <iostream>
-
-class ShaderManager
-{
-public:
-	unsigned int m_programID;
-	
-	GLuint LoadShaders(
-		const char* vertex_file_path, 
-		const char* fragment_file_path);
-
-	// activate the shader
-	// ------------------------------------------------------------------------
-	inline void use()
-	{
-		glUseProgram(m_programID);
-	}
-
-	// utility uniform functions
-	// ------------------------------------------------------------------------
-	inline void setBoolValue(const std::string &name, bool value) const
-	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setIntValue(const std::string &name, int value) const
-	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setFloatValue(const std::string &name, float value) const
-	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
-	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
-	}
-
-	inline void setVec2Value(const std::string &name, float x, float y) const
-	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
-	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
-	}
-	inline void setVec3Value(const std::string &name, float x, float y, float z) const
-	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
-	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
-	}
-	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
-	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
-	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
-	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
-	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
-	}
-
-	// ------------------------------------------------------------------------
-	inline void setSampler2DValue(const std::string& name, const int &value) const
-	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
-	}
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "UniformHandle.h"
+#include "GLStateCache.h"
+#include "ShaderFileWatcher.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+class ShaderManager
+{
+public:
+	// constructor
+	ShaderManager();
+	// destructor
+	~ShaderManager();
+
+	// name and value of a preprocessor define that is used
+	// for compiling a specialized shader variant
+	struct SHADER_DEFINE
+	{
+		std::string name;
+		std::string value;
+	};
+	typedef std::vector<SHADER_DEFINE> ShaderDefines;
+
+	// the interface of a linked program, as reported by the driver
+	struct PROGRAM_REFLECTION
+	{
+		struct UNIFORM
+		{
+			std::string name;
+			// -1 for members of uniform blocks
+			GLint location;
+			GLenum type;
+			GLint arraySize;
+		};
+		struct UNIFORM_BLOCK
+		{
+			std::string name;
+			GLint binding;
+			GLint dataSize;
+		};
+		struct ATTRIBUTE
+		{
+			std::string name;
+			GLint location;
+			GLenum type;
+		};
+
+		std::vector<UNIFORM> uniforms;
+		std::vector<UNIFORM_BLOCK> uniformBlocks;
+		std::vector<ATTRIBUTE> attributes;
+	};
+
+	unsigned int m_programID;
+	
+	// load the shader files as the base variant, with no defines
+	GLuint LoadShaders(
+		const char* vertex_file_path, 
+		const char* fragment_file_path);
+
+	// compile a specialized variant of the shader files that were
+	// passed to LoadShaders - returns the program handle, or -1
+	int LoadShaderVariant(const ShaderDefines& defines);
+	// register a program built from any pair of shader files -
+	// returns a handle that stays valid, or -1
+	int LoadProgram(
+		const char* vertexPath,
+		const char* fragmentPath,
+		const ShaderDefines& defines,
+		bool bWaitForCompile);
+	// activate a registered program for the coming draws -
+	// returns the handle used, which is the fallback program
+	// while the requested one is still compiling, or -1
+	int UseProgram(int handle);
+	// check whether a program is linked and can be drawn with
+	bool IsProgramReady(int handle) const;
+	// get the handle of the active program, or -1
+	int GetCurrentProgram() const;
+	// get the interface of a linked program, or NULL
+	const PROGRAM_REFLECTION* GetProgramReflection(int handle) const;
+	// finish the programs whose compile completed - called once
+	// per frame, returns the number of programs still compiling
+	int PollCompileQueue();
+	// get the number of registered programs
+	inline int GetProgramCount() const
+	{
+		return((int)m_programs.size());
+	}
+	// get the number of times a program was linked - the value
+	// changes whenever a reload replaces the program, which
+	// resets all of its uniforms
+	unsigned int GetProgramGeneration(int handle) const;
+
+	// watch the shader files of every program, and recompile
+	// the programs whose files change while the app is running
+	bool EnableHotReload();
+
+	// build the shader variants from precompiled SPIR-V modules,
+	// passing the listed defines as specialization constants -
+	// returns false and keeps the GLSL files when not supported
+	bool SetSpirvShaders(
+		const char* vertexPath,
+		const char* fragmentPath,
+		const SPECIALIZATION_CONSTANT_DESC* pConstants,
+		size_t count);
+	// check whether the variants are built from SPIR-V modules
+	inline bool IsSpirvEnabled() const
+	{
+		return(m_bUseSpirv);
+	}
+
+	// report registered uniforms that are not active in any of
+	// the loaded shader programs - returns the number reported
+	int ReportInactiveUniforms() const;
+
+	// set the directory for cached program binaries - an
+	// empty path turns the program cache off
+	void SetProgramCacheDirectory(const std::string& directory);
+
+	// register the uniform handles that are checked against
+	// the program every time it is linked
+	void RegisterUniforms(const UNIFORM_DESC* pUniforms, size_t count);
+
+	// get the number of uniform lookups that missed the location cache
+	inline unsigned int GetUniformCacheMisses() const
+	{
+		return(m_uniformCacheMisses);
+	}
+
+	// get the GL state cache that the program binds and the
+	// uniform writes go through
+	inline GLStateCache& GetStateCache()
+	{
+		return(m_stateCache);
+	}
+
+private:
+	// the last value written to a uniform location - a size
+	// of 0 means the value in the program is not known
+	struct UNIFORM_VALUE
+	{
+		GLsizei size;
+		unsigned char data[sizeof(glm::mat4)];
+	};
+
+	// properties for a cached uniform location
+	struct UNIFORM_INFO
+	{
+		GLint location;
+		GLenum type;
+		// shadow of the value at the location, or NULL when the
+		// uniform is not active
+		UNIFORM_VALUE* pValue;
+	};
+
+	// the uniform names are already hashed, so the hash
+	// value is used directly as the bucket index
+	struct UniformHashIdentity
+	{
+		size_t operator()(uint32_t hash) const { return(hash); }
+	};
+
+	// properties for a registered shader program
+	struct SHADER_PROGRAM
+	{
+		// the linked program, or 0 until the first compile finishes
+		GLuint programID;
+		// handle of the program, its index in the program list
+		int handle;
+		// program drawn with until this one is linked, or -1
+		int fallback;
+		// whether the program is built from SPIR-V modules
+		bool bSpirv;
+		// shader files the program is compiled from
+		std::string vertexPath;
+		std::string fragmentPath;
+		// the define block injected into the shader sources
+		std::string defines;
+		// cache key of the linked program's sources
+		uint64_t cacheKey;
+		// number of times a program was linked for this handle
+		unsigned int generation;
+		// objects of a compile that was submitted but not finished
+		GLuint pendingProgramID;
+		GLuint pendingVertexShaderID;
+		GLuint pendingFragmentShaderID;
+		uint64_t pendingCacheKey;
+		// time when the program was submitted for compiling
+		std::chrono::steady_clock::time_point queueTime;
+		// uniform locations for the linked program, keyed by name hash
+		mutable std::unordered_map<uint32_t, UNIFORM_INFO, UniformHashIdentity> uniformLocations;
+		// values written to the program, keyed by location so that
+		// names aliasing one location share the same shadow
+		mutable std::unordered_map<GLint, UNIFORM_VALUE> uniformValues;
+		// active interface of the linked program
+		PROGRAM_REFLECTION reflection;
+	};
+
+	// every registered program, indexed by handle - entries are
+	// never removed, so handles stay valid
+	std::vector<std::unique_ptr<SHADER_PROGRAM>> m_programs;
+	// the program that the uniform setters write into
+	SHADER_PROGRAM* m_pActiveProgram;
+	// program handles keyed by shader files and define block
+	std::unordered_map<std::string, int> m_programHandles;
+	// number of submitted compiles that are not finished
+	int m_pendingCompiles;
+	// time when the current batch of compiles started
+	std::chrono::steady_clock::time_point m_compileQueueStart;
+	// whether the last drained compile queue was reported
+	bool m_bQueueDrainReported;
+	// whether the driver compiler threads were configured
+	bool m_bCompilerThreadsSet;
+	// whether the compile status can be polled without blocking
+	bool m_bParallelCompile;
+	// shader files that LoadShaderVariant() compiles from
+	std::string m_vertexPath;
+	std::string m_fragmentPath;
+	// the number of uniform lookups that were not in the location cache
+	mutable unsigned int m_uniformCacheMisses;
+	// the uniform handles expected to be in the linked program
+	std::vector<UNIFORM_DESC> m_expectedUniforms;
+	// directory where linked program binaries are cached
+	std::string m_programCacheDirectory;
+	// shadow copies of the bound program and the other GL state
+	mutable GLStateCache m_stateCache;
+
+	// what the watcher thread needs for rebuilding the sources
+	// of a program, indexed by program handle
+	struct RELOAD_SOURCE
+	{
+		std::string vertexPath;
+		std::string fragmentPath;
+		std::string defines;
+		// the shader files and every file they include
+		std::vector<std::string> files;
+	};
+
+	// sources of a program that were rebuilt after a file changed
+	struct RELOAD_REQUEST
+	{
+		int handle;
+		std::string vertexCode;
+		std::string fragmentCode;
+	};
+
+	// watches the shader files while hot reload is enabled
+	std::unique_ptr<ShaderFileWatcher> m_pFileWatcher;
+	// guards the reload sources and requests, which are shared
+	// with the watcher thread
+	std::mutex m_reloadMutex;
+	std::vector<RELOAD_SOURCE> m_reloadSources;
+	std::vector<RELOAD_REQUEST> m_reloadRequests;
+
+	// whether the variants are built from the SPIR-V modules
+	bool m_bUseSpirv;
+	// the SPIR-V modules and where they were read from
+	std::string m_spirvVertexPath;
+	std::string m_spirvFragmentPath;
+	std::string m_spirvVertexCode;
+	std::string m_spirvFragmentCode;
+	// the defines that are specialization constants in the modules
+	std::vector<SPECIALIZATION_CONSTANT_DESC> m_spirvConstants;
+
+	// add a program for the shader files and define block
+	int LoadProgramEntry(
+		const std::string& vertexPath,
+		const std::string& fragmentPath,
+		const std::string& defines);
+	// add a program specialized from the SPIR-V modules
+	int LoadSpirvProgramEntry(const ShaderDefines& defines);
+	// create a program entry that is not compiled yet
+	std::unique_ptr<SHADER_PROGRAM> NewProgram(
+		const std::string& vertexPath,
+		const std::string& fragmentPath,
+		const std::string& defines) const;
+	// install a program from the program cache, if it is there
+	bool LoadCachedProgram(SHADER_PROGRAM& program, uint64_t cacheKey);
+	// add a program entry to the registry and return its handle
+	int AddProgram(
+		std::unique_ptr<SHADER_PROGRAM> program,
+		const std::string& registryKey,
+		const RELOAD_SOURCE& source);
+	// read a SPIR-V module and check its header
+	bool ReadSpirvModule(const std::string& path, std::string& code) const;
+	// expand the includes of a shader file and inject the defines -
+	// safe to call from any thread
+	bool PreprocessShader(
+		const std::string& path,
+		const std::string& defines,
+		std::vector<std::string>& includedFiles,
+		std::string& output) const;
+	// append a shader file to the preprocessor output, recursively
+	// expanding its #include directives
+	bool ExpandShaderIncludes(
+		const std::string& path,
+		const std::string& defines,
+		std::vector<std::string>& includedFiles,
+		int depth,
+		std::string& output) const;
+	// hand the shader sources to the driver without waiting
+	void SubmitCompile(
+		SHADER_PROGRAM& program,
+		const std::string& vertexCode,
+		const std::string& fragmentCode,
+		uint64_t cacheKey);
+	// hand the SPIR-V modules to the driver and specialize them
+	void SubmitSpirvCompile(
+		SHADER_PROGRAM& program,
+		const std::vector<GLuint>& constantIDs,
+		const std::vector<GLuint>& constantValues,
+		uint64_t cacheKey);
+	// link the compiled shaders without waiting
+	void SubmitLink(
+		SHADER_PROGRAM& program,
+		GLuint vertexShaderID,
+		GLuint fragmentShaderID,
+		uint64_t cacheKey);
+	// count a new compile on the compile queue
+	void PrepareCompileQueue(SHADER_PROGRAM& program);
+	// collect the result of a submitted compile
+	bool FinishCompile(SHADER_PROGRAM& program);
+	// throw away a submitted compile that is not finished
+	void CancelCompile(SHADER_PROGRAM& program);
+	// make a linked program the live program of its handle
+	void InstallProgram(SHADER_PROGRAM& program, GLuint programID, uint64_t cacheKey);
+	// rebuild the sources of the programs that use a changed
+	// file - called on the watcher thread
+	void OnShaderFileChanged(const std::string& path);
+	// submit the programs rebuilt by the watcher thread
+	void ProcessReloadRequests();
+	// build the program cache key from the sources and the driver
+	uint64_t GetProgramCacheKey(
+		const std::string& vertexCode,
+		const std::string& fragmentCode,
+		const std::string& defines) const;
+	// get the cache file path for the passed in cache key
+	std::string GetProgramCachePath(uint64_t cacheKey) const;
+	// restore a linked program from the program cache
+	GLuint LoadProgramBinary(uint64_t cacheKey);
+	// write a linked program into the program cache
+	bool SaveProgramBinary(GLuint programID, uint64_t cacheKey);
+
+	// fill the uniform location cache and the reflection data
+	void ReflectProgram(SHADER_PROGRAM& program) const;
+	// list the uniform blocks and attributes of the program
+	void ReflectProgramInterfaces(SHADER_PROGRAM& program) const;
+	// fill the uniform location cache of a SPIR-V program from
+	// the explicit locations of the registered uniform handles
+	void ReflectSpirvUniforms(SHADER_PROGRAM& program) const;
+	// report expected uniforms that have the wrong type
+	int ValidateExpectedUniforms(const SHADER_PROGRAM& program) const;
+	// get the cached uniform with the passed in name hash
+	UNIFORM_INFO* GetUniformInfo(uint32_t hash, const char* name) const;
+	// get the cached uniform with the passed in name
+	inline UNIFORM_INFO* GetUniformInfo(const std::string& name) const
+	{
+		return(GetUniformInfo(HashUniformName(name.c_str()), name.c_str()));
+	}
+	// get the cached uniform of the uniform handle
+	template <typename T>
+	inline UNIFORM_INFO* GetUniformInfo(const Uniform<T>& uniform) const
+	{
+		return(GetUniformInfo(uniform.hash, uniform.name));
+	}
+	// get the value shadow of a uniform location, or NULL
+	UNIFORM_VALUE* GetUniformValue(const SHADER_PROGRAM& program, GLint location) const;
+	// compare a value with the shadow of the uniform and keep it -
+	// returns false when the write would not change anything
+	bool UpdateUniformShadow(const UNIFORM_INFO* pInfo, const void* pValue, GLsizei size) const;
+
+public:
+
+	// activate the shader
+	// ------------------------------------------------------------------------
+	inline void use()
+	{
+		m_stateCache.UseProgram(m_programID);
+	}
+
+	// utility uniform functions
+	// ------------------------------------------------------------------------
+	inline void setBoolValue(const std::string &name, bool value) const
+	{
+		int intValue = (int)value;
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &intValue, sizeof(intValue)))
+			glUniform1i(pInfo->location, intValue);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setIntValue(const std::string &name, int value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1i(pInfo->location, value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setFloatValue(const std::string &name, float value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1f(pInfo->location, value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform2fv(pInfo->location, 1, &value[0]);
+	}
+
+	inline void setVec2Value(const std::string &name, float x, float y) const
+	{
+		setVec2Value(name, glm::vec2(x, y));
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform3fv(pInfo->location, 1, &value[0]);
+	}
+	inline void setVec3Value(const std::string &name, float x, float y, float z) const
+	{
+		setVec3Value(name, glm::vec3(x, y, z));
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform4fv(pInfo->location, 1, &value[0]);
+	}
+	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
+	{
+		setVec4Value(name, glm::vec4(x, y, z, w));
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &mat[0][0], sizeof(mat)))
+			glUniformMatrix2fv(pInfo->location, 1, GL_FALSE, &mat[0][0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &mat[0][0], sizeof(mat)))
+			glUniformMatrix3fv(pInfo->location, 1, GL_FALSE, &mat[0][0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &mat[0][0], sizeof(mat)))
+			glUniformMatrix4fv(pInfo->location, 1, GL_FALSE, glm::value_ptr(mat));
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setSampler2DValue(const std::string& name, const int &value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(name);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1i(pInfo->location, value);
+	}
+
+	// typed uniform handle functions
+	// ------------------------------------------------------------------------
+	inline void setBoolValue(const Uniform<bool>& uniform, bool value) const
+	{
+		int intValue = (int)value;
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &intValue, sizeof(intValue)))
+			glUniform1i(pInfo->location, intValue);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setIntValue(const Uniform<int>& uniform, int value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1i(pInfo->location, value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setFloatValue(const Uniform<float>& uniform, float value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1f(pInfo->location, value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec2Value(const Uniform<glm::vec2>& uniform, const glm::vec2& value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform2fv(pInfo->location, 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec3Value(const Uniform<glm::vec3>& uniform, const glm::vec3& value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform3fv(pInfo->location, 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec4Value(const Uniform<glm::vec4>& uniform, const glm::vec4& value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform4fv(pInfo->location, 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat2Value(const Uniform<glm::mat2>& uniform, const glm::mat2& mat) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &mat[0][0], sizeof(mat)))
+			glUniformMatrix2fv(pInfo->location, 1, GL_FALSE, &mat[0][0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat3Value(const Uniform<glm::mat3>& uniform, const glm::mat3& mat) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &mat[0][0], sizeof(mat)))
+			glUniformMatrix3fv(pInfo->location, 1, GL_FALSE, &mat[0][0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat4Value(const Uniform<glm::mat4>& uniform, const glm::mat4& mat) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &mat[0][0], sizeof(mat)))
+			glUniformMatrix4fv(pInfo->location, 1, GL_FALSE, glm::value_ptr(mat));
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setSampler2DValue(const Uniform<Sampler2D>& uniform, int value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1i(pInfo->location, value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setIVec2Value(const Uniform<glm::ivec2>& uniform, const glm::ivec2& value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value[0], sizeof(value)))
+			glUniform2iv(pInfo->location, 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setSampler2DArrayValue(const Uniform<Sampler2DArray>& uniform, int value) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &value, sizeof(value)))
+			glUniform1i(pInfo->location, value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setTextureHandleValue(const Uniform<Sampler2DArray>& uniform, GLuint64 handle) const
+	{
+		UNIFORM_INFO* pInfo = GetUniformInfo(uniform);
+		if (UpdateUniformShadow(pInfo, &handle, sizeof(handle)))
+			glUniformHandleui64ARB(pInfo->location, handle);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,580 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearrayset.cpp
+// ============
+// group textures of the same size and format into 2D array textures
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureArraySet.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+namespace
+{
+	/***********************************************************
+	 *  GetLevelStorageSize()
+	 *
+	 *  This function is used for getting the bytes that one
+	 *  layer of a level takes in video memory.  Drivers keep
+	 *  the 3 channel formats padded to 4 bytes a pixel.
+	 ***********************************************************/
+	size_t GetLevelStorageSize(GLenum internalFormat, int width, int height)
+	{
+		size_t blockSize = GetCompressedBlockSize(internalFormat);
+		if (blockSize > 0)
+		{
+			return(((size_t)(width + 3) / 4) * ((size_t)(height + 3) / 4) * blockSize);
+		}
+		return((size_t)width * (size_t)height * 4);
+	}
+}
+
+/***********************************************************
+ *  TextureArraySet()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureArraySet::TextureArraySet(GLStateCache* pStateCache, int maxArrays, bool bBindless)
+{
+	m_pStateCache = pStateCache;
+	m_maxArrays = maxArrays;
+	m_bBindless = bBindless;
+}
+
+/***********************************************************
+ *  ~TextureArraySet()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureArraySet::~TextureArraySet()
+{
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		if (m_arrays[i].handle != 0)
+		{
+			glMakeTextureHandleNonResidentARB(m_arrays[i].handle);
+		}
+		if (m_arrays[i].textureID != 0)
+		{
+			glDeleteTextures(1, &m_arrays[i].textureID);
+		}
+		if (m_arrays[i].pendingTextureID != 0)
+		{
+			glDeleteTextures(1, &m_arrays[i].pendingTextureID);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddTextures()
+ *
+ *  This method is used for storing a batch of textures as
+ *  layers of new array textures.  The textures with the same
+ *  size and format share an array, which is allocated with
+ *  one layer for each of them.  When every texture of an
+ *  array has its full mipmap chain, only the levels up to the
+ *  start size are uploaded, so the array is ready quickly and
+ *  the larger levels are streamed in when they are needed.
+ *  Textures that cannot be stored get the array index -1.
+ *  Returns false when a texture was not stored.
+ ***********************************************************/
+bool TextureArraySet::AddTextures(
+	const std::vector<TEXTURE_DATA>& textures,
+	TextureUploader* pUploader,
+	int startSize,
+	std::vector<TEXTURE_LAYER>& layers)
+{
+	layers.assign(textures.size(), TEXTURE_LAYER{ -1, 0 });
+
+	for (size_t first = 0; first < textures.size(); first++)
+	{
+		if (layers[first].arrayIndex >= 0)
+		{
+			continue;
+		}
+
+		// collect the rest of the batch that fits the same array
+		std::vector<size_t> group;
+		bool bStreamable = true;
+		int levelCount = GetMipLevelCount(textures[first].width, textures[first].height);
+		for (size_t i = first; i < textures.size(); i++)
+		{
+			if ((layers[i].arrayIndex < 0) &&
+				(textures[i].width == textures[first].width) &&
+				(textures[i].height == textures[first].height) &&
+				(textures[i].internalFormat == textures[first].internalFormat))
+			{
+				group.push_back(i);
+				bStreamable = (bStreamable) && ((int)textures[i].levels.size() == levelCount);
+			}
+		}
+
+		// the first level that is no larger than the start size
+		int residentLevel = 0;
+		while ((bStreamable) && (startSize > 0) && (residentLevel + 1 < levelCount) &&
+			(std::max(textures[first].width, textures[first].height) >> residentLevel) > startSize)
+		{
+			residentLevel++;
+		}
+
+		int arrayIndex = CreateArray(pUploader, textures[first].width, textures[first].height, textures[first].internalFormat, (int)group.size(), levelCount, residentLevel);
+		if (arrayIndex < 0)
+		{
+			return(false);
+		}
+
+		TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+		textureArray.bStreamable = bStreamable;
+		for (size_t layer = 0; layer < group.size(); layer++)
+		{
+			layers[group[layer]].arrayIndex = arrayIndex;
+			layers[group[layer]].layer = (int)layer;
+			textureArray.layerData.push_back(textures[group[layer]]);
+			textureArray.layerUsers.push_back(1);
+		}
+		QueueLevels(pUploader, textureArray, textureArray.textureID, residentLevel, levelCount);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddDynamicArray()
+ *
+ *  This method is used for creating an array for a texture
+ *  that changes while it is drawn.  It has a single level, so
+ *  it is complete with only level 0 written, and it keeps no
+ *  texture data, so its levels are never streamed.
+ ***********************************************************/
+int TextureArraySet::AddDynamicArray(
+	TextureUploader* pUploader,
+	int width,
+	int height,
+	GLenum internalFormat)
+{
+	int arrayIndex = CreateArray(pUploader, width, height, internalFormat, 1, 1, 0);
+	if (arrayIndex < 0)
+	{
+		return(-1);
+	}
+
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	textureArray.layerData.push_back(TEXTURE_DATA());
+	textureArray.layerUsers.push_back(1);
+
+	return(arrayIndex);
+}
+
+/***********************************************************
+ *  RetainLayer()
+ *
+ *  This method is used for counting one more texture that is
+ *  stored in a layer.
+ ***********************************************************/
+void TextureArraySet::RetainLayer(int arrayIndex, int layer)
+{
+	if ((arrayIndex >= 0) && (arrayIndex < (int)m_arrays.size()) &&
+		(layer >= 0) && (layer < (int)m_arrays[arrayIndex].layerUsers.size()))
+	{
+		m_arrays[arrayIndex].layerUsers[layer]++;
+	}
+}
+
+/***********************************************************
+ *  ReleaseLayer()
+ *
+ *  This method is used for letting go of one texture in a
+ *  layer of an array.  The layer is released along with its
+ *  last texture.  The layers of an array cannot be freed one
+ *  by one, so only the kept texture data of the layer is
+ *  dropped, and the array is kept until its last layer is
+ *  released.  Then
+ *  its uploads are dropped, the texture is deleted, and its
+ *  index is free for the next array.
+ ***********************************************************/
+void TextureArraySet::ReleaseLayer(int arrayIndex, int layer, TextureUploader* pUploader)
+{
+	if ((arrayIndex < 0) || (arrayIndex >= (int)m_arrays.size()) || (m_arrays[arrayIndex].textureID == 0))
+	{
+		return;
+	}
+
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	if ((layer < 0) || (layer >= (int)textureArray.layerUsers.size()) || (textureArray.layerUsers[layer] <= 0))
+	{
+		return;
+	}
+	textureArray.layerUsers[layer]--;
+	if (textureArray.layerUsers[layer] > 0)
+	{
+		return;
+	}
+
+	textureArray.layerData[layer] = TEXTURE_DATA();
+	textureArray.usedLayers--;
+	if (textureArray.usedLayers > 0)
+	{
+		return;
+	}
+
+	CancelStorage(textureArray, pUploader);
+	if (NULL != pUploader)
+	{
+		pUploader->CancelUploads(textureArray.textureID);
+	}
+	if (textureArray.handle != 0)
+	{
+		glMakeTextureHandleNonResidentARB(textureArray.handle);
+	}
+	m_pStateCache->ForgetTexture(textureArray.textureID);
+	glDeleteTextures(1, &textureArray.textureID);
+
+	printf("Deleted texture array %d: %dx%d, %d layers\n", arrayIndex, textureArray.width, textureArray.height, textureArray.layerCount);
+
+	textureArray.textureID = 0;
+	textureArray.handle = 0;
+	textureArray.layerCount = 0;
+	textureArray.usedLayers = 0;
+	textureArray.layerData.clear();
+	textureArray.layerUsers.clear();
+}
+
+/***********************************************************
+ *  SetResidentLevel()
+ *
+ *  This method is used for changing the most detailed level
+ *  that an array stores.  New storage is allocated from that
+ *  level down, the levels that the current storage already
+ *  holds are copied into it on the GPU, and only the rest are
+ *  uploaded from the kept texture data.  The current storage
+ *  is sampled until the uploads are done, and dropping levels
+ *  needs no uploads, so it takes effect right away.
+ ***********************************************************/
+bool TextureArraySet::SetResidentLevel(int arrayIndex, int level, TextureUploader* pUploader)
+{
+	if ((arrayIndex < 0) || (arrayIndex >= (int)m_arrays.size()) || (IsStreamable(arrayIndex) == false))
+	{
+		return(false);
+	}
+
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	level = std::max(0, std::min(level, textureArray.levelCount - 1));
+	if (textureArray.pendingTextureID != 0)
+	{
+		if (textureArray.pendingLevel == level)
+		{
+			return(true);
+		}
+		CancelStorage(textureArray, pUploader);
+	}
+	if (level == textureArray.residentLevel)
+	{
+		return(true);
+	}
+
+	GLuint textureID = AllocateStorage(pUploader, textureArray, level);
+
+	// the current storage cannot be copied while it is still
+	// waiting for its own pixels
+	int uploadEnd = textureArray.levelCount;
+	if (((GLEW_VERSION_4_3) || (GLEW_ARB_copy_image)) &&
+		(pUploader->IsUploadPending(textureArray.textureID) == false))
+	{
+		for (int source = std::max(level, textureArray.residentLevel); source < textureArray.levelCount; source++)
+		{
+			glCopyImageSubData(
+				textureArray.textureID, GL_TEXTURE_2D_ARRAY, source - textureArray.residentLevel, 0, 0, 0,
+				textureID, GL_TEXTURE_2D_ARRAY, source - level, 0, 0, 0,
+				std::max(1, textureArray.width >> source),
+				std::max(1, textureArray.height >> source),
+				textureArray.layerCount);
+		}
+		uploadEnd = std::max(level, textureArray.residentLevel);
+	}
+
+	textureArray.pendingTextureID = textureID;
+	textureArray.pendingLevel = level;
+	QueueLevels(pUploader, textureArray, textureID, level, uploadEnd);
+	if (pUploader->IsUploadPending(textureID) == false)
+	{
+		SwapStorage(arrayIndex);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FinishResidentLevels()
+ *
+ *  This method is used for swapping in the new storage of
+ *  the arrays once all of its levels are uploaded.  Returns
+ *  the number of arrays whose texture changed.
+ ***********************************************************/
+int TextureArraySet::FinishResidentLevels(TextureUploader* pUploader)
+{
+	int finishedArrays = 0;
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		if ((m_arrays[i].pendingTextureID != 0) &&
+			(pUploader->IsUploadPending(m_arrays[i].pendingTextureID) == false))
+		{
+			SwapStorage((int)i);
+			finishedArrays++;
+		}
+	}
+
+	return(finishedArrays);
+}
+
+/***********************************************************
+ *  GetStorageSize()
+ *
+ *  This method is used for getting the bytes that every
+ *  layer of an array takes from the passed in level down.
+ ***********************************************************/
+size_t TextureArraySet::GetStorageSize(int arrayIndex, int level) const
+{
+	const TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	size_t size = 0;
+	for (int i = std::max(0, level); i < textureArray.levelCount; i++)
+	{
+		size += GetLevelStorageSize(
+			textureArray.internalFormat,
+			std::max(1, textureArray.width >> i),
+			std::max(1, textureArray.height >> i));
+	}
+
+	return(size * (size_t)textureArray.layerCount);
+}
+
+/***********************************************************
+ *  GetResidentBytes()
+ *
+ *  This method is used for getting the bytes of every array
+ *  storage, counting the storage that is still being filled
+ *  along with the storage it replaces.
+ ***********************************************************/
+size_t TextureArraySet::GetResidentBytes() const
+{
+	size_t residentBytes = 0;
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		if (m_arrays[i].textureID == 0)
+		{
+			continue;
+		}
+		residentBytes += GetStorageSize((int)i, m_arrays[i].residentLevel);
+		if (m_arrays[i].pendingTextureID != 0)
+		{
+			residentBytes += GetStorageSize((int)i, m_arrays[i].pendingLevel);
+		}
+	}
+
+	return(residentBytes);
+}
+
+/***********************************************************
+ *  BindArrays()
+ *
+ *  This method is used for binding every array on the
+ *  texture unit with the same number as the array index.
+ ***********************************************************/
+void TextureArraySet::BindArrays() const
+{
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		m_pStateCache->BindTextureUnit((GLuint)i, GL_TEXTURE_2D_ARRAY, m_arrays[i].textureID);
+	}
+}
+
+/***********************************************************
+ *  CreateArray()
+ *
+ *  This method is used for allocating an array texture with
+ *  immutable storage for each of its levels from the resident
+ *  level down, so that the uploader can fill in the layers,
+ *  and so that a bindless handle can be taken right away.
+ *  Returns the index of the array, or -1.
+ ***********************************************************/
+int TextureArraySet::CreateArray(TextureUploader* pUploader, int width, int height, GLenum internalFormat, int layerCount, int levelCount, int residentLevel)
+{
+	// reuse the index of a deleted array first
+	int arrayIndex = 0;
+	while ((arrayIndex < (int)m_arrays.size()) && (m_arrays[arrayIndex].textureID != 0))
+	{
+		arrayIndex++;
+	}
+	if (arrayIndex >= m_maxArrays)
+	{
+		printf("Too many texture sizes and formats - the shaders take at most %d texture arrays\n", m_maxArrays);
+		return(-1);
+	}
+
+	TEXTURE_ARRAY textureArray;
+	textureArray.width = width;
+	textureArray.height = height;
+	textureArray.internalFormat = internalFormat;
+	textureArray.layerCount = layerCount;
+	textureArray.usedLayers = layerCount;
+	textureArray.levelCount = levelCount;
+	textureArray.residentLevel = residentLevel;
+	textureArray.bStreamable = false;
+	textureArray.pendingTextureID = 0;
+	textureArray.pendingLevel = 0;
+	textureArray.handle = 0;
+	textureArray.textureID = AllocateStorage(pUploader, textureArray, residentLevel);
+
+	// the sampling state is fixed once the handle is taken
+	if (m_bBindless)
+	{
+		textureArray.handle = glGetTextureHandleARB(textureArray.textureID);
+		glMakeTextureHandleResidentARB(textureArray.handle);
+	}
+
+	if (arrayIndex < (int)m_arrays.size())
+	{
+		m_arrays[arrayIndex] = textureArray;
+	}
+	else
+	{
+		m_arrays.push_back(textureArray);
+	}
+
+	printf("Created texture array %d: %dx%d, %d layers, from level %d\n", arrayIndex, width, height, layerCount, residentLevel);
+
+	return(arrayIndex);
+}
+
+/***********************************************************
+ *  AllocateStorage()
+ *
+ *  This method is used for creating a texture with immutable
+ *  storage for the levels of an array from the passed in
+ *  level down, and setting its sampling state.  Returns the
+ *  new texture.
+ ***********************************************************/
+GLuint TextureArraySet::AllocateStorage(TextureUploader* pUploader, const TEXTURE_ARRAY& textureArray, int level)
+{
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	pUploader->BindForUpload(textureID, GL_TEXTURE_2D_ARRAY);
+	glTexStorage3D(
+		GL_TEXTURE_2D_ARRAY,
+		textureArray.levelCount - level,
+		textureArray.internalFormat,
+		std::max(1, textureArray.width >> level),
+		std::max(1, textureArray.height >> level),
+		textureArray.layerCount);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters - the mipmaps are sampled
+	// so that distant textures read the smaller levels
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  QueueLevels()
+ *
+ *  This method is used for queueing the levels of every layer
+ *  that still holds a texture, from the first level up to
+ *  the end level, into storage that starts at the first
+ *  level.  Texture data without its full mipmap chain is
+ *  queued as it is.
+ ***********************************************************/
+void TextureArraySet::QueueLevels(
+	TextureUploader* pUploader,
+	const TEXTURE_ARRAY& textureArray,
+	GLuint textureID,
+	int firstLevel,
+	int endLevel)
+{
+	if (firstLevel >= endLevel)
+	{
+		return;
+	}
+
+	for (size_t layer = 0; layer < textureArray.layerData.size(); layer++)
+	{
+		const TEXTURE_DATA& data = textureArray.layerData[layer];
+		if (data.levels.empty())
+		{
+			continue;
+		}
+		if (textureArray.bStreamable == false)
+		{
+			pUploader->QueueUpload(textureID, GL_TEXTURE_2D_ARRAY, (int)layer, data);
+			continue;
+		}
+
+		// the levels share the pixel memory of the kept data
+		TEXTURE_DATA levels = data;
+		levels.width = data.levels[firstLevel].width;
+		levels.height = data.levels[firstLevel].height;
+		levels.levels.assign(data.levels.begin() + firstLevel, data.levels.begin() + endLevel);
+		levels.bGenerateMipmaps = false;
+		pUploader->QueueUpload(textureID, GL_TEXTURE_2D_ARRAY, (int)layer, levels);
+	}
+}
+
+/***********************************************************
+ *  SwapStorage()
+ *
+ *  This method is used for deleting the storage of an array
+ *  and sampling its pending storage instead, which needs a
+ *  new bindless handle, or a new binding on the unit of the
+ *  array.
+ ***********************************************************/
+void TextureArraySet::SwapStorage(int arrayIndex)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	if (textureArray.handle != 0)
+	{
+		glMakeTextureHandleNonResidentARB(textureArray.handle);
+		textureArray.handle = 0;
+	}
+	m_pStateCache->ForgetTexture(textureArray.textureID);
+	glDeleteTextures(1, &textureArray.textureID);
+
+	textureArray.textureID = textureArray.pendingTextureID;
+	textureArray.residentLevel = textureArray.pendingLevel;
+	textureArray.pendingTextureID = 0;
+
+	if (m_bBindless)
+	{
+		textureArray.handle = glGetTextureHandleARB(textureArray.textureID);
+		glMakeTextureHandleResidentARB(textureArray.handle);
+	}
+	else
+	{
+		m_pStateCache->BindTextureUnit((GLuint)arrayIndex, GL_TEXTURE_2D_ARRAY, textureArray.textureID);
+	}
+}
+
+/***********************************************************
+ *  CancelStorage()
+ *
+ *  This method is used for dropping the pending storage of
+ *  an array along with its queued uploads.
+ ***********************************************************/
+void TextureArraySet::CancelStorage(TEXTURE_ARRAY& textureArray, TextureUploader* pUploader)
+{
+	if (textureArray.pendingTextureID == 0)
+	{
+		return;
+	}
+
+	if (NULL != pUploader)
+	{
+		pUploader->CancelUploads(textureArray.pendingTextureID);
+	}
+	m_pStateCache->ForgetTexture(textureArray.pendingTextureID);
+	glDeleteTextures(1, &textureArray.pendingTextureID);
+	textureArray.pendingTextureID = 0;
+}
@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearrayset.h
+// ============
+// group textures of the same size and format into 2D array textures
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+#include "TextureData.h"
+#include "TextureUploader.h"
+
+#include <vector>
+
+/***********************************************************
+ *  TextureArraySet
+ *
+ *  This class keeps the scene textures as layers of 2D array
+ *  textures, one array for each size and format.  A texture
+ *  is found by the index of its array and its layer, so the
+ *  shader selects it with integers instead of a sampler that
+ *  is changed for each draw.  With bindless textures every
+ *  array is made resident and passed to the shaders by its
+ *  handle, otherwise each array is bound on its own unit.
+ *
+ *  The texture data of each layer is kept, so the levels of
+ *  an array can be streamed in and out while it is in use.
+ *  An array stores its levels from its resident level down,
+ *  and a change of the resident level allocates new storage
+ *  that takes over once its missing levels are uploaded.
+ ***********************************************************/
+class TextureArraySet
+{
+public:
+	// where a texture is stored
+	struct TEXTURE_LAYER
+	{
+		// index of the array, or -1 when there is no texture
+		int arrayIndex;
+		int layer;
+	};
+
+	// constructor
+	TextureArraySet(GLStateCache* pStateCache, int maxArrays, bool bBindless);
+	// destructor
+	~TextureArraySet();
+
+	// create the arrays for a batch of textures, grouped by
+	// size and format, and queue their pixels on the passed in
+	// uploader - the arrays start with the levels no larger
+	// than the start size, or with every level for a start size
+	// of 0, and the layer of each texture is returned in the
+	// same order
+	bool AddTextures(
+		const std::vector<TEXTURE_DATA>& textures,
+		TextureUploader* pUploader,
+		int startSize,
+		std::vector<TEXTURE_LAYER>& layers);
+
+	// create an array with one layer and no mipmaps, whose
+	// pixels are written by its owner while it is in use, such
+	// as the frames of a video - returns the index of the array,
+	// or -1
+	int AddDynamicArray(
+		TextureUploader* pUploader,
+		int width,
+		int height,
+		GLenum internalFormat);
+
+	// add a texture that shares a layer, such as an atlas page,
+	// so the layer is kept until each of them lets go of it
+	void RetainLayer(int arrayIndex, int layer);
+	// let go of the layer of a texture - the array is deleted
+	// with its last layer, and its index is reused
+	void ReleaseLayer(int arrayIndex, int layer, TextureUploader* pUploader);
+
+	// start storing the levels of an array from the passed in
+	// level down - returns false when the levels of the array
+	// cannot be streamed
+	bool SetResidentLevel(int arrayIndex, int level, TextureUploader* pUploader);
+	// swap in the storage of the arrays whose new levels are
+	// uploaded - returns the number of arrays that changed
+	int FinishResidentLevels(TextureUploader* pUploader);
+	// get the bytes that the levels of an array take from the
+	// passed in level down
+	size_t GetStorageSize(int arrayIndex, int level) const;
+	// get the bytes of every stored level, including the
+	// storage that is still being filled
+	size_t GetResidentBytes() const;
+
+	// bind each array on the texture unit of the same number -
+	// not needed with bindless textures
+	void BindArrays() const;
+
+	// get the number of arrays
+	inline int GetArrayCount() const
+	{
+		return((int)m_arrays.size());
+	}
+	// get the OpenGL texture of an array, or 0 for a free index
+	inline GLuint GetArrayID(int arrayIndex) const
+	{
+		return(m_arrays[arrayIndex].textureID);
+	}
+	// get the bindless handle of an array, or 0
+	inline GLuint64 GetArrayHandle(int arrayIndex) const
+	{
+		return(m_arrays[arrayIndex].handle);
+	}
+	// check whether the arrays are used through bindless handles
+	inline bool IsBindless() const
+	{
+		return(m_bBindless);
+	}
+	// get the largest side of the textures in an array
+	inline int GetArraySize(int arrayIndex) const
+	{
+		return((m_arrays[arrayIndex].width > m_arrays[arrayIndex].height) ? m_arrays[arrayIndex].width : m_arrays[arrayIndex].height);
+	}
+	// get the number of levels in the full mipmap chain of an
+	// array, or 1 for a dynamic array
+	inline int GetLevelCount(int arrayIndex) const
+	{
+		return(m_arrays[arrayIndex].levelCount);
+	}
+	// get the most detailed level that an array stores
+	inline int GetResidentLevel(int arrayIndex) const
+	{
+		return(m_arrays[arrayIndex].residentLevel);
+	}
+	// get the level that the storage being filled starts at, or
+	// -1 when the levels of an array are not changing
+	inline int GetPendingLevel(int arrayIndex) const
+	{
+		return((m_arrays[arrayIndex].pendingTextureID != 0) ? m_arrays[arrayIndex].pendingLevel : -1);
+	}
+	// check whether the levels of an array can be streamed
+	inline bool IsStreamable(int arrayIndex) const
+	{
+		return((m_arrays[arrayIndex].textureID != 0) && (m_arrays[arrayIndex].bStreamable));
+	}
+
+private:
+	// properties for one array texture
+	struct TEXTURE_ARRAY
+	{
+		GLuint textureID;
+		// resident bindless handle, or 0
+		GLuint64 handle;
+		int width;
+		int height;
+		GLenum internalFormat;
+		int layerCount;
+		// number of layers that still hold a texture
+		int usedLayers;
+		// number of textures that share each layer
+		std::vector<int> layerUsers;
+		// number of levels in the full mipmap chain, or 1 for a
+		// dynamic array
+		int levelCount;
+		// the most detailed level that is stored, which is
+		// level 0 of the texture
+		int residentLevel;
+		// the texture data of each layer, kept for streaming the
+		// levels in again - empty for a released layer
+		std::vector<TEXTURE_DATA> layerData;
+		// whether every layer has its full mipmap chain, so the
+		// levels can be streamed
+		bool bStreamable;
+		// storage starting at another level that is being filled,
+		// or 0
+		GLuint pendingTextureID;
+		int pendingLevel;
+	};
+
+	// state cache used for the texture bindings
+	GLStateCache* m_pStateCache;
+	// the most arrays that the shaders can select from
+	int m_maxArrays;
+	// whether the arrays are used through bindless handles
+	bool m_bBindless;
+	// the created arrays - a deleted array leaves its index
+	// free, with a texture of 0, so the other indices stay valid
+	std::vector<TEXTURE_ARRAY> m_arrays;
+
+	// allocate an array texture with the passed in number of
+	// levels, from the resident level down
+	int CreateArray(
+		TextureUploader* pUploader,
+		int width,
+		int height,
+		GLenum internalFormat,
+		int layerCount,
+		int levelCount,
+		int residentLevel);
+	// allocate the storage of an array from a level down
+	GLuint AllocateStorage(
+		TextureUploader* pUploader,
+		const TEXTURE_ARRAY& textureArray,
+		int level);
+	// queue the levels of the layers of an array, from the
+	// first level up to the end level, into storage that starts
+	// at the first level
+	void QueueLevels(
+		TextureUploader* pUploader,
+		const TEXTURE_ARRAY& textureArray,
+		GLuint textureID,
+		int firstLevel,
+		int endLevel);
+	// replace the storage of an array with its pending storage
+	void SwapStorage(int arrayIndex);
+	// delete the pending storage of an array
+	void CancelStorage(TEXTURE_ARRAY& textureArray, TextureUploader* pUploader);
+};
@@ -0,0 +1,300 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.cpp
+// ============
+// pack small textures into shared atlas pages
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureAtlas.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+	/***********************************************************
+	 *  Wrap()
+	 *
+	 *  This function is used for wrapping a texel coordinate
+	 *  around into a texture of the passed in size.
+	 ***********************************************************/
+	inline int Wrap(int coordinate, int size)
+	{
+		int wrapped = coordinate % size;
+		return((wrapped < 0) ? wrapped + size : wrapped);
+	}
+}
+
+/***********************************************************
+ *  TextureAtlas()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureAtlas::TextureAtlas(int pageSize, int maxSize, int padding)
+{
+	m_pageSize = pageSize;
+	m_maxSize = maxSize;
+	m_padding = (padding > 0) ? padding : 1;
+}
+
+/***********************************************************
+ *  Pack()
+ *
+ *  This method is used for packing the small uncompressed
+ *  textures into pages, one set of pages for each format.
+ *  The tallest textures are placed first, each at the lowest
+ *  spot of the first page that it fits on.  A format with a
+ *  single small texture is not packed, since sharing a page
+ *  gains nothing then.  The pages only hold level 0, so their
+ *  mipmaps still need to be built.  Returns true when any
+ *  texture was packed.
+ ***********************************************************/
+bool TextureAtlas::Pack(
+	const std::vector<TEXTURE_DATA>& textures,
+	std::vector<TEXTURE_DATA>& pages,
+	std::vector<ATLAS_PLACEMENT>& placements) const
+{
+	placements.assign(textures.size(), ATLAS_PLACEMENT{ -1, 0.0f, 0.0f, 1.0f, 1.0f });
+
+	std::vector<bool> bGrouped(textures.size(), false);
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		const TEXTURE_DATA& texture = textures[i];
+		bGrouped[i] =
+			(texture.pixelFormat == 0) ||
+			(texture.levels.empty()) ||
+			(std::max(texture.width, texture.height) > m_maxSize) ||
+			(std::max(texture.width, texture.height) + 2 * m_padding > m_pageSize);
+	}
+
+	int cells = m_pageSize / m_padding;
+	int packedTextures = 0;
+	size_t firstPage = pages.size();
+
+	for (size_t first = 0; first < textures.size(); first++)
+	{
+		if (bGrouped[first])
+		{
+			continue;
+		}
+
+		// collect the rest of the textures of the same format
+		std::vector<size_t> group;
+		for (size_t i = first; i < textures.size(); i++)
+		{
+			if ((bGrouped[i] == false) &&
+				(textures[i].internalFormat == textures[first].internalFormat) &&
+				(textures[i].pixelFormat == textures[first].pixelFormat))
+			{
+				group.push_back(i);
+				bGrouped[i] = true;
+			}
+		}
+		if (group.size() < 2)
+		{
+			continue;
+		}
+
+		std::stable_sort(group.begin(), group.end(),
+			[&textures](size_t a, size_t b)
+			{
+				return(textures[a].height > textures[b].height);
+			});
+
+		// place the textures, in cells, starting a new page when
+		// none of the pages has room
+		std::vector<std::vector<SKYLINE_SEGMENT>> skylines;
+		std::vector<int> cellX(textures.size(), 0);
+		std::vector<int> cellY(textures.size(), 0);
+		size_t groupFirstPage = pages.size();
+		for (size_t i = 0; i < group.size(); i++)
+		{
+			const TEXTURE_DATA& texture = textures[group[i]];
+			int width = (texture.width + 2 * m_padding + m_padding - 1) / m_padding;
+			int height = (texture.height + 2 * m_padding + m_padding - 1) / m_padding;
+
+			size_t page = 0;
+			while ((page < skylines.size()) &&
+				(Place(skylines[page], width, height, cellX[group[i]], cellY[group[i]]) == false))
+			{
+				page++;
+			}
+			if (page == skylines.size())
+			{
+				skylines.push_back(std::vector<SKYLINE_SEGMENT>(1, SKYLINE_SEGMENT{ 0, cells, 0 }));
+				Place(skylines[page], width, height, cellX[group[i]], cellY[group[i]]);
+			}
+			placements[group[i]].page = (int)(groupFirstPage + page);
+		}
+
+		// copy the textures into the pages, which are owned by
+		// their texture data
+		size_t pixelSize = (textures[first].pixelFormat == GL_RGBA) ? 4 : 3;
+		for (size_t page = 0; page < skylines.size(); page++)
+		{
+			std::shared_ptr<std::vector<unsigned char>> pPixels = std::make_shared<std::vector<unsigned char>>(
+				(size_t)m_pageSize * (size_t)m_pageSize * pixelSize, (unsigned char)0);
+
+			TEXTURE_DATA pageData;
+			pageData.filename = "atlas page " + std::to_string(pages.size());
+			pageData.width = m_pageSize;
+			pageData.height = m_pageSize;
+			pageData.internalFormat = textures[first].internalFormat;
+			pageData.pixelFormat = textures[first].pixelFormat;
+			pageData.levels.push_back(TEXTURE_LEVEL{ m_pageSize, m_pageSize, pPixels->data(), pPixels->size() });
+			pageData.bGenerateMipmaps = true;
+			pageData.pOwner = pPixels;
+
+			for (size_t i = 0; i < group.size(); i++)
+			{
+				ATLAS_PLACEMENT& placement = placements[group[i]];
+				if (placement.page != (int)(groupFirstPage + page))
+				{
+					continue;
+				}
+
+				const TEXTURE_DATA& texture = textures[group[i]];
+				int x = cellX[group[i]] * m_padding + m_padding;
+				int y = cellY[group[i]] * m_padding + m_padding;
+				CopyTexture(texture, pPixels->data(), pixelSize, x, y);
+
+				placement.offsetU = (float)x / m_pageSize;
+				placement.offsetV = (float)y / m_pageSize;
+				placement.scaleU = (float)texture.width / m_pageSize;
+				placement.scaleV = (float)texture.height / m_pageSize;
+				packedTextures++;
+			}
+
+			pages.push_back(pageData);
+		}
+	}
+
+	if (packedTextures > 0)
+	{
+		printf("Packed %d textures into %d atlas pages of %dx%d\n", packedTextures, (int)(pages.size() - firstPage), m_pageSize, m_pageSize);
+	}
+
+	return(packedTextures > 0);
+}
+
+/***********************************************************
+ *  Place()
+ *
+ *  This method is used for finding the lowest spot on a page
+ *  where a rectangle of cells fits, and the leftmost of
+ *  those.  The skyline is the height of the placed rectangles
+ *  along the page, kept as runs of the same height, and a
+ *  rectangle sits on the highest run below it.
+ ***********************************************************/
+bool TextureAtlas::Place(
+	std::vector<SKYLINE_SEGMENT>& skyline,
+	int width,
+	int height,
+	int& x,
+	int& y) const
+{
+	int cells = m_pageSize / m_padding;
+	int bestX = -1;
+	int bestY = cells;
+
+	for (size_t i = 0; i < skyline.size(); i++)
+	{
+		int left = skyline[i].x;
+		if (left + width > cells)
+		{
+			break;
+		}
+
+		int top = 0;
+		for (size_t j = i; (j < skyline.size()) && (skyline[j].x < left + width); j++)
+		{
+			top = std::max(top, skyline[j].height);
+		}
+		if ((top + height <= cells) && (top < bestY))
+		{
+			bestX = left;
+			bestY = top;
+		}
+	}
+	if (bestX < 0)
+	{
+		return(false);
+	}
+
+	// raise the skyline under the rectangle, cutting the runs
+	// that it covers
+	std::vector<SKYLINE_SEGMENT> raised;
+	for (size_t i = 0; i < skyline.size(); i++)
+	{
+		const SKYLINE_SEGMENT& segment = skyline[i];
+		int right = segment.x + segment.width;
+		if (segment.x < bestX)
+		{
+			raised.push_back(SKYLINE_SEGMENT{ segment.x, std::min(right, bestX) - segment.x, segment.height });
+		}
+		if ((segment.x <= bestX) && (right > bestX))
+		{
+			raised.push_back(SKYLINE_SEGMENT{ bestX, width, bestY + height });
+		}
+		if (right > bestX + width)
+		{
+			int left = std::max(segment.x, bestX + width);
+			raised.push_back(SKYLINE_SEGMENT{ left, right - left, segment.height });
+		}
+	}
+
+	// runs of the same height are merged
+	skyline.clear();
+	for (size_t i = 0; i < raised.size(); i++)
+	{
+		if ((!skyline.empty()) && (skyline.back().height == raised[i].height))
+		{
+			skyline.back().width += raised[i].width;
+		}
+		else
+		{
+			skyline.push_back(raised[i]);
+		}
+	}
+
+	x = bestX;
+	y = bestY;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CopyTexture()
+ *
+ *  This method is used for copying level 0 of a texture into
+ *  a page, with its top left texel at the passed in spot.
+ *  The border around it repeats the texture, as if it were
+ *  wrapped, so the filtering across its edges matches the
+ *  repeat wrapping of a texture of its own.
+ ***********************************************************/
+void TextureAtlas::CopyTexture(
+	const TEXTURE_DATA& texture,
+	unsigned char* pPage,
+	size_t pixelSize,
+	int x,
+	int y) const
+{
+	const unsigned char* pPixels = texture.levels[0].pixels;
+	size_t rowSize = (size_t)texture.width * pixelSize;
+
+	for (int row = -m_padding; row < texture.height + m_padding; row++)
+	{
+		const unsigned char* pSource = pPixels + (size_t)Wrap(row, texture.height) * rowSize;
+		unsigned char* pDestination = pPage + ((size_t)(y + row) * m_pageSize + x) * pixelSize;
+
+		memcpy(pDestination, pSource, rowSize);
+		for (int column = 1; column <= m_padding; column++)
+		{
+			memcpy(pDestination - column * pixelSize, pSource + Wrap(-column, texture.width) * pixelSize, pixelSize);
+			memcpy(pDestination + (texture.width + column - 1) * pixelSize, pSource + Wrap(texture.width + column - 1, texture.width) * pixelSize, pixelSize);
+		}
+	}
+}
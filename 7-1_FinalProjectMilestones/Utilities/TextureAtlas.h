@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.h
+// ============
+// pack small textures into shared atlas pages
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureData.h"
+
+#include <vector>
+
+/***********************************************************
+ *  TextureAtlas
+ *
+ *  This class packs small uncompressed textures of the same
+ *  format into square atlas pages, with a skyline packer, so
+ *  that many textures share one layer of a texture array
+ *  instead of each needing a layer, or an array of its own
+ *  size.  Each texture is surrounded by a border of texels
+ *  that wraps around from its opposite edges, and starts on a
+ *  multiple of the border, so repeating it and sampling the
+ *  first few mipmap levels does not bleed its neighbours in.
+ *  The shaders find a texture by the rectangle that it was
+ *  placed at.
+ ***********************************************************/
+class TextureAtlas
+{
+public:
+	// where a texture was placed
+	struct ATLAS_PLACEMENT
+	{
+		// index of the page, or -1 when the texture was not packed
+		int page;
+		// the rectangle of the texture in its page, in texture
+		// coordinates
+		float offsetU;
+		float offsetV;
+		float scaleU;
+		float scaleV;
+	};
+
+	// constructor - textures larger than the largest size are
+	// not packed
+	TextureAtlas(int pageSize = 1024, int maxSize = 512, int padding = 8);
+
+	// pack the textures that fit into pages, which only hold
+	// level 0 - the placement of each texture is returned in the
+	// same order
+	bool Pack(
+		const std::vector<TEXTURE_DATA>& textures,
+		std::vector<TEXTURE_DATA>& pages,
+		std::vector<ATLAS_PLACEMENT>& placements) const;
+
+private:
+	// a horizontal run of the skyline of a page, in cells
+	struct SKYLINE_SEGMENT
+	{
+		int x;
+		int width;
+		int height;
+	};
+
+	// the width and height of the pages in texels
+	int m_pageSize;
+	// the largest side of a texture that is packed
+	int m_maxSize;
+	// the texels around each texture, which is also the size of
+	// the cells that the skyline is kept in
+	int m_padding;
+
+	// find the lowest place for a rectangle of cells on a page,
+	// and raise the skyline over it - returns false when the
+	// rectangle does not fit
+	bool Place(
+		std::vector<SKYLINE_SEGMENT>& skyline,
+		int width,
+		int height,
+		int& x,
+		int& y) const;
+	// copy a texture into its place on a page, along with its
+	// wrapped border
+	void CopyTexture(
+		const TEXTURE_DATA& texture,
+		unsigned char* pPage,
+		size_t pixelSize,
+		int x,
+		int y) const;
+};
@@ -0,0 +1,876 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.cpp
+// ============
+// block compress texture data into BC1, BC3 or BC7 on worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCompressor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include <algorithm>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TEXTURE_COMPRESSOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// number of block rows in one tile of work
+	const int g_TileBlockRows = 8;
+	// number of refinement passes at QUALITY_HIGH
+	const int g_RefinePasses = 2;
+
+	// the interpolation weights of the BC7 4 bit indices, out of 64
+	const int g_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// the pixels of a 4x4 block, one array per channel
+	struct PIXEL_BLOCK
+	{
+		float channels[4][16];
+	};
+
+	// the colors an encoded block can choose from
+	struct BLOCK_PALETTE
+	{
+		float colors[16][4];
+		// how far each color is from the first endpoint to the
+		// second, for the least squares refinement
+		float weights[16];
+		int count;
+	};
+
+	/***********************************************************
+	 *  FetchBlock()
+	 *
+	 *  This function is used for reading a 4x4 block of pixels.
+	 *  Blocks past the edge of the level repeat its last row or
+	 *  column, and RGB pixels read as opaque.
+	 ***********************************************************/
+	void FetchBlock(const unsigned char* pixels, int width, int height, int channels, int blockX, int blockY, PIXEL_BLOCK& block)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			int sourceY = std::min(blockY * 4 + y, height - 1);
+			for (int x = 0; x < 4; x++)
+			{
+				int sourceX = std::min(blockX * 4 + x, width - 1);
+				const unsigned char* pPixel = pixels + ((size_t)sourceY * width + sourceX) * channels;
+				int i = y * 4 + x;
+				block.channels[0][i] = pPixel[0];
+				block.channels[1][i] = pPixel[1];
+				block.channels[2][i] = pPixel[2];
+				block.channels[3][i] = (channels == 4) ? pPixel[3] : 255.0f;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  FindClosestColors()
+	 *
+	 *  This function is used for choosing the closest palette
+	 *  color for each pixel of a block.  Only the channels with
+	 *  a mask of 1 count.  Four pixels are compared at a time
+	 *  with SSE2.  Returns the total squared error.
+	 ***********************************************************/
+	float FindClosestColors(const PIXEL_BLOCK& block, const BLOCK_PALETTE& palette, const float mask[4], int indices[16])
+	{
+		float totalError = 0.0f;
+
+#ifdef TEXTURE_COMPRESSOR_SSE2
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 channels[4];
+			for (int c = 0; c < 4; c++)
+			{
+				channels[c] = _mm_loadu_ps(&block.channels[c][i]);
+			}
+
+			__m128 bestError = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+			for (int p = 0; p < palette.count; p++)
+			{
+				__m128 error = _mm_setzero_ps();
+				for (int c = 0; c < 4; c++)
+				{
+					__m128 difference = _mm_sub_ps(channels[c], _mm_set1_ps(palette.colors[p][c]));
+					error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(difference, difference), _mm_set1_ps(mask[c])));
+				}
+
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+				bestError = _mm_min_ps(error, bestError);
+				bestIndex = _mm_or_si128(
+					_mm_and_si128(closer, _mm_set1_epi32(p)),
+					_mm_andnot_si128(closer, bestIndex));
+			}
+
+			float errors[4];
+			_mm_storeu_ps(errors, bestError);
+			_mm_storeu_si128((__m128i*)&indices[i], bestIndex);
+			totalError += errors[0] + errors[1] + errors[2] + errors[3];
+		}
+#else
+		for (int i = 0; i < 16; i++)
+		{
+			float bestError = FLT_MAX;
+			int bestIndex = 0;
+			for (int p = 0; p < palette.count; p++)
+			{
+				float error = 0.0f;
+				for (int c = 0; c < 4; c++)
+				{
+					float difference = block.channels[c][i] - palette.colors[p][c];
+					error += difference * difference * mask[c];
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices[i] = bestIndex;
+			totalError += bestError;
+		}
+#endif
+
+		return(totalError);
+	}
+
+	/***********************************************************
+	 *  ComputeEndpoints()
+	 *
+	 *  This function is used for picking the two colors that
+	 *  the palette of a block is interpolated between, using
+	 *  the first channelCount channels.  The fast way takes the
+	 *  corners of the bounding box.  Otherwise the pixels are
+	 *  projected onto the principal axis of the block, found by
+	 *  power iteration, and the extremes are taken.
+	 ***********************************************************/
+	void ComputeEndpoints(const PIXEL_BLOCK& block, int channelCount, TextureCompressor::COMPRESSION_QUALITY quality, float endpoint0[4], float endpoint1[4])
+	{
+		float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float maximum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int c = 0; c < 4; c++)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				minimum[c] = std::min(minimum[c], block.channels[c][i]);
+				maximum[c] = std::max(maximum[c], block.channels[c][i]);
+				mean[c] += block.channels[c][i];
+			}
+			mean[c] /= 16.0f;
+			endpoint0[c] = minimum[c];
+			endpoint1[c] = maximum[c];
+		}
+
+		if (quality == TextureCompressor::QUALITY_FAST)
+		{
+			return;
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int a = 0; a < channelCount; a++)
+			{
+				for (int b = 0; b < channelCount; b++)
+				{
+					covariance[a][b] += (block.channels[a][i] - mean[a]) * (block.channels[b][i] - mean[b]);
+				}
+			}
+		}
+
+		// start along the box diagonal, which is close already
+		float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] = maximum[c] - minimum[c];
+		}
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float length = 0.0f;
+			for (int a = 0; a < channelCount; a++)
+			{
+				for (int b = 0; b < channelCount; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length = std::max(length, fabsf(next[a]));
+			}
+			if (length < 1e-6f)
+			{
+				// a flat block, the box corners are exact
+				return;
+			}
+			for (int c = 0; c < channelCount; c++)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+
+		float axisLength = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			axisLength += axis[c] * axis[c];
+		}
+		float lowest = FLT_MAX;
+		float highest = -FLT_MAX;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channelCount; c++)
+			{
+				t += (block.channels[c][i] - mean[c]) * axis[c];
+			}
+			lowest = std::min(lowest, t);
+			highest = std::max(highest, t);
+		}
+		for (int c = 0; c < channelCount; c++)
+		{
+			endpoint0[c] = std::min(std::max(mean[c] + axis[c] * lowest / axisLength, 0.0f), 255.0f);
+			endpoint1[c] = std::min(std::max(mean[c] + axis[c] * highest / axisLength, 0.0f), 255.0f);
+		}
+	}
+
+	/***********************************************************
+	 *  RefineEndpoints()
+	 *
+	 *  This function is used for moving the endpoints to where
+	 *  they best fit the chosen palette indices, by solving the
+	 *  least squares problem of each channel.  Returns false
+	 *  when every pixel uses the same weight.
+	 ***********************************************************/
+	bool RefineEndpoints(const PIXEL_BLOCK& block, const BLOCK_PALETTE& palette, const int indices[16], int channelCount, float endpoint0[4], float endpoint1[4])
+	{
+		float alpha2 = 0.0f;
+		float beta2 = 0.0f;
+		float alphaBeta = 0.0f;
+		float alphaX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float betaX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++)
+		{
+			float beta = palette.weights[indices[i]];
+			float alpha = 1.0f - beta;
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			for (int c = 0; c < channelCount; c++)
+			{
+				alphaX[c] += alpha * block.channels[c][i];
+				betaX[c] += beta * block.channels[c][i];
+			}
+		}
+
+		float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (fabsf(determinant) < 1e-6f)
+		{
+			return(false);
+		}
+		for (int c = 0; c < channelCount; c++)
+		{
+			endpoint0[c] = std::min(std::max((alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+			endpoint1[c] = std::min(std::max((betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  Pack565()
+	 *
+	 *  This function is used for rounding a color to 5:6:5 bits.
+	 ***********************************************************/
+	unsigned int Pack565(const float color[4])
+	{
+		unsigned int r = (unsigned int)(color[0] * 31.0f / 255.0f + 0.5f);
+		unsigned int g = (unsigned int)(color[1] * 63.0f / 255.0f + 0.5f);
+		unsigned int b = (unsigned int)(color[2] * 31.0f / 255.0f + 0.5f);
+		return((r << 11) | (g << 5) | b);
+	}
+
+	/***********************************************************
+	 *  Unpack565()
+	 *
+	 *  This function is used for expanding a 5:6:5 color the
+	 *  way the GPU does.
+	 ***********************************************************/
+	void Unpack565(unsigned int packed, float color[4])
+	{
+		unsigned int r = (packed >> 11) & 31;
+		unsigned int g = (packed >> 5) & 63;
+		unsigned int b = packed & 31;
+		color[0] = (float)((r << 3) | (r >> 2));
+		color[1] = (float)((g << 2) | (g >> 4));
+		color[2] = (float)((b << 3) | (b >> 2));
+		color[3] = 255.0f;
+	}
+
+	/***********************************************************
+	 *  EvaluateColorBlock()
+	 *
+	 *  This function is used for quantizing a pair of color
+	 *  endpoints and choosing the four color palette indices.
+	 *  The larger color comes first, which selects four color
+	 *  mode in BC1.  Returns the squared error.
+	 ***********************************************************/
+	float EvaluateColorBlock(const PIXEL_BLOCK& block, const float endpoint0[4], const float endpoint1[4], unsigned int& color0, unsigned int& color1, BLOCK_PALETTE& palette, int indices[16])
+	{
+		static const float mask[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+
+		color0 = Pack565(endpoint1);
+		color1 = Pack565(endpoint0);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		Unpack565(color0, palette.colors[0]);
+		Unpack565(color1, palette.colors[1]);
+		for (int c = 0; c < 4; c++)
+		{
+			palette.colors[2][c] = (2.0f * palette.colors[0][c] + palette.colors[1][c]) / 3.0f;
+			palette.colors[3][c] = (palette.colors[0][c] + 2.0f * palette.colors[1][c]) / 3.0f;
+		}
+		palette.weights[0] = 0.0f;
+		palette.weights[1] = 1.0f;
+		palette.weights[2] = 1.0f / 3.0f;
+		palette.weights[3] = 2.0f / 3.0f;
+		// equal colors are three color mode, so only index 0
+		palette.count = (color0 == color1) ? 1 : 4;
+
+		return(FindClosestColors(block, palette, mask, indices));
+	}
+
+	/***********************************************************
+	 *  EncodeColorBlock()
+	 *
+	 *  This function is used for writing the 8 byte color block
+	 *  of BC1 and BC3.
+	 ***********************************************************/
+	void EncodeColorBlock(const PIXEL_BLOCK& block, TextureCompressor::COMPRESSION_QUALITY quality, unsigned char* pOutput)
+	{
+		float endpoint0[4];
+		float endpoint1[4];
+		ComputeEndpoints(block, 3, quality, endpoint0, endpoint1);
+
+		unsigned int color0 = 0;
+		unsigned int color1 = 0;
+		int indices[16];
+		BLOCK_PALETTE palette;
+		float error = EvaluateColorBlock(block, endpoint0, endpoint1, color0, color1, palette, indices);
+
+		for (int pass = 0; (quality == TextureCompressor::QUALITY_HIGH) && (pass < g_RefinePasses) && (error > 0.0f); pass++)
+		{
+			// the palette starts from color 0, the larger endpoint
+			float refined0[4];
+			float refined1[4];
+			if (RefineEndpoints(block, palette, indices, 3, refined1, refined0) == false)
+			{
+				break;
+			}
+
+			unsigned int refinedColor0 = 0;
+			unsigned int refinedColor1 = 0;
+			int refinedIndices[16];
+			BLOCK_PALETTE refinedPalette;
+			float refinedError = EvaluateColorBlock(block, refined0, refined1, refinedColor0, refinedColor1, refinedPalette, refinedIndices);
+			if (refinedError >= error)
+			{
+				break;
+			}
+			error = refinedError;
+			color0 = refinedColor0;
+			color1 = refinedColor1;
+			palette = refinedPalette;
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+
+		unsigned int bits = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			bits |= (unsigned int)indices[i] << (i * 2);
+		}
+
+		pOutput[0] = (unsigned char)(color0 & 0xFF);
+		pOutput[1] = (unsigned char)(color0 >> 8);
+		pOutput[2] = (unsigned char)(color1 & 0xFF);
+		pOutput[3] = (unsigned char)(color1 >> 8);
+		for (int i = 0; i < 4; i++)
+		{
+			pOutput[4 + i] = (unsigned char)(bits >> (i * 8));
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeAlphaBlock()
+	 *
+	 *  This function is used for writing the 8 byte alpha block
+	 *  of BC3, with eight alpha values between the extremes.
+	 ***********************************************************/
+	void EncodeAlphaBlock(const PIXEL_BLOCK& block, unsigned char* pOutput)
+	{
+		static const float mask[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+		float minimum = 255.0f;
+		float maximum = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			minimum = std::min(minimum, block.channels[3][i]);
+			maximum = std::max(maximum, block.channels[3][i]);
+		}
+
+		unsigned int alpha0 = (unsigned int)maximum;
+		unsigned int alpha1 = (unsigned int)minimum;
+
+		BLOCK_PALETTE palette;
+		memset(&palette, 0, sizeof(palette));
+		palette.colors[0][3] = (float)alpha0;
+		palette.colors[1][3] = (float)alpha1;
+		for (int i = 2; i < 8; i++)
+		{
+			palette.colors[i][3] = (float)(((8 - i) * alpha0 + (i - 1) * alpha1) / 7);
+		}
+		palette.count = (alpha0 == alpha1) ? 1 : 8;
+
+		int indices[16];
+		FindClosestColors(block, palette, mask, indices);
+
+		unsigned long long bits = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			bits |= (unsigned long long)indices[i] << (i * 3);
+		}
+
+		pOutput[0] = (unsigned char)alpha0;
+		pOutput[1] = (unsigned char)alpha1;
+		for (int i = 0; i < 6; i++)
+		{
+			pOutput[2 + i] = (unsigned char)(bits >> (i * 8));
+		}
+	}
+
+	/***********************************************************
+	 *  EvaluateBC7Block()
+	 *
+	 *  This function is used for quantizing a pair of RGBA
+	 *  endpoints to 7 bits and a shared low bit each, as BC7
+	 *  mode 6 stores them, and choosing the 16 palette indices.
+	 *  Returns the squared error.
+	 ***********************************************************/
+	float EvaluateBC7Block(const PIXEL_BLOCK& block, const float endpoint0[4], const float endpoint1[4], int pBit0, int pBit1, int quantized[2][4], BLOCK_PALETTE& palette, int indices[16])
+	{
+		static const float mask[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+		for (int c = 0; c < 4; c++)
+		{
+			quantized[0][c] = std::min(std::max((int)((endpoint0[c] - pBit0) / 2.0f + 0.5f), 0), 127);
+			quantized[1][c] = std::min(std::max((int)((endpoint1[c] - pBit1) / 2.0f + 0.5f), 0), 127);
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				int value0 = (quantized[0][c] << 1) | pBit0;
+				int value1 = (quantized[1][c] << 1) | pBit1;
+				palette.colors[i][c] = (float)(((64 - g_BC7Weights[i]) * value0 + g_BC7Weights[i] * value1 + 32) >> 6);
+			}
+			palette.weights[i] = g_BC7Weights[i] / 64.0f;
+		}
+		palette.count = 16;
+
+		return(FindClosestColors(block, palette, mask, indices));
+	}
+
+	/***********************************************************
+	 *  WriteBits()
+	 *
+	 *  This function is used for appending bits to a 128 bit
+	 *  block, lowest bit first.
+	 ***********************************************************/
+	void WriteBits(unsigned char* pOutput, int& position, unsigned int value, int count)
+	{
+		for (int i = 0; i < count; i++, position++)
+		{
+			if ((value >> i) & 1)
+			{
+				pOutput[position / 8] |= (unsigned char)(1 << (position % 8));
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeBC7Block()
+	 *
+	 *  This function is used for writing a 16 byte BC7 block in
+	 *  mode 6, which has one subset with RGBA endpoints and 4
+	 *  bit indices.  The fast way picks the low bits from the
+	 *  endpoints, and the others try all four pairs of them.
+	 ***********************************************************/
+	void EncodeBC7Block(const PIXEL_BLOCK& block, TextureCompressor::COMPRESSION_QUALITY quality, unsigned char* pOutput)
+	{
+		float endpoint0[4];
+		float endpoint1[4];
+		ComputeEndpoints(block, 4, quality, endpoint0, endpoint1);
+
+		int quantized[2][4];
+		int indices[16];
+		int pBits[2] = { 0, 0 };
+		float error = FLT_MAX;
+		BLOCK_PALETTE palette;
+
+		for (int pass = 0; pass <= ((quality == TextureCompressor::QUALITY_HIGH) ? g_RefinePasses : 0); pass++)
+		{
+			if (pass > 0)
+			{
+				float refined0[4];
+				float refined1[4];
+				if (RefineEndpoints(block, palette, indices, 4, refined0, refined1) == false)
+				{
+					break;
+				}
+				memcpy(endpoint0, refined0, sizeof(refined0));
+				memcpy(endpoint1, refined1, sizeof(refined1));
+			}
+
+			int pairCount = (quality == TextureCompressor::QUALITY_FAST) ? 1 : 4;
+			for (int pair = 0; pair < pairCount; pair++)
+			{
+				int pBit0 = pair & 1;
+				int pBit1 = pair >> 1;
+				if (quality == TextureCompressor::QUALITY_FAST)
+				{
+					// round the low bits from the average endpoint
+					pBit0 = ((int)((endpoint0[0] + endpoint0[1] + endpoint0[2] + endpoint0[3]) / 4.0f + 0.5f)) & 1;
+					pBit1 = ((int)((endpoint1[0] + endpoint1[1] + endpoint1[2] + endpoint1[3]) / 4.0f + 0.5f)) & 1;
+				}
+
+				int candidate[2][4];
+				int candidateIndices[16];
+				BLOCK_PALETTE candidatePalette;
+				float candidateError = EvaluateBC7Block(block, endpoint0, endpoint1, pBit0, pBit1, candidate, candidatePalette, candidateIndices);
+				if (candidateError < error)
+				{
+					error = candidateError;
+					pBits[0] = pBit0;
+					pBits[1] = pBit1;
+					memcpy(quantized, candidate, sizeof(candidate));
+					memcpy(indices, candidateIndices, sizeof(indices));
+					palette = candidatePalette;
+				}
+			}
+		}
+
+		// the first index is stored without its high bit, which
+		// must be 0, so the endpoints are swapped when it is not
+		if (indices[0] & 8)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				std::swap(quantized[0][c], quantized[1][c]);
+			}
+			std::swap(pBits[0], pBits[1]);
+			for (int i = 0; i < 16; i++)
+			{
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		memset(pOutput, 0, 16);
+		int position = 0;
+		// mode 6 is six 0 bits followed by a 1 bit
+		WriteBits(pOutput, position, 1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			WriteBits(pOutput, position, quantized[0][c], 7);
+			WriteBits(pOutput, position, quantized[1][c], 7);
+		}
+		WriteBits(pOutput, position, pBits[0], 1);
+		WriteBits(pOutput, position, pBits[1], 1);
+		WriteBits(pOutput, position, indices[0], 3);
+		for (int i = 1; i < 16; i++)
+		{
+			WriteBits(pOutput, position, indices[i], 4);
+		}
+	}
+}
+
+/***********************************************************
+ *  TextureCompressor()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCompressor::TextureCompressor(unsigned int threadCount)
+{
+	m_nextTile = 0;
+	m_finishedTiles = 0;
+	m_bStopRequested = false;
+
+	if (threadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads : 1;
+	}
+
+	// the calling thread encodes too
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&TextureCompressor::WorkerThread, this));
+	}
+}
+
+/***********************************************************
+ *  ~TextureCompressor()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureCompressor::~TextureCompressor()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopRequested = true;
+	}
+	m_workReady.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+/***********************************************************
+ *  Compress()
+ *
+ *  This method is used for encoding every level of texture
+ *  data.  OpenGL cannot generate the mipmaps of a compressed
+ *  texture, so data that only has level 0 should get its
+ *  other levels from the mip generator first, or the result
+ *  has no mipmaps either.  The levels are cut into tiles that
+ *  the worker threads and the calling thread encode, and the
+ *  call returns once all of them are done.  The result owns
+ *  the encoded blocks.
+ ***********************************************************/
+bool TextureCompressor::Compress(
+	const TEXTURE_DATA& source,
+	COMPRESSION_FORMAT format,
+	COMPRESSION_QUALITY quality,
+	TEXTURE_DATA& result)
+{
+	if ((source.pixelFormat != GL_RGB) && (source.pixelFormat != GL_RGBA))
+	{
+		printf("Only uncompressed RGB and RGBA textures can be compressed\n");
+		return(false);
+	}
+
+	int channels = (source.pixelFormat == GL_RGBA) ? 4 : 3;
+	GLenum internalFormat = GetInternalFormat(format, channels == 4);
+	size_t blockSize = GetCompressedBlockSize(internalFormat);
+
+	const std::vector<TEXTURE_LEVEL>& levels = source.levels;
+
+	// lay the levels out one after another in one buffer
+	std::vector<size_t> offsets;
+	size_t totalSize = 0;
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		offsets.push_back(totalSize);
+		totalSize += ((size_t)(levels[level].width + 3) / 4) * ((levels[level].height + 3) / 4) * blockSize;
+	}
+	std::shared_ptr<std::vector<unsigned char>> pBlocks = std::make_shared<std::vector<unsigned char>>(totalSize);
+
+	std::lock_guard<std::mutex> compressLock(m_compressMutex);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tiles.clear();
+		for (size_t level = 0; level < levels.size(); level++)
+		{
+			int blockRows = (levels[level].height + 3) / 4;
+			size_t blockRowSize = ((size_t)(levels[level].width + 3) / 4) * blockSize;
+			for (int firstRow = 0; firstRow < blockRows; firstRow += g_TileBlockRows)
+			{
+				COMPRESS_TILE tile;
+				tile.pixels = levels[level].pixels;
+				tile.width = levels[level].width;
+				tile.height = levels[level].height;
+				tile.channels = channels;
+				tile.firstBlockRow = firstRow;
+				tile.blockRowCount = std::min(g_TileBlockRows, blockRows - firstRow);
+				tile.pOutput = &(*pBlocks)[offsets[level] + firstRow * blockRowSize];
+				tile.internalFormat = internalFormat;
+				tile.quality = quality;
+				m_tiles.push_back(tile);
+			}
+		}
+		m_nextTile = 0;
+		m_finishedTiles = 0;
+	}
+	m_workReady.notify_all();
+
+	EncodeTiles();
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_tilesDone.wait(lock, [this]() { return(m_finishedTiles == m_tiles.size()); });
+		m_tiles.clear();
+		m_nextTile = 0;
+		m_finishedTiles = 0;
+	}
+
+	result.filename = source.filename;
+	result.width = source.width;
+	result.height = source.height;
+	result.internalFormat = internalFormat;
+	result.pixelFormat = 0;
+	result.bGenerateMipmaps = false;
+	result.levels.clear();
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		size_t size = ((level + 1 < levels.size()) ? offsets[level + 1] : totalSize) - offsets[level];
+		result.levels.push_back({ levels[level].width, levels[level].height, &(*pBlocks)[offsets[level]], size });
+	}
+	result.pOwner = pBlocks;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetInternalFormat()
+ *
+ *  This method is used for getting the internal format that
+ *  a compression format encodes into.  BC1 keeps no alpha.
+ ***********************************************************/
+GLenum TextureCompressor::GetInternalFormat(COMPRESSION_FORMAT format, bool bAlpha)
+{
+	switch (format)
+	{
+	case FORMAT_BC1:
+		return(GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+	case FORMAT_BC3:
+		return(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+	case FORMAT_BC7:
+		return(GL_COMPRESSED_RGBA_BPTC_UNORM);
+	default:
+		return(bAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+	}
+}
+
+/***********************************************************
+ *  IsFormatSupported()
+ *
+ *  This method is used for checking whether the OpenGL
+ *  context can sample a compression format.
+ ***********************************************************/
+bool TextureCompressor::IsFormatSupported(COMPRESSION_FORMAT format)
+{
+	if (format == FORMAT_BC7)
+	{
+		return((GLEW_ARB_texture_compression_bptc) || (GLEW_VERSION_4_2));
+	}
+
+	return(GLEW_EXT_texture_compression_s3tc != GL_FALSE);
+}
+
+/***********************************************************
+ *  EncodeTiles()
+ *
+ *  This method is used for taking tiles off the current
+ *  batch and encoding them until none are left.
+ ***********************************************************/
+void TextureCompressor::EncodeTiles()
+{
+	for (;;)
+	{
+		COMPRESS_TILE tile;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_nextTile >= m_tiles.size())
+			{
+				return;
+			}
+			tile = m_tiles[m_nextTile];
+			m_nextTile++;
+		}
+
+		EncodeTile(tile);
+
+		bool bLastTile = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finishedTiles++;
+			bLastTile = (m_finishedTiles == m_tiles.size());
+		}
+		if (bLastTile)
+		{
+			m_tilesDone.notify_all();
+		}
+	}
+}
+
+/***********************************************************
+ *  EncodeTile()
+ *
+ *  This method is used for encoding the blocks of a tile, row
+ *  by row, into the output of the tile.
+ ***********************************************************/
+void TextureCompressor::EncodeTile(const COMPRESS_TILE& tile)
+{
+	int blocksPerRow = (tile.width + 3) / 4;
+	size_t blockSize = GetCompressedBlockSize(tile.internalFormat);
+	unsigned char* pOutput = tile.pOutput;
+
+	PIXEL_BLOCK block;
+	for (int blockY = tile.firstBlockRow; blockY < tile.firstBlockRow + tile.blockRowCount; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksPerRow; blockX++)
+		{
+			FetchBlock(tile.pixels, tile.width, tile.height, tile.channels, blockX, blockY, block);
+
+			switch (tile.internalFormat)
+			{
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+				EncodeAlphaBlock(block, pOutput);
+				EncodeColorBlock(block, tile.quality, pOutput + 8);
+				break;
+			case GL_COMPRESSED_RGBA_BPTC_UNORM:
+				EncodeBC7Block(block, tile.quality, pOutput);
+				break;
+			default:
+				EncodeColorBlock(block, tile.quality, pOutput);
+				break;
+			}
+			pOutput += blockSize;
+		}
+	}
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method is the main loop of a worker thread, which
+ *  helps with each batch of tiles as it is queued.
+ ***********************************************************/
+void TextureCompressor::WorkerThread()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workReady.wait(lock, [this]() { return(m_bStopRequested || (m_nextTile < m_tiles.size())); });
+			if (m_bStopRequested)
+			{
+				return;
+			}
+		}
+
+		EncodeTiles();
+	}
+}
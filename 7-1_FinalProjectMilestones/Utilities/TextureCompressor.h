@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.h
+// ============
+// block compress texture data into BC1, BC3 or BC7 on worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureData.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/***********************************************************
+ *  TextureCompressor
+ *
+ *  This class encodes uncompressed texture data into block
+ *  compressed formats, so textures that have no cooked file
+ *  take a quarter to an eighth of the video memory.  Every
+ *  mipmap level is cut into tiles of block rows, and the
+ *  tiles are encoded in parallel by a pool of worker threads
+ *  along with the calling thread.  The palette searches use
+ *  SSE2 when it is available.
+ ***********************************************************/
+class TextureCompressor
+{
+public:
+	// the block compressed formats
+	enum COMPRESSION_FORMAT
+	{
+		// BC1 for RGB textures and BC3 for RGBA textures
+		FORMAT_AUTO,
+		FORMAT_BC1,
+		FORMAT_BC3,
+		FORMAT_BC7
+	};
+
+	// the quality and speed tradeoff of the encoder
+	enum COMPRESSION_QUALITY
+	{
+		// endpoints from the bounding box of each block
+		QUALITY_FAST,
+		// endpoints along the principal axis of each block
+		QUALITY_NORMAL,
+		// principal axis endpoints refined by least squares
+		QUALITY_HIGH
+	};
+
+	// constructor - a thread count of 0 uses one thread for
+	// each hardware thread, leaving one for the main thread
+	TextureCompressor(unsigned int threadCount = 0);
+	// destructor
+	~TextureCompressor();
+
+	// encode every level of uncompressed texture data - the
+	// mipmaps are not generated, so the data should have them
+	bool Compress(
+		const TEXTURE_DATA& source,
+		COMPRESSION_FORMAT format,
+		COMPRESSION_QUALITY quality,
+		TEXTURE_DATA& result);
+
+	// get the internal format that a format encodes into
+	static GLenum GetInternalFormat(COMPRESSION_FORMAT format, bool bAlpha);
+	// check whether OpenGL can sample a format
+	static bool IsFormatSupported(COMPRESSION_FORMAT format);
+
+	// get the number of threads that encode, including the
+	// calling thread
+	inline unsigned int GetThreadCount() const
+	{
+		return((unsigned int)m_threads.size() + 1);
+	}
+
+private:
+	// a band of block rows in one level
+	struct COMPRESS_TILE
+	{
+		const unsigned char* pixels;
+		int width;
+		int height;
+		int channels;
+		int firstBlockRow;
+		int blockRowCount;
+		// where the first block row is written
+		unsigned char* pOutput;
+		GLenum internalFormat;
+		COMPRESSION_QUALITY quality;
+	};
+
+	// the worker threads
+	std::vector<std::thread> m_threads;
+	// guards the tiles and the counters
+	std::mutex m_mutex;
+	// only one batch of tiles is encoded at a time
+	std::mutex m_compressMutex;
+	// signals the workers that there are tiles, or that they
+	// should exit
+	std::condition_variable m_workReady;
+	// signals the caller that the last tile was encoded
+	std::condition_variable m_tilesDone;
+	// the tiles of the current batch
+	std::vector<COMPRESS_TILE> m_tiles;
+	// index of the next tile to encode
+	size_t m_nextTile;
+	// number of tiles that are encoded
+	size_t m_finishedTiles;
+	// set when the workers should exit
+	bool m_bStopRequested;
+
+	// encode the tiles until none are left
+	void EncodeTiles();
+	// encode the blocks of one tile
+	static void EncodeTile(const COMPRESS_TILE& tile);
+	// the main loop of a worker thread
+	void WorkerThread();
+};
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedata.h
+// ============
+// pixel data of a texture that is ready to be uploaded
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <string>
+#include <vector>
+#include <memory>
+
+// the pixels of one mipmap level
+struct TEXTURE_LEVEL
+{
+	int width;
+	int height;
+	const unsigned char* pixels;
+	size_t size;
+};
+
+// the pixel data of a texture, with only level 0 or with every
+// mipmap level, from a decoded image or from a cooked file
+struct TEXTURE_DATA
+{
+	std::string filename;
+	int width;
+	int height;
+	// sized format of the texture storage
+	GLenum internalFormat;
+	// GL_RGB or GL_RGBA for uncompressed pixels, or 0 when the
+	// pixels are compressed in the internal format
+	GLenum pixelFormat;
+	std::vector<TEXTURE_LEVEL> levels;
+	// whether the levels below the given ones must be generated
+	bool bGenerateMipmaps;
+	// keeps the memory of the pixels alive while it is in use
+	std::shared_ptr<const void> pOwner;
+};
+
+/***********************************************************
+ *  GetMipLevelCount()
+ *
+ *  This function is used for getting the number of levels in
+ *  a full mipmap chain, down to 1x1.
+ ***********************************************************/
+inline int GetMipLevelCount(int width, int height)
+{
+	int levels = 1;
+	for (int size = (width > height) ? width : height; size > 1; size /= 2)
+	{
+		levels++;
+	}
+	return(levels);
+}
+
+/***********************************************************
+ *  GetCompressedBlockSize()
+ *
+ *  This function is used for getting the bytes in one 4x4
+ *  block of a block compressed format, or 0 for formats that
+ *  are not block compressed.
+ ***********************************************************/
+inline size_t GetCompressedBlockSize(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		return(8);
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		return(16);
+	default:
+		return(0);
+	}
+}
+
+/***********************************************************
+ *  GetTextureRowSize()
+ *
+ *  This function is used for getting the bytes in one row of
+ *  a level - a row of pixels, or a row of 4x4 blocks for the
+ *  block compressed formats.
+ ***********************************************************/
+inline size_t GetTextureRowSize(const TEXTURE_DATA& data, int width)
+{
+	size_t blockSize = GetCompressedBlockSize(data.internalFormat);
+	if (blockSize > 0)
+	{
+		return(((size_t)(width + 3) / 4) * blockSize);
+	}
+	return((size_t)width * ((data.pixelFormat == GL_RGBA) ? 4 : 3));
+}
+
+/***********************************************************
+ *  GetTextureRowHeight()
+ *
+ *  This function is used for getting the number of pixel
+ *  rows in one row of a level.
+ ***********************************************************/
+inline int GetTextureRowHeight(const TEXTURE_DATA& data)
+{
+	return((GetCompressedBlockSize(data.internalFormat) > 0) ? 4 : 1);
+}
@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedecoder.cpp
+// ============
+// decode texture image files on a pool of worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureDecoder.h"
+
+#include "stb_image.h"
+
+#include <stdio.h>
+
+/***********************************************************
+ *  TextureDecoder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureDecoder::TextureDecoder(unsigned int threadCount)
+{
+	m_firstTicket = 0;
+	m_bStopRequested = false;
+
+	if (threadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&TextureDecoder::WorkerThread, this));
+	}
+}
+
+/***********************************************************
+ *  ~TextureDecoder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureDecoder::~TextureDecoder()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopRequested = true;
+	}
+	m_workReady.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+
+	// free the images that were never taken
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		FreeImage(m_requests[i].image);
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing an image file to be
+ *  decoded by the next free worker thread.  The returned
+ *  ticket is passed to WaitForImage() to get the pixels.
+ ***********************************************************/
+int TextureDecoder::Submit(const std::string& filename, bool bFlipVertically)
+{
+	DECODE_REQUEST request;
+	request.image.filename = filename;
+	request.image.width = 0;
+	request.image.height = 0;
+	request.image.colorChannels = 0;
+	request.image.pixels = NULL;
+	request.bFlipVertically = bFlipVertically;
+	request.bDecoded = false;
+	request.bTaken = false;
+
+	int ticket = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ticket = m_firstTicket + (int)m_requests.size();
+		m_requests.push_back(request);
+		m_workQueue.push_back(ticket);
+	}
+	m_workReady.notify_one();
+
+	return(ticket);
+}
+
+/***********************************************************
+ *  WaitForImage()
+ *
+ *  This method is used for waiting until the image of a
+ *  ticket is decoded, and taking its pixels.  Each ticket can
+ *  be taken once.  Returns false when the ticket is unknown
+ *  or the file could not be decoded.
+ ***********************************************************/
+bool TextureDecoder::WaitForImage(int ticket, DECODED_IMAGE& image)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	int index = ticket - m_firstTicket;
+	if ((index < 0) || (index >= (int)m_requests.size()) || (m_requests[index].bTaken))
+	{
+		return(false);
+	}
+
+	m_imageReady.wait(lock, [this, ticket]() { return(m_requests[ticket - m_firstTicket].bDecoded); });
+
+	DECODE_REQUEST& request = m_requests[ticket - m_firstTicket];
+	image = request.image;
+	request.image.pixels = NULL;
+	request.bTaken = true;
+
+	// drop the taken requests from the front of the list
+	while ((!m_requests.empty()) && (m_requests.front().bTaken))
+	{
+		m_requests.pop_front();
+		m_firstTicket++;
+	}
+
+	return(image.pixels != NULL);
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used for freeing the pixels of a decoded
+ *  image.
+ ***********************************************************/
+void TextureDecoder::FreeImage(DECODED_IMAGE& image)
+{
+	if (image.pixels != NULL)
+	{
+		stbi_image_free(image.pixels);
+		image.pixels = NULL;
+	}
+}
+
+/***********************************************************
+ *  TakeTextureData()
+ *
+ *  This method is used for moving the pixels of a decoded
+ *  image into texture data with only level 0, whose other
+ *  levels are generated once it is uploaded.  The image is
+ *  left without its pixels, which are freed along with the
+ *  last copy of the texture data.
+ ***********************************************************/
+bool TextureDecoder::TakeTextureData(DECODED_IMAGE& image, TEXTURE_DATA& data)
+{
+	if ((image.pixels == NULL) || ((image.colorChannels != 3) && (image.colorChannels != 4)))
+	{
+		return(false);
+	}
+
+	data.filename = image.filename;
+	data.width = image.width;
+	data.height = image.height;
+	data.internalFormat = (image.colorChannels == 4) ? GL_RGBA8 : GL_RGB8;
+	data.pixelFormat = (image.colorChannels == 4) ? GL_RGBA : GL_RGB;
+	data.levels.clear();
+	data.levels.push_back({ image.width, image.height, image.pixels, (size_t)image.width * image.height * image.colorChannels });
+	data.bGenerateMipmaps = true;
+	data.pOwner = std::shared_ptr<const void>(image.pixels, [](const void* pixels) { stbi_image_free((void*)pixels); });
+
+	image.pixels = NULL;
+
+	return(true);
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method is the main loop of a worker thread.  The
+ *  files are decoded without the lock held, so the workers
+ *  decode in parallel.  The flip setting of stb_image is
+ *  set per thread, since the global one would be shared by
+ *  every worker.
+ ***********************************************************/
+void TextureDecoder::WorkerThread()
+{
+	for (;;)
+	{
+		std::string filename;
+		bool bFlipVertically = false;
+		int ticket = 0;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workReady.wait(lock, [this]() { return(m_bStopRequested || !m_workQueue.empty()); });
+			if (m_bStopRequested)
+			{
+				return;
+			}
+
+			ticket = m_workQueue.front();
+			m_workQueue.pop_front();
+			filename = m_requests[ticket - m_firstTicket].image.filename;
+			bFlipVertically = m_requests[ticket - m_firstTicket].bFlipVertically;
+		}
+
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		stbi_set_flip_vertically_on_load_thread(bFlipVertically ? 1 : 0);
+		unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &colorChannels, 0);
+		if (pixels == NULL)
+		{
+			printf("Could not decode image %s: %s\n", filename.c_str(), stbi_failure_reason());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			DECODE_REQUEST& request = m_requests[ticket - m_firstTicket];
+			request.image.width = width;
+			request.image.height = height;
+			request.image.colorChannels = colorChannels;
+			request.image.pixels = pixels;
+			request.bDecoded = true;
+		}
+		m_imageReady.notify_all();
+	}
+}
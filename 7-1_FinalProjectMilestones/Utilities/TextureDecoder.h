@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedecoder.h
+// ============
+// decode texture image files on a pool of worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureData.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/***********************************************************
+ *  TextureDecoder
+ *
+ *  This class decodes JPEG and PNG files into pixel data on
+ *  a pool of worker threads.  Each submitted file gets a
+ *  ticket, and the decoded images are handed back by ticket,
+ *  so the caller can upload them to OpenGL on its own thread
+ *  in the order they were submitted, while the files behind
+ *  them are still being decoded.
+ ***********************************************************/
+class TextureDecoder
+{
+public:
+	// pixel data of a decoded image file
+	struct DECODED_IMAGE
+	{
+		std::string filename;
+		int width;
+		int height;
+		int colorChannels;
+		// the pixels, or NULL when the file could not be decoded
+		unsigned char* pixels;
+	};
+
+	// constructor - a thread count of 0 uses one thread for
+	// each hardware thread, leaving one for the main thread
+	TextureDecoder(unsigned int threadCount = 0);
+	// destructor
+	~TextureDecoder();
+
+	// queue an image file for decoding - returns its ticket
+	int Submit(const std::string& filename, bool bFlipVertically);
+	// wait for the image of a ticket to be decoded and take it -
+	// the pixels must be freed with FreeImage()
+	bool WaitForImage(int ticket, DECODED_IMAGE& image);
+	// free the pixels of a decoded image
+	static void FreeImage(DECODED_IMAGE& image);
+	// move the pixels of a decoded RGB or RGBA image into
+	// texture data - returns false for other images
+	static bool TakeTextureData(DECODED_IMAGE& image, TEXTURE_DATA& data);
+
+	// get the number of worker threads
+	inline unsigned int GetThreadCount() const
+	{
+		return((unsigned int)m_threads.size());
+	}
+
+private:
+	// properties for a submitted image file
+	struct DECODE_REQUEST
+	{
+		DECODED_IMAGE image;
+		bool bFlipVertically;
+		bool bDecoded;
+		bool bTaken;
+	};
+
+	// the worker threads
+	std::vector<std::thread> m_threads;
+	// guards the requests and the work queue
+	std::mutex m_mutex;
+	// signals the workers that there is work, or that they
+	// should exit
+	std::condition_variable m_workReady;
+	// signals the waiting caller that an image was decoded
+	std::condition_variable m_imageReady;
+	// the submitted requests that have not been taken, indexed
+	// by ticket minus the ticket of the first one
+	std::deque<DECODE_REQUEST> m_requests;
+	// ticket of the first request in the list
+	int m_firstTicket;
+	// tickets waiting for a worker, in submit order
+	std::deque<int> m_workQueue;
+	// set when the workers should exit
+	bool m_bStopRequested;
+
+	// the main loop of a worker thread
+	void WorkerThread();
+};
@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureregistry.cpp
+// ============
+// look up loaded textures by tag and share them by file contents
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureRegistry.h"
+
+#include <stdio.h>
+
+namespace
+{
+	// the 64 bit FNV-1a constants
+	const uint64_t g_HashOffsetBasis = 14695981039346656037ULL;
+	const uint64_t g_HashPrime = 1099511628211ULL;
+	// bytes read from a file at a time while hashing
+	const size_t g_HashChunkSize = 64 * 1024;
+}
+
+/***********************************************************
+ *  TextureRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureRegistry::TextureRegistry()
+{
+}
+
+/***********************************************************
+ *  InternTag()
+ *
+ *  This method is used for getting the integer of a tag.  A
+ *  new tag gets the next integer and refers to no texture.
+ ***********************************************************/
+int TextureRegistry::InternTag(const std::string& tag)
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_tags.find(tag);
+	if (found != m_tags.end())
+	{
+		return(found->second);
+	}
+
+	int tagID = (int)m_tagTextures.size();
+	m_tags[tag] = tagID;
+	m_tagTextures.push_back(-1);
+
+	return(tagID);
+}
+
+/***********************************************************
+ *  FindTag()
+ *
+ *  This method is used for getting the integer of a tag
+ *  without adding it.
+ ***********************************************************/
+int TextureRegistry::FindTag(const std::string& tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_tags.find(tag);
+	return((found != m_tags.end()) ? found->second : -1);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture that is about to
+ *  be loaded, reusing a free entry when there is one.  The
+ *  texture has no references until a tag is bound to it.
+ ***********************************************************/
+int TextureRegistry::AddTexture(uint64_t contentHash, const std::string& filename)
+{
+	TEXTURE_ENTRY entry;
+	entry.contentHash = contentHash;
+	entry.filename = filename;
+	entry.arrayIndex = -1;
+	entry.layer = 0;
+	entry.atlasRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	entry.refCount = 0;
+	entry.bLoaded = false;
+
+	int texture = 0;
+	if (!m_freeTextures.empty())
+	{
+		texture = m_freeTextures.back();
+		m_freeTextures.pop_back();
+		m_textures[texture] = entry;
+	}
+	else
+	{
+		texture = (int)m_textures.size();
+		m_textures.push_back(entry);
+	}
+
+	if (contentHash != 0)
+	{
+		m_contents[contentHash] = texture;
+	}
+
+	return(texture);
+}
+
+/***********************************************************
+ *  FindContent()
+ *
+ *  This method is used for finding a texture that was loaded,
+ *  or is being loaded, from a file with the same contents.
+ ***********************************************************/
+int TextureRegistry::FindContent(uint64_t contentHash) const
+{
+	if (contentHash == 0)
+	{
+		return(-1);
+	}
+
+	std::unordered_map<uint64_t, int>::const_iterator found = m_contents.find(contentHash);
+	return((found != m_contents.end()) ? found->second : -1);
+}
+
+/***********************************************************
+ *  SetLoaded()
+ *
+ *  This method is used for recording where a texture was
+ *  stored once it is created.
+ ***********************************************************/
+void TextureRegistry::SetLoaded(int texture, int arrayIndex, int layer, const glm::vec4& atlasRect)
+{
+	m_textures[texture].arrayIndex = arrayIndex;
+	m_textures[texture].layer = layer;
+	m_textures[texture].atlasRect = atlasRect;
+	m_textures[texture].bLoaded = true;
+}
+
+/***********************************************************
+ *  BindTag()
+ *
+ *  This method is used for pointing a tag at a texture.  The
+ *  texture gains a reference, and the texture that the tag
+ *  referred to before loses one.
+ ***********************************************************/
+int TextureRegistry::BindTag(int tag, int texture)
+{
+	int previous = m_tagTextures[tag];
+	if (previous == texture)
+	{
+		return(-1);
+	}
+
+	m_tagTextures[tag] = texture;
+	if (texture >= 0)
+	{
+		m_textures[texture].refCount++;
+	}
+
+	if ((previous >= 0) && (ReleaseTexture(previous)))
+	{
+		return(previous);
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  ReleaseTag()
+ *
+ *  This method is used for letting go of the texture of a
+ *  tag.  When that was the last reference, the handle of the
+ *  texture is returned, and its entry still tells where the
+ *  texture was stored, until it is reused.
+ ***********************************************************/
+int TextureRegistry::ReleaseTag(int tag)
+{
+	if ((tag < 0) || (tag >= (int)m_tagTextures.size()))
+	{
+		return(-1);
+	}
+
+	return(BindTag(tag, -1));
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting every tag and texture,
+ *  once the textures themselves are freed.
+ ***********************************************************/
+void TextureRegistry::Clear()
+{
+	m_tags.clear();
+	m_tagTextures.clear();
+	m_textures.clear();
+	m_freeTextures.clear();
+	m_contents.clear();
+}
+
+/***********************************************************
+ *  ReleaseTexture()
+ *
+ *  This method is used for dropping a reference to a texture.
+ *  The last reference frees the entry for reuse and forgets
+ *  its file contents.
+ ***********************************************************/
+bool TextureRegistry::ReleaseTexture(int texture)
+{
+	TEXTURE_ENTRY& entry = m_textures[texture];
+	entry.refCount--;
+	if (entry.refCount > 0)
+	{
+		return(false);
+	}
+
+	std::unordered_map<uint64_t, int>::iterator found = m_contents.find(entry.contentHash);
+	if ((found != m_contents.end()) && (found->second == texture))
+	{
+		m_contents.erase(found);
+	}
+	entry.refCount = 0;
+	m_freeTextures.push_back(texture);
+
+	return(true);
+}
+
+/***********************************************************
+ *  HashBytes()
+ *
+ *  This method is used for hashing a block of memory.
+ ***********************************************************/
+uint64_t TextureRegistry::HashBytes(const void* pData, size_t size)
+{
+	const unsigned char* pBytes = (const unsigned char*)pData;
+	uint64_t hash = g_HashOffsetBasis;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ pBytes[i]) * g_HashPrime;
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  HashFile()
+ *
+ *  This method is used for hashing the contents of a file,
+ *  a chunk at a time.
+ ***********************************************************/
+uint64_t TextureRegistry::HashFile(const std::string& path)
+{
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if (pFile == NULL)
+	{
+		return(0);
+	}
+
+	std::vector<unsigned char> chunk(g_HashChunkSize);
+	uint64_t hash = g_HashOffsetBasis;
+	size_t readSize = 0;
+	while ((readSize = fread(&chunk[0], 1, chunk.size(), pFile)) > 0)
+	{
+		for (size_t i = 0; i < readSize; i++)
+		{
+			hash = (hash ^ chunk[i]) * g_HashPrime;
+		}
+	}
+	fclose(pFile);
+
+	return(hash);
+}
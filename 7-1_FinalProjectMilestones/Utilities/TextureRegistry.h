@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureregistry.h
+// ============
+// look up loaded textures by tag and share them by file contents
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/***********************************************************
+ *  TextureRegistry
+ *
+ *  This class keeps track of the loaded textures.  Each tag
+ *  is interned into an integer, and refers to a texture by
+ *  its handle, which indexes the textures directly, so a draw
+ *  finds its texture without comparing strings.  Textures are
+ *  also found by a hash of their file contents, so the same
+ *  image under several tags or file names is loaded once.
+ *  Every tag that refers to a texture holds a reference to
+ *  it, and the texture is freed when the last one goes away.
+ ***********************************************************/
+class TextureRegistry
+{
+public:
+	// properties for a registered texture
+	struct TEXTURE_ENTRY
+	{
+		// hash of the file contents, or 0 when unknown
+		uint64_t contentHash;
+		std::string filename;
+		// the texture array that holds the texture, once loaded
+		int arrayIndex;
+		int layer;
+		// the rectangle of the texture in its layer, as an offset
+		// and a scale in texture coordinates - the whole layer
+		// unless the texture is packed into an atlas page
+		glm::vec4 atlasRect;
+		// number of tags that refer to the texture, 0 for a free
+		// entry
+		int refCount;
+		bool bLoaded;
+	};
+
+	// constructor
+	TextureRegistry();
+
+	// get the integer for a tag, adding it when it is new
+	int InternTag(const std::string& tag);
+	// get the integer for a tag, or -1 when it is not known
+	int FindTag(const std::string& tag) const;
+
+	// add a texture that is not loaded yet - returns its handle
+	int AddTexture(uint64_t contentHash, const std::string& filename);
+	// find a texture by the hash of its file contents - returns
+	// its handle, or -1
+	int FindContent(uint64_t contentHash) const;
+	// set where a texture was loaded
+	void SetLoaded(int texture, int arrayIndex, int layer, const glm::vec4& atlasRect);
+
+	// point a tag at a texture, releasing the texture the tag
+	// referred to before - returns the handle of a texture that
+	// lost its last reference and must be freed, or -1
+	int BindTag(int tag, int texture);
+	// let go of the texture of a tag - returns the handle of the
+	// texture when that was its last reference, or -1
+	int ReleaseTag(int tag);
+	// free every texture and forget every tag
+	void Clear();
+
+	// get the texture handle of a tag, or -1
+	inline int GetTagTexture(int tag) const
+	{
+		return(((tag >= 0) && (tag < (int)m_tagTextures.size())) ? m_tagTextures[tag] : -1);
+	}
+	// get a texture by its handle
+	inline const TEXTURE_ENTRY& GetTexture(int texture) const
+	{
+		return(m_textures[texture]);
+	}
+	// get the number of textures that are in use
+	inline int GetTextureCount() const
+	{
+		return((int)(m_textures.size() - m_freeTextures.size()));
+	}
+
+	// hash a block of memory, with 64 bit FNV-1a
+	static uint64_t HashBytes(const void* pData, size_t size);
+	// hash the contents of a file - returns 0 when it cannot be
+	// read
+	static uint64_t HashFile(const std::string& path);
+
+private:
+	// the integer of each tag
+	std::unordered_map<std::string, int> m_tags;
+	// the texture handle of each tag integer, or -1
+	std::vector<int> m_tagTextures;
+	// the textures, indexed by handle
+	std::vector<TEXTURE_ENTRY> m_textures;
+	// handles of the free entries, for reuse
+	std::vector<int> m_freeTextures;
+	// the handle of each known file content hash
+	std::unordered_map<uint64_t, int> m_contents;
+
+	// drop a reference to a texture, freeing its entry when it
+	// was the last - returns true when it was freed
+	bool ReleaseTexture(int texture);
+};
@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.cpp
+// ============
+// keep the texture levels that the view needs within a video memory budget
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureResidency.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#include <algorithm>
+
+/***********************************************************
+ *  TextureResidency()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureResidency::TextureResidency(
+	TextureArraySet* pTextureArrays,
+	TextureUploader* pUploader,
+	size_t budgetBytes)
+{
+	m_pTextureArrays = pTextureArrays;
+	m_pUploader = pUploader;
+	m_budgetBytes = budgetBytes;
+	m_frame = 0;
+	m_pendingRequests = 0;
+	m_evictionCount = 0;
+	m_loadCount = 0;
+}
+
+/***********************************************************
+ *  SetBudget()
+ *
+ *  This method is used for setting the most bytes that the
+ *  stored texture levels may take.  A smaller budget evicts
+ *  levels on the next update.
+ ***********************************************************/
+void TextureResidency::SetBudget(size_t budgetBytes)
+{
+	m_budgetBytes = budgetBytes;
+}
+
+/***********************************************************
+ *  RequestLevel()
+ *
+ *  This method is used for recording that an array is drawn
+ *  and needs the passed in level.  The most detailed level
+ *  requested by the draws of a frame is kept.
+ ***********************************************************/
+void TextureResidency::RequestLevel(int arrayIndex, int level)
+{
+	if (arrayIndex < 0)
+	{
+		return;
+	}
+	if (arrayIndex >= (int)m_usage.size())
+	{
+		m_usage.resize(arrayIndex + 1, ARRAY_USAGE{ -1, 0, 0 });
+	}
+
+	ARRAY_USAGE& usage = m_usage[arrayIndex];
+	if ((usage.requestedLevel < 0) || (level < usage.requestedLevel))
+	{
+		usage.requestedLevel = level;
+	}
+	usage.lastUsedFrame = m_frame;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for streaming the arrays towards the
+ *  levels requested since the last update.  The arrays that
+ *  finished streaming take over their new storage first.
+ *  Then each array that needs more detail gets it, as long
+ *  as the budget allows after evicting the levels that were
+ *  used least recently, or otherwise the most detailed level
+ *  that still fits.  An array that is streaming keeps its
+ *  request until the levels it is waiting for are in, so a
+ *  moving view does not restart its uploads every frame.
+ ***********************************************************/
+bool TextureResidency::Update()
+{
+	bool bChanged = (m_pTextureArrays->FinishResidentLevels(m_pUploader) > 0);
+
+	int arrayCount = m_pTextureArrays->GetArrayCount();
+	if ((int)m_usage.size() < arrayCount)
+	{
+		m_usage.resize(arrayCount, ARRAY_USAGE{ -1, 0, 0 });
+	}
+
+	// the budget is counted for the levels that the arrays are
+	// streamed towards
+	size_t committedBytes = 0;
+	for (int i = 0; i < arrayCount; i++)
+	{
+		if (m_pTextureArrays->IsStreamable(i) == false)
+		{
+			continue;
+		}
+		int pendingLevel = m_pTextureArrays->GetPendingLevel(i);
+		m_usage[i].targetLevel = (pendingLevel >= 0) ? pendingLevel : m_pTextureArrays->GetResidentLevel(i);
+		committedBytes += m_pTextureArrays->GetStorageSize(i, m_usage[i].targetLevel);
+	}
+
+	m_pendingRequests = 0;
+	for (int i = 0; i < arrayCount; i++)
+	{
+		ARRAY_USAGE& usage = m_usage[i];
+		if ((m_pTextureArrays->IsStreamable(i) == false) || (usage.requestedLevel < 0))
+		{
+			continue;
+		}
+
+		int requestedLevel = std::min(usage.requestedLevel, m_pTextureArrays->GetLevelCount(i) - 1);
+		if (requestedLevel >= usage.targetLevel)
+		{
+			continue;
+		}
+		if (m_pTextureArrays->GetPendingLevel(i) >= 0)
+		{
+			m_pendingRequests++;
+			continue;
+		}
+
+		size_t currentBytes = m_pTextureArrays->GetStorageSize(i, usage.targetLevel);
+		int level = requestedLevel;
+		while ((level < usage.targetLevel) &&
+			(committedBytes - currentBytes + m_pTextureArrays->GetStorageSize(i, level) > m_budgetBytes))
+		{
+			int victim = FindEvictionVictim(i);
+			if (victim < 0)
+			{
+				// nothing else can be evicted, so the array gets the
+				// most detailed level that fits
+				level++;
+				continue;
+			}
+
+			committedBytes -= m_pTextureArrays->GetStorageSize(victim, m_usage[victim].targetLevel);
+			m_usage[victim].targetLevel++;
+			committedBytes += m_pTextureArrays->GetStorageSize(victim, m_usage[victim].targetLevel);
+			m_evictionCount++;
+		}
+
+		if (level < usage.targetLevel)
+		{
+			committedBytes = committedBytes - currentBytes + m_pTextureArrays->GetStorageSize(i, level);
+			m_loadCount += usage.targetLevel - level;
+			usage.targetLevel = level;
+		}
+		if (level > requestedLevel)
+		{
+			m_pendingRequests++;
+		}
+	}
+
+	// a smaller budget evicts levels even without new requests
+	while (committedBytes > m_budgetBytes)
+	{
+		int victim = FindEvictionVictim(-1);
+		if (victim < 0)
+		{
+			break;
+		}
+
+		committedBytes -= m_pTextureArrays->GetStorageSize(victim, m_usage[victim].targetLevel);
+		m_usage[victim].targetLevel++;
+		committedBytes += m_pTextureArrays->GetStorageSize(victim, m_usage[victim].targetLevel);
+		m_evictionCount++;
+	}
+
+	for (int i = 0; i < arrayCount; i++)
+	{
+		if (m_pTextureArrays->IsStreamable(i))
+		{
+			int pendingLevel = m_pTextureArrays->GetPendingLevel(i);
+			int currentLevel = (pendingLevel >= 0) ? pendingLevel : m_pTextureArrays->GetResidentLevel(i);
+			if (m_usage[i].targetLevel != currentLevel)
+			{
+				int residentLevel = m_pTextureArrays->GetResidentLevel(i);
+				m_pTextureArrays->SetResidentLevel(i, m_usage[i].targetLevel, m_pUploader);
+				bChanged = (bChanged) || (m_pTextureArrays->GetResidentLevel(i) != residentLevel);
+			}
+		}
+		m_usage[i].requestedLevel = -1;
+	}
+	m_frame++;
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  LogStats()
+ *
+ *  This method is used for printing the bytes of the stored
+ *  levels against the budget, with the request and eviction
+ *  counters.
+ ***********************************************************/
+void TextureResidency::LogStats() const
+{
+	printf("Texture residency: %.1f of %.1f MB resident, %d pending requests, %u levels evicted, %u levels streamed in\n",
+		GetResidentBytes() / (1024.0 * 1024.0),
+		m_budgetBytes / (1024.0 * 1024.0),
+		m_pendingRequests,
+		m_evictionCount,
+		m_loadCount);
+}
+
+/***********************************************************
+ *  GetRequiredLevel()
+ *
+ *  This method is used for getting the most detailed level
+ *  that the sampler reads for a texture stretched over the
+ *  passed in number of pixels.  Each level halves the size,
+ *  so the level is the number of halvings that still leave
+ *  at least one texel for each pixel.
+ ***********************************************************/
+int TextureResidency::GetRequiredLevel(int textureSize, float projectedTexels)
+{
+	if (projectedTexels < 1.0f)
+	{
+		projectedTexels = 1.0f;
+	}
+
+	float level = floorf(log2f((float)textureSize / projectedTexels));
+	return((level > 0.0f) ? (int)level : 0);
+}
+
+/***********************************************************
+ *  FindEvictionVictim()
+ *
+ *  This method is used for finding the array that gives up
+ *  its most detailed level next.  The array that was drawn
+ *  least recently goes first, and arrays drawn in the last
+ *  frame only give up the levels that no draw requested.
+ ***********************************************************/
+int TextureResidency::FindEvictionVictim(int excludedArray) const
+{
+	int victim = -1;
+	for (int i = 0; i < (int)m_usage.size(); i++)
+	{
+		if ((i == excludedArray) ||
+			(i >= m_pTextureArrays->GetArrayCount()) ||
+			(m_pTextureArrays->IsStreamable(i) == false) ||
+			(m_usage[i].targetLevel >= GetEvictionLimit(i)))
+		{
+			continue;
+		}
+		if ((victim < 0) || (m_usage[i].lastUsedFrame < m_usage[victim].lastUsedFrame))
+		{
+			victim = i;
+		}
+	}
+
+	return(victim);
+}
+
+/***********************************************************
+ *  GetEvictionLimit()
+ *
+ *  This method is used for getting the least detailed level
+ *  that an array can be evicted to.  An array drawn in the
+ *  last frame keeps the level its draws requested, and any
+ *  other array keeps at least its smallest level, so every
+ *  texture can always be sampled.
+ ***********************************************************/
+int TextureResidency::GetEvictionLimit(int arrayIndex) const
+{
+	const ARRAY_USAGE& usage = m_usage[arrayIndex];
+	int smallestLevel = m_pTextureArrays->GetLevelCount(arrayIndex) - 1;
+	if ((usage.requestedLevel >= 0) && (usage.lastUsedFrame == m_frame))
+	{
+		return(std::min(usage.requestedLevel, smallestLevel));
+	}
+
+	return(smallestLevel);
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.h
+// ============
+// keep the texture levels that the view needs within a video memory budget
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureArraySet.h"
+#include "TextureUploader.h"
+
+#include <vector>
+
+/***********************************************************
+ *  TextureResidency
+ *
+ *  This class decides which mipmap levels of the texture
+ *  arrays are stored in video memory.  The draws of a frame
+ *  request the level that their size on the screen needs,
+ *  and once a frame the arrays are streamed in towards the
+ *  levels that were requested.  When the budget would be
+ *  exceeded, the most detailed levels of the arrays that
+ *  were used least recently are evicted first, and a request
+ *  that still does not fit waits until there is room.
+ ***********************************************************/
+class TextureResidency
+{
+public:
+	// constructor
+	TextureResidency(
+		TextureArraySet* pTextureArrays,
+		TextureUploader* pUploader,
+		size_t budgetBytes);
+
+	// set the most bytes that the texture levels may take
+	void SetBudget(size_t budgetBytes);
+	// record that a draw samples an array at the passed in level
+	void RequestLevel(int arrayIndex, int level);
+	// stream the arrays towards the levels requested since the
+	// last update - called once per frame, returns true when
+	// the texture of an array changed
+	bool Update();
+	// print the residency counters
+	void LogStats() const;
+
+	// get the bytes of every stored level
+	inline size_t GetResidentBytes() const
+	{
+		return(m_pTextureArrays->GetResidentBytes());
+	}
+	// get the number of arrays waiting for more detailed levels
+	inline int GetPendingRequests() const
+	{
+		return(m_pendingRequests);
+	}
+	// get the number of levels evicted so far
+	inline unsigned int GetEvictionCount() const
+	{
+		return(m_evictionCount);
+	}
+
+	// get the level of a texture that covers the passed in
+	// number of pixels with about one texel each
+	static int GetRequiredLevel(int textureSize, float projectedTexels);
+
+private:
+	// the use of one array
+	struct ARRAY_USAGE
+	{
+		// the most detailed level requested since the last
+		// update, or -1 when the array was not drawn
+		int requestedLevel;
+		// the update that the array was last drawn before
+		unsigned int lastUsedFrame;
+		// the level that the array is streamed towards
+		int targetLevel;
+	};
+
+	// the texture arrays whose levels are managed
+	TextureArraySet* m_pTextureArrays;
+	// streams the levels into the arrays
+	TextureUploader* m_pUploader;
+	// the most bytes that the texture levels may take
+	size_t m_budgetBytes;
+	// the use of each array, by array index
+	std::vector<ARRAY_USAGE> m_usage;
+	// number of updates so far
+	unsigned int m_frame;
+	// number of arrays that were not streamed in as far as
+	// requested by the last update
+	int m_pendingRequests;
+	// number of levels evicted so far
+	unsigned int m_evictionCount;
+	// number of levels streamed in so far
+	unsigned int m_loadCount;
+
+	// find the array whose levels should be evicted to make
+	// room for another array - returns -1 when none can be
+	int FindEvictionVictim(int excludedArray) const;
+	// get the least detailed level that an array is kept at
+	int GetEvictionLimit(int arrayIndex) const;
+};
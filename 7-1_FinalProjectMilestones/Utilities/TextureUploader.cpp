@@ -0,0 +1,366 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureuploader.cpp
+// ============
+// stream texture pixels into textures through a ring of pixel buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureUploader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace
+{
+	// how long each wait for a pixel buffer lasts in Flush(),
+	// in nanoseconds
+	const GLuint64 g_FenceWaitTimeout = 100000000;
+}
+
+/***********************************************************
+ *  TextureUploader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureUploader::TextureUploader(GLStateCache* pStateCache, size_t bufferSize, int bufferCount)
+{
+	m_pStateCache = pStateCache;
+	m_nextBuffer = 0;
+	m_bufferSize = bufferSize;
+	m_lastUploadedBytes = 0;
+
+	for (int i = 0; i < bufferCount; i++)
+	{
+		UPLOAD_BUFFER buffer;
+		glGenBuffers(1, &buffer.bufferID);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.bufferID);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, m_bufferSize, NULL, GL_STREAM_DRAW);
+		buffer.fence = 0;
+		m_buffers.push_back(buffer);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+/***********************************************************
+ *  ~TextureUploader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureUploader::~TextureUploader()
+{
+	for (size_t i = 0; i < m_buffers.size(); i++)
+	{
+		if (m_buffers[i].fence != 0)
+		{
+			glDeleteSync(m_buffers[i].fence);
+		}
+		glDeleteBuffers(1, &m_buffers[i].bufferID);
+	}
+}
+
+/***********************************************************
+ *  QueueUpload()
+ *
+ *  This method is used for queueing the levels of texture
+ *  data to be uploaded into a texture, one job per level.
+ *  The jobs share the pixel memory of the data, which stays
+ *  alive until the last of them is uploaded.
+ ***********************************************************/
+void TextureUploader::QueueUpload(GLuint textureID, GLenum target, int layer, const TEXTURE_DATA& data)
+{
+	for (size_t level = 0; level < data.levels.size(); level++)
+	{
+		UPLOAD_JOB job;
+		job.textureID = textureID;
+		job.target = target;
+		job.layer = layer;
+		job.level = (int)level;
+		job.data = data;
+		job.rowSize = GetTextureRowSize(data, data.levels[level].width);
+		job.rowHeight = GetTextureRowHeight(data);
+		job.nextRow = 0;
+		job.rowCount = (data.levels[level].height + job.rowHeight - 1) / job.rowHeight;
+		job.bGenerateMipmaps = (data.bGenerateMipmaps) && (level + 1 == data.levels.size());
+
+		// a row that does not fit into a pixel buffer is uploaded
+		// straight from the pixels
+		if (job.rowSize > m_bufferSize)
+		{
+			printf("Texture rows are larger than the upload buffers, uploading %s directly\n", data.filename.c_str());
+			UploadBand(job, 0, job.rowCount, data.levels[level].pixels);
+			FinishJob(job);
+			continue;
+		}
+
+		m_jobs.push_back(job);
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for uploading the queued levels, up
+ *  to the passed in number of bytes.  It never waits for the
+ *  GPU - when the next pixel buffer is still being read, the
+ *  rest is left for the next frame.
+ ***********************************************************/
+int TextureUploader::Update(size_t byteBudget)
+{
+	return(UploadRows(byteBudget, false));
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for uploading every queued level,
+ *  for when the textures are needed right away.
+ ***********************************************************/
+void TextureUploader::Flush()
+{
+	UploadRows((size_t)-1, true);
+}
+
+/***********************************************************
+ *  IsUploadPending()
+ *
+ *  This method is used for checking whether a texture is
+ *  still waiting for some of its pixels.
+ ***********************************************************/
+bool TextureUploader::IsUploadPending(GLuint textureID) const
+{
+	for (size_t i = 0; i < m_jobs.size(); i++)
+	{
+		if (m_jobs[i].textureID == textureID)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  CancelUploads()
+ *
+ *  This method is used for dropping the jobs of a texture,
+ *  along with their share of the pixels.  The rows already
+ *  in flight only read from their pixel buffers, which are
+ *  fenced as usual.
+ ***********************************************************/
+void TextureUploader::CancelUploads(GLuint textureID)
+{
+	for (std::deque<UPLOAD_JOB>::iterator job = m_jobs.begin(); job != m_jobs.end();)
+	{
+		if (job->textureID == textureID)
+		{
+			job = m_jobs.erase(job);
+		}
+		else
+		{
+			++job;
+		}
+	}
+}
+
+/***********************************************************
+ *  UploadRows()
+ *
+ *  This method is used for copying bands of rows into the
+ *  pixel buffers and uploading them into the textures.  A
+ *  band is as many rows as fit into a buffer and into the
+ *  rest of the budget, but at least one row per update, so
+ *  a level always makes progress.  Once the last band of a
+ *  level is uploaded its job is finished, which lets go of
+ *  its share of the pixels.
+ ***********************************************************/
+int TextureUploader::UploadRows(size_t byteBudget, bool bWait)
+{
+	size_t uploadedBytes = 0;
+
+	while (!m_jobs.empty())
+	{
+		UPLOAD_JOB& job = m_jobs.front();
+		size_t rowSize = job.rowSize;
+		int remainingRows = job.rowCount - job.nextRow;
+
+		size_t rows = m_bufferSize / rowSize;
+		if (uploadedBytes + rowSize * rows > byteBudget)
+		{
+			rows = (byteBudget > uploadedBytes) ? (byteBudget - uploadedBytes) / rowSize : 0;
+		}
+		if ((rows == 0) && (uploadedBytes == 0))
+		{
+			rows = 1;
+		}
+		if ((rows == 0) || (AcquireBuffer(bWait) == false))
+		{
+			break;
+		}
+		if (rows > (size_t)remainingRows)
+		{
+			rows = remainingRows;
+		}
+
+		// the fence of the buffer has signaled, so the mapping
+		// does not need to wait for the GPU
+		UPLOAD_BUFFER& buffer = m_buffers[m_nextBuffer];
+		size_t bandSize = rowSize * rows;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.bufferID);
+		void* pMapped = glMapBufferRange(
+			GL_PIXEL_UNPACK_BUFFER, 0, bandSize,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (pMapped == NULL)
+		{
+			printf("Could not map a texture upload buffer\n");
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			break;
+		}
+		memcpy(pMapped, job.data.levels[job.level].pixels + rowSize * job.nextRow, bandSize);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		UploadBand(job, job.nextRow, (int)rows, NULL);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_nextBuffer = (m_nextBuffer + 1) % m_buffers.size();
+
+		uploadedBytes += bandSize;
+		job.nextRow += (int)rows;
+
+		if (job.nextRow >= job.rowCount)
+		{
+			UPLOAD_JOB finishedJob = job;
+			m_jobs.pop_front();
+			FinishJob(finishedJob);
+		}
+	}
+
+	m_lastUploadedBytes = uploadedBytes;
+
+	return((int)m_jobs.size());
+}
+
+/***********************************************************
+ *  AcquireBuffer()
+ *
+ *  This method is used for checking that the next buffer of
+ *  the ring is no longer read by an earlier upload, and
+ *  releasing its fence.
+ ***********************************************************/
+bool TextureUploader::AcquireBuffer(bool bWait)
+{
+	if (m_buffers.empty())
+	{
+		return(false);
+	}
+
+	UPLOAD_BUFFER& buffer = m_buffers[m_nextBuffer];
+	if (buffer.fence == 0)
+	{
+		return(true);
+	}
+
+	GLenum result = glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, bWait ? g_FenceWaitTimeout : 0);
+	while ((bWait) && (result == GL_TIMEOUT_EXPIRED))
+	{
+		result = glClientWaitSync(buffer.fence, 0, g_FenceWaitTimeout);
+	}
+	if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED))
+	{
+		return(false);
+	}
+
+	glDeleteSync(buffer.fence);
+	buffer.fence = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  UploadBand()
+ *
+ *  This method is used for uploading a band of rows into the
+ *  level of a job.  With a pixel buffer bound the pixel
+ *  pointer is NULL, which is the offset of the rows in the
+ *  buffer.
+ ***********************************************************/
+void TextureUploader::UploadBand(const UPLOAD_JOB& job, int firstRow, int rows, const unsigned char* pPixels)
+{
+	const TEXTURE_LEVEL& level = job.data.levels[job.level];
+	int y = firstRow * job.rowHeight;
+	int height = std::min(rows * job.rowHeight, level.height - y);
+	GLsizei bandSize = (GLsizei)(job.rowSize * rows);
+
+	BindForUpload(job.textureID, job.target);
+
+	// compressed rows are uploaded as whole blocks
+	if (job.data.pixelFormat == 0)
+	{
+		if (job.target == GL_TEXTURE_2D_ARRAY)
+		{
+			glCompressedTexSubImage3D(
+				GL_TEXTURE_2D_ARRAY, job.level,
+				0, y, job.layer, level.width, height, 1,
+				job.data.internalFormat, bandSize, pPixels);
+		}
+		else
+		{
+			glCompressedTexSubImage2D(
+				job.target, job.level,
+				0, y, level.width, height,
+				job.data.internalFormat, bandSize, pPixels);
+		}
+		return;
+	}
+
+	// the rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (job.target == GL_TEXTURE_2D_ARRAY)
+	{
+		glTexSubImage3D(
+			GL_TEXTURE_2D_ARRAY, job.level,
+			0, y, job.layer, level.width, height, 1,
+			job.data.pixelFormat, GL_UNSIGNED_BYTE, pPixels);
+	}
+	else
+	{
+		glTexSubImage2D(
+			job.target, job.level,
+			0, y, level.width, height,
+			job.data.pixelFormat, GL_UNSIGNED_BYTE, pPixels);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/***********************************************************
+ *  FinishJob()
+ *
+ *  This method is used for finishing a level once all of
+ *  its rows are uploaded.  The missing mipmap levels are
+ *  generated once no other upload into the texture is
+ *  pending, so an array texture generates them only once.
+ ***********************************************************/
+void TextureUploader::FinishJob(const UPLOAD_JOB& job)
+{
+	if ((job.bGenerateMipmaps) && (IsUploadPending(job.textureID) == false))
+	{
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		BindForUpload(job.textureID, job.target);
+		glGenerateMipmap(job.target);
+	}
+}
+
+/***********************************************************
+ *  BindForUpload()
+ *
+ *  This method is used for binding a texture on the upload
+ *  unit and making that unit active, so the texture calls
+ *  that follow change the texture.
+ ***********************************************************/
+void TextureUploader::BindForUpload(GLuint textureID, GLenum target)
+{
+	m_pStateCache->ActiveTexture(GL_TEXTURE0 + UPLOAD_TEXTURE_UNIT);
+	m_pStateCache->BindTexture(target, textureID);
+}
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureuploader.h
+// ============
+// stream texture pixels into textures through a ring of pixel buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+#include "TextureData.h"
+
+#include <vector>
+#include <deque>
+
+/***********************************************************
+ *  TextureUploader
+ *
+ *  This class copies texture pixels into a ring of pixel
+ *  buffer objects, and uploads them into their textures from
+ *  the buffers, so the driver copies the pixels without
+ *  stalling the main thread.  Each buffer gets a fence after
+ *  its upload, and is only written again once the fence has
+ *  signaled.  Levels are uploaded in bands of rows, and each
+ *  frame uploads no more than its byte budget, so streaming
+ *  large textures does not cause frame hitches.
+ ***********************************************************/
+class TextureUploader
+{
+public:
+	// the texture unit used for binding textures while they
+	// are uploaded, so the units of the scene are left alone
+	static const GLuint UPLOAD_TEXTURE_UNIT = GLStateCache::MAX_TEXTURE_UNITS - 1;
+
+	// constructor
+	TextureUploader(
+		GLStateCache* pStateCache,
+		size_t bufferSize = 4 * 1024 * 1024,
+		int bufferCount = 4);
+	// destructor
+	~TextureUploader();
+
+	// queue the levels of texture data for uploading into a 2D
+	// texture, or into a layer of a 2D array texture, whose
+	// storage was already allocated with the data size - the
+	// uploader keeps the pixels alive until they are uploaded
+	void QueueUpload(
+		GLuint textureID,
+		GLenum target,
+		int layer,
+		const TEXTURE_DATA& data);
+	// upload queued rows until the byte budget is used up or no
+	// pixel buffer is free - called once per frame, returns the
+	// number of levels still waiting for their pixels
+	int Update(size_t byteBudget);
+	// upload everything that is queued, waiting for the pixel
+	// buffers as needed
+	void Flush();
+
+	// bind a texture on the upload unit and make that unit
+	// active, for changing the texture without disturbing the
+	// texture units of the scene
+	void BindForUpload(GLuint textureID, GLenum target);
+	// check whether a texture is still waiting for its pixels
+	bool IsUploadPending(GLuint textureID) const;
+	// drop the queued uploads into a texture that is about to
+	// be deleted
+	void CancelUploads(GLuint textureID);
+	// get the number of bytes uploaded by the last Update()
+	inline size_t GetLastUploadedBytes() const
+	{
+		return(m_lastUploadedBytes);
+	}
+
+private:
+	// properties for one pixel buffer of the ring
+	struct UPLOAD_BUFFER
+	{
+		GLuint bufferID;
+		// signaled once the upload from the buffer is done,
+		// or 0 when the buffer was never used
+		GLsync fence;
+	};
+
+	// properties for a level waiting for its pixels
+	struct UPLOAD_JOB
+	{
+		GLuint textureID;
+		// GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+		GLenum target;
+		// layer of an array texture, or 0
+		int layer;
+		int level;
+		// the texture data, which shares the pixel memory
+		TEXTURE_DATA data;
+		// bytes in a row, and pixel rows in a row
+		size_t rowSize;
+		int rowHeight;
+		// first row that has not been uploaded yet, and the
+		// number of rows in the level
+		int nextRow;
+		int rowCount;
+		// generate the rest of the mipmaps once this is uploaded
+		bool bGenerateMipmaps;
+	};
+
+	// state cache used for the texture bindings
+	GLStateCache* m_pStateCache;
+	// the ring of pixel buffers
+	std::vector<UPLOAD_BUFFER> m_buffers;
+	// the buffer of the ring that is written next
+	size_t m_nextBuffer;
+	// size of each pixel buffer in bytes
+	size_t m_bufferSize;
+	// levels waiting for their pixels, in queue order
+	std::deque<UPLOAD_JOB> m_jobs;
+	// bytes uploaded by the last Update()
+	size_t m_lastUploadedBytes;
+
+	// upload rows of the queued levels - when bWait is set the
+	// buffers are waited for instead of ending the update
+	int UploadRows(size_t byteBudget, bool bWait);
+	// wait for the next buffer of the ring to be free - returns
+	// false when it is still in use and bWait is not set
+	bool AcquireBuffer(bool bWait);
+	// upload rows of a level from the bound pixel buffer, or
+	// from the passed in pixels when no buffer is bound
+	void UploadBand(const UPLOAD_JOB& job, int firstRow, int rows, const unsigned char* pPixels);
+	// finish a level whose rows are all uploaded
+	void FinishJob(const UPLOAD_JOB& job);
+};
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformhandle.h
+// ============
+// typed handles for shader uniforms, named and hashed at compile time
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+
+/***********************************************************
+ *  HashUniformName()
+ *
+ *  This function is used for hashing a uniform name with
+ *  the 32-bit FNV-1a algorithm.  It is constexpr so that the
+ *  hash of a named handle is computed by the compiler.
+ ***********************************************************/
+constexpr uint32_t HashUniformName(const char* name)
+{
+	uint32_t hash = 2166136261u;
+	while (*name != '\0')
+	{
+		hash ^= (uint32_t)(unsigned char)(*name);
+		hash *= 16777619u;
+		name++;
+	}
+	return(hash);
+}
+
+// tag types used for sampler uniforms, which are set
+// with the index of a texture unit, or a bindless handle
+struct Sampler2D {};
+struct Sampler2DArray {};
+
+/***********************************************************
+ *  UniformTraits
+ *
+ *  Maps a C++ uniform value type to the GLSL type that the
+ *  linked program must report for that uniform.
+ ***********************************************************/
+template <typename T> struct UniformTraits;
+template <> struct UniformTraits<bool>      { static constexpr GLenum glType = GL_BOOL; };
+template <> struct UniformTraits<int>       { static constexpr GLenum glType = GL_INT; };
+template <> struct UniformTraits<glm::ivec2> { static constexpr GLenum glType = GL_INT_VEC2; };
+template <> struct UniformTraits<float>     { static constexpr GLenum glType = GL_FLOAT; };
+template <> struct UniformTraits<glm::vec2> { static constexpr GLenum glType = GL_FLOAT_VEC2; };
+template <> struct UniformTraits<glm::vec3> { static constexpr GLenum glType = GL_FLOAT_VEC3; };
+template <> struct UniformTraits<glm::vec4> { static constexpr GLenum glType = GL_FLOAT_VEC4; };
+template <> struct UniformTraits<glm::mat2> { static constexpr GLenum glType = GL_FLOAT_MAT2; };
+template <> struct UniformTraits<glm::mat3> { static constexpr GLenum glType = GL_FLOAT_MAT3; };
+template <> struct UniformTraits<glm::mat4> { static constexpr GLenum glType = GL_FLOAT_MAT4; };
+template <> struct UniformTraits<Sampler2D> { static constexpr GLenum glType = GL_SAMPLER_2D; };
+template <> struct UniformTraits<Sampler2DArray> { static constexpr GLenum glType = GL_SAMPLER_2D_ARRAY; };
+
+// description of an expected uniform, used for checking
+// the declared handles against a linked program
+struct UNIFORM_DESC
+{
+	const char* name;
+	uint32_t hash;
+	GLenum glType;
+	// explicit location from the shader layout, or -1
+	GLint location;
+};
+
+// a shader define that is a specialization constant in the
+// SPIR-V build of the same shader
+struct SPECIALIZATION_CONSTANT_DESC
+{
+	const char* define;
+	GLuint constantID;
+};
+
+/***********************************************************
+ *  Uniform<T>
+ *
+ *  A handle for a uniform of type T.  Handles are meant to
+ *  be declared constexpr, so the name hash is computed at
+ *  compile time and nothing is allocated when the handle is
+ *  passed to the ShaderManager setters.  The location is the
+ *  one given by layout(location = N) in the shaders, which
+ *  is the only way to find uniforms in SPIR-V programs.
+ ***********************************************************/
+template <typename T>
+struct Uniform
+{
+	const char* name;
+	uint32_t hash;
+	GLint location;
+
+	constexpr explicit Uniform(const char* uniformName, GLint uniformLocation = -1)
+		: name(uniformName), hash(HashUniformName(uniformName)), location(uniformLocation)
+	{
+	}
+
+	constexpr UNIFORM_DESC Describe() const
+	{
+		return UNIFORM_DESC{ name, hash, UniformTraits<T>::glType, location };
+	}
+};
@@ -0,0 +1,680 @@
+///////////////////////////////////////////////////////////////////////////////
+// videotexture.cpp
+// ============
+// stream the frames of an image sequence or raw video into a texture
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VideoTexture.h"
+#include "TextureUploader.h"
+
+#include "stb_image.h"
+
+#include <string.h>
+
+namespace
+{
+	// the most files that an image sequence is searched for
+	const int g_MaxSequenceFrames = 100000;
+
+	/***********************************************************
+	 *  FormatFrameName()
+	 *
+	 *  This function is used for putting a frame number into
+	 *  the %d of a file name pattern, which may be zero padded
+	 *  like %03d.  A pattern without a number is returned as it
+	 *  is.  Only this one conversion is allowed, so the pattern
+	 *  is never passed to printf.
+	 ***********************************************************/
+	std::string FormatFrameName(const std::string& pattern, int frame)
+	{
+		size_t percent = pattern.find('%');
+		if (percent == std::string::npos)
+		{
+			return(pattern);
+		}
+
+		size_t end = percent + 1;
+		bool bZeroPadded = (end < pattern.size()) && (pattern[end] == '0');
+		int width = 0;
+		while ((end < pattern.size()) && (pattern[end] >= '0') && (pattern[end] <= '9'))
+		{
+			width = width * 10 + (pattern[end] - '0');
+			end++;
+		}
+		if ((end >= pattern.size()) || (pattern[end] != 'd'))
+		{
+			return(std::string());
+		}
+
+		std::string number = std::to_string(frame);
+		if ((int)number.size() < width)
+		{
+			number.insert(0, width - number.size(), bZeroPadded ? '0' : ' ');
+		}
+
+		return(pattern.substr(0, percent) + number + pattern.substr(end + 1));
+	}
+
+	/***********************************************************
+	 *  FileExists()
+	 *
+	 *  This function is used for checking that a file can be
+	 *  opened for reading.
+	 ***********************************************************/
+	bool FileExists(const std::string& filename)
+	{
+		FILE* pFile = fopen(filename.c_str(), "rb");
+		if (NULL == pFile)
+		{
+			return(false);
+		}
+		fclose(pFile);
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  SeekFile()
+	 *
+	 *  This function is used for moving to a byte offset of a
+	 *  file, which may be past the 2 GB that fseek() reaches.
+	 ***********************************************************/
+	bool SeekFile(FILE* pFile, long long offset, int origin)
+	{
+#ifdef _WIN32
+		return(_fseeki64(pFile, offset, origin) == 0);
+#else
+		return(fseeko(pFile, (off_t)offset, origin) == 0);
+#endif
+	}
+
+	/***********************************************************
+	 *  TellFile()
+	 *
+	 *  This function is used for getting the byte offset of a
+	 *  file.
+	 ***********************************************************/
+	long long TellFile(FILE* pFile)
+	{
+#ifdef _WIN32
+		return(_ftelli64(pFile));
+#else
+		return((long long)ftello(pFile));
+#endif
+	}
+}
+
+/***********************************************************
+ *  VideoTexture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VideoTexture::VideoTexture(GLStateCache* pStateCache, int slotCount)
+{
+	m_pStateCache = pStateCache;
+	m_frameCount = 0;
+	m_width = 0;
+	m_height = 0;
+	m_colorChannels = 0;
+	m_frameSize = 0;
+	m_bufferID = 0;
+	m_pMappedData = NULL;
+	// one slot is uploading, one is ready and one is decoding
+	// at the least
+	m_slotCount = (slotCount > 3) ? slotCount : 3;
+	m_targetID = 0;
+	m_targetLayer = 0;
+	m_bStopRequested = false;
+	m_nextDecodeFrame = 0;
+	m_dueFrame = 0;
+	m_bStarted = false;
+	m_shownFrame = -1;
+	m_uploadedFrames = 0;
+	m_droppedFrames = 0;
+	m_uploadedBytes = 0;
+	m_lastLogFrames = 0;
+	m_lastLogDropped = 0;
+	m_lastLogBytes = 0;
+}
+
+/***********************************************************
+ *  ~VideoTexture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VideoTexture::~VideoTexture()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for opening a video, creating its
+ *  frame slots, and starting the decode thread, which fills
+ *  the slots ahead of playback.  The clock of the video
+ *  starts with its first uploaded frame.
+ ***********************************************************/
+bool VideoTexture::Open(const VIDEO_SOURCE& source)
+{
+	Close();
+
+	m_source = source;
+	if (m_source.frameRate <= 0.0)
+	{
+		printf("Could not open video %s - its frame rate is not set\n", m_source.path.c_str());
+		return(false);
+	}
+
+	bool bOpened = (m_source.type == SOURCE_RAW_VIDEO) ? OpenRawVideo() : OpenImageSequence();
+	if ((bOpened == false) || (CreateSlots() == false))
+	{
+		m_frameFiles.clear();
+		m_frameCount = 0;
+		return(false);
+	}
+
+	m_bStopRequested = false;
+	m_nextDecodeFrame = 0;
+	m_dueFrame = 0;
+	m_bStarted = false;
+	m_shownFrame = -1;
+	m_uploadedFrames = 0;
+	m_droppedFrames = 0;
+	m_uploadedBytes = 0;
+	m_lastLogTime = std::chrono::steady_clock::now();
+	m_lastLogFrames = 0;
+	m_lastLogDropped = 0;
+	m_lastLogBytes = 0;
+	m_thread = std::thread(&VideoTexture::DecodeThread, this);
+
+	printf("Opened video %s: %dx%d, %d channels, %d frames at %.1f fps, %d frame slots\n",
+		m_source.path.c_str(), m_width, m_height, m_colorChannels, m_frameCount, m_source.frameRate, (int)m_slots.size());
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for stopping the decode thread and
+ *  freeing the pixel buffer of the frame slots.
+ ***********************************************************/
+void VideoTexture::Close()
+{
+	if (m_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bStopRequested = true;
+		}
+		m_slotFree.notify_all();
+		m_thread.join();
+	}
+
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		if (m_slots[i].fence != 0)
+		{
+			glDeleteSync(m_slots[i].fence);
+		}
+	}
+	m_slots.clear();
+
+	if (m_bufferID != 0)
+	{
+		if (NULL != m_pMappedData)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_bufferID);
+	}
+	m_bufferID = 0;
+	m_pMappedData = NULL;
+	m_staging.clear();
+	m_frameFiles.clear();
+	m_frameCount = 0;
+}
+
+/***********************************************************
+ *  SetTarget()
+ *
+ *  This method is used for setting the texture layer that
+ *  the frames are uploaded into.
+ ***********************************************************/
+void VideoTexture::SetTarget(GLuint textureID, int layer)
+{
+	m_targetID = textureID;
+	m_targetLayer = layer;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for retiring the finished uploads and
+ *  uploading the newest decoded frame that is due.  Decoded
+ *  frames that are older than it are dropped, and when no
+ *  frame is due yet, or the decode thread is behind, the
+ *  texture keeps its last frame.  The frames skipped between
+ *  two uploads are counted as dropped, whichever side skipped
+ *  them.
+ ***********************************************************/
+bool VideoTexture::Update()
+{
+	if ((IsOpen() == false) || (m_targetID == 0))
+	{
+		return(false);
+	}
+
+	long long dueFrame = 0;
+	if (m_bStarted)
+	{
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+		dueFrame = (long long)(seconds * m_source.frameRate);
+	}
+
+	int newestSlot = -1;
+	bool bSlotFreed = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_dueFrame = dueFrame;
+
+		for (size_t i = 0; i < m_slots.size(); i++)
+		{
+			FRAME_SLOT& slot = m_slots[i];
+			if (slot.state == SLOT_UPLOADING)
+			{
+				GLenum result = glClientWaitSync(slot.fence, 0, 0);
+				if ((result == GL_ALREADY_SIGNALED) || (result == GL_CONDITION_SATISFIED))
+				{
+					glDeleteSync(slot.fence);
+					slot.fence = 0;
+					slot.state = SLOT_FREE;
+					bSlotFreed = true;
+				}
+			}
+			else if ((slot.state == SLOT_READY) && (slot.frameNumber <= dueFrame) &&
+				((newestSlot < 0) || (slot.frameNumber > m_slots[newestSlot].frameNumber)))
+			{
+				newestSlot = (int)i;
+			}
+		}
+
+		for (size_t i = 0; i < m_slots.size(); i++)
+		{
+			if ((m_slots[i].state == SLOT_READY) && (newestSlot >= 0) &&
+				(m_slots[i].frameNumber < m_slots[newestSlot].frameNumber))
+			{
+				m_slots[i].state = SLOT_FREE;
+				bSlotFreed = true;
+			}
+		}
+		if (newestSlot >= 0)
+		{
+			m_slots[newestSlot].state = SLOT_UPLOADING;
+		}
+	}
+	if (bSlotFreed)
+	{
+		m_slotFree.notify_one();
+	}
+
+	if (newestSlot < 0)
+	{
+		return(false);
+	}
+
+	UploadSlot(newestSlot);
+
+	// the frames between the last two uploads never reached
+	// the screen
+	long long frameNumber = m_slots[newestSlot].frameNumber;
+	if (frameNumber > m_shownFrame + 1)
+	{
+		m_droppedFrames += (unsigned int)(frameNumber - m_shownFrame - 1);
+	}
+	m_shownFrame = frameNumber;
+	m_uploadedFrames++;
+	m_uploadedBytes += m_frameSize;
+
+	if (m_bStarted == false)
+	{
+		m_startTime = std::chrono::steady_clock::now();
+		m_bStarted = true;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LogStats()
+ *
+ *  This method is used for printing the frames and bytes
+ *  uploaded per second, and the frames dropped, since the
+ *  last time the counters were printed.
+ ***********************************************************/
+void VideoTexture::LogStats()
+{
+	if (IsOpen() == false)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - m_lastLogTime).count();
+	if (seconds <= 0.0)
+	{
+		return;
+	}
+
+	printf("Video %s: %.1f frames/s uploaded, %.1f MB/s, %u frames dropped, %u dropped in total\n",
+		m_source.path.c_str(),
+		(m_uploadedFrames - m_lastLogFrames) / seconds,
+		(m_uploadedBytes - m_lastLogBytes) / (1024.0 * 1024.0) / seconds,
+		m_droppedFrames - m_lastLogDropped,
+		m_droppedFrames);
+
+	m_lastLogTime = now;
+	m_lastLogFrames = m_uploadedFrames;
+	m_lastLogDropped = m_droppedFrames;
+	m_lastLogBytes = m_uploadedBytes;
+}
+
+/***********************************************************
+ *  OpenImageSequence()
+ *
+ *  This method is used for finding the numbered files of an
+ *  image sequence, counting from 0 or 1 up to the first
+ *  missing number, and reading the size of the first image.
+ *  The images are decoded to RGB, or to RGBA when they have
+ *  alpha.
+ ***********************************************************/
+bool VideoTexture::OpenImageSequence()
+{
+	std::string first = FormatFrameName(m_source.path, 0);
+	if (first.empty())
+	{
+		printf("Could not open video %s - the frame number must be given as %%d\n", m_source.path.c_str());
+		return(false);
+	}
+
+	if (first == m_source.path)
+	{
+		// a single image plays as a still
+		if (FileExists(first))
+		{
+			m_frameFiles.push_back(first);
+		}
+	}
+	else
+	{
+		int firstNumber = FileExists(first) ? 0 : 1;
+		for (int i = firstNumber; i < firstNumber + g_MaxSequenceFrames; i++)
+		{
+			std::string filename = FormatFrameName(m_source.path, i);
+			if (FileExists(filename) == false)
+			{
+				break;
+			}
+			m_frameFiles.push_back(filename);
+		}
+	}
+
+	int colorChannels = 0;
+	if ((m_frameFiles.empty()) ||
+		(stbi_info(m_frameFiles[0].c_str(), &m_width, &m_height, &colorChannels) == 0))
+	{
+		printf("Could not find the frames of video %s\n", m_source.path.c_str());
+		return(false);
+	}
+
+	m_colorChannels = ((colorChannels == 2) || (colorChannels == 4)) ? 4 : 3;
+	m_frameSize = (size_t)m_width * (size_t)m_height * (size_t)m_colorChannels;
+	m_frameCount = (int)m_frameFiles.size();
+
+	return(true);
+}
+
+/***********************************************************
+ *  OpenRawVideo()
+ *
+ *  This method is used for counting the frames of a raw
+ *  video file from its size.  A partial frame at its end is
+ *  ignored.
+ ***********************************************************/
+bool VideoTexture::OpenRawVideo()
+{
+	if ((m_source.width <= 0) || (m_source.height <= 0) ||
+		((m_source.colorChannels != 3) && (m_source.colorChannels != 4)))
+	{
+		printf("Could not open video %s - raw frames need a size and 3 or 4 channels\n", m_source.path.c_str());
+		return(false);
+	}
+
+	FILE* pFile = fopen(m_source.path.c_str(), "rb");
+	if (NULL == pFile)
+	{
+		printf("Could not open video %s\n", m_source.path.c_str());
+		return(false);
+	}
+	long long fileSize = SeekFile(pFile, 0, SEEK_END) ? TellFile(pFile) : 0;
+	fclose(pFile);
+
+	m_width = m_source.width;
+	m_height = m_source.height;
+	m_colorChannels = m_source.colorChannels;
+	m_frameSize = (size_t)m_width * (size_t)m_height * (size_t)m_colorChannels;
+
+	long long frameCount = (fileSize > 0) ? fileSize / (long long)m_frameSize : 0;
+	if (frameCount <= 0)
+	{
+		printf("Could not open video %s - it holds no %dx%d frames\n", m_source.path.c_str(), m_width, m_height);
+		return(false);
+	}
+	m_frameCount = (frameCount < 0x7fffffff) ? (int)frameCount : 0x7fffffff;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateSlots()
+ *
+ *  This method is used for creating the pixel buffer that
+ *  holds the frame slots.  With buffer storage the buffer is
+ *  mapped once, persistently, and the decode thread writes
+ *  the frames straight into it.  Otherwise the frames are
+ *  decoded into staging memory and copied into the buffer
+ *  right before their upload.
+ ***********************************************************/
+bool VideoTexture::CreateSlots()
+{
+	size_t bufferSize = m_frameSize * (size_t)m_slotCount;
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+
+	if (GLEW_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, NULL, flags);
+		m_pMappedData = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags);
+	}
+	else
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize, NULL, GL_STREAM_DRAW);
+		m_staging.resize(bufferSize);
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if ((GLEW_ARB_buffer_storage) && (NULL == m_pMappedData))
+	{
+		printf("Could not map the frame slots of video %s\n", m_source.path.c_str());
+		glDeleteBuffers(1, &m_bufferID);
+		m_bufferID = 0;
+		return(false);
+	}
+
+	m_slots.assign(m_slotCount, FRAME_SLOT{ SLOT_FREE, -1, 0 });
+
+	return(true);
+}
+
+/***********************************************************
+ *  DecodeThread()
+ *
+ *  This is the main loop of the decode thread.  It takes the
+ *  next free slot and decodes the next frame into it, unless
+ *  that frame is due already, in which case it jumps ahead
+ *  to the due frame - decoding a late frame would only slow
+ *  down the ones after it.
+ ***********************************************************/
+void VideoTexture::DecodeThread()
+{
+	// the frames are flipped like the textures loaded from images
+	stbi_set_flip_vertically_on_load_thread(1);
+
+	FILE* pRawFile = NULL;
+	if (m_source.type == SOURCE_RAW_VIDEO)
+	{
+		pRawFile = fopen(m_source.path.c_str(), "rb");
+	}
+
+	unsigned char* pSlots = (NULL != m_pMappedData) ? m_pMappedData : m_staging.data();
+
+	while (true)
+	{
+		int slot = -1;
+		long long frameNumber = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_slotFree.wait(lock, [this]() { return((m_bStopRequested) || (FindSlot(SLOT_FREE) >= 0)); });
+			if (m_bStopRequested)
+			{
+				break;
+			}
+
+			slot = FindSlot(SLOT_FREE);
+			frameNumber = (m_nextDecodeFrame > m_dueFrame) ? m_nextDecodeFrame : m_dueFrame;
+			m_nextDecodeFrame = frameNumber + 1;
+			m_slots[slot].state = SLOT_DECODING;
+			m_slots[slot].frameNumber = frameNumber;
+		}
+
+		bool bDecoded = DecodeFrame((int)(frameNumber % m_frameCount), pSlots + m_frameSize * slot, pRawFile);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_slots[slot].state = bDecoded ? SLOT_READY : SLOT_FREE;
+		}
+	}
+
+	if (NULL != pRawFile)
+	{
+		fclose(pRawFile);
+	}
+}
+
+/***********************************************************
+ *  DecodeFrame()
+ *
+ *  This method is used for decoding a frame into the pixels
+ *  of a slot.  A raw frame is read a row at a time, from the
+ *  top row of the file into the bottom row of the slot.
+ *  Images of another size than the first one are skipped.
+ ***********************************************************/
+bool VideoTexture::DecodeFrame(int frame, unsigned char* pPixels, FILE* pRawFile)
+{
+	if (m_source.type == SOURCE_RAW_VIDEO)
+	{
+		if ((NULL == pRawFile) ||
+			(SeekFile(pRawFile, (long long)frame * (long long)m_frameSize, SEEK_SET) == false))
+		{
+			return(false);
+		}
+
+		size_t rowSize = (size_t)m_width * (size_t)m_colorChannels;
+		for (int row = m_height - 1; row >= 0; row--)
+		{
+			if (fread(pPixels + rowSize * row, 1, rowSize, pRawFile) != rowSize)
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	unsigned char* pImage = stbi_load(m_frameFiles[frame].c_str(), &width, &height, &colorChannels, m_colorChannels);
+	if (NULL == pImage)
+	{
+		printf("Could not load video frame %s\n", m_frameFiles[frame].c_str());
+		return(false);
+	}
+
+	bool bDecoded = ((width == m_width) && (height == m_height));
+	if (bDecoded)
+	{
+		memcpy(pPixels, pImage, m_frameSize);
+	}
+	stbi_image_free(pImage);
+
+	return(bDecoded);
+}
+
+/***********************************************************
+ *  FindSlot()
+ *
+ *  This method is used for finding a slot in the passed in
+ *  state.  The caller holds the mutex.
+ ***********************************************************/
+int VideoTexture::FindSlot(SLOT_STATE state) const
+{
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		if (m_slots[i].state == state)
+		{
+			return((int)i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  UploadSlot()
+ *
+ *  This method is used for uploading the frame of a slot
+ *  into the target layer, from the offset of the slot in the
+ *  pixel buffer, and fencing the slot until the upload is
+ *  done.  The texture is bound on the upload unit, so the
+ *  texture units of the scene are left alone.
+ ***********************************************************/
+void VideoTexture::UploadSlot(int slot)
+{
+	size_t offset = m_frameSize * (size_t)slot;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+	if (NULL == m_pMappedData)
+	{
+		glBufferSubData(GL_PIXEL_UNPACK_BUFFER, offset, m_frameSize, m_staging.data() + offset);
+	}
+
+	m_pStateCache->ActiveTexture(GL_TEXTURE0 + TextureUploader::UPLOAD_TEXTURE_UNIT);
+	m_pStateCache->BindTexture(GL_TEXTURE_2D_ARRAY, m_targetID);
+
+	// the rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage3D(
+		GL_TEXTURE_2D_ARRAY, 0,
+		0, 0, m_targetLayer, m_width, m_height, 1,
+		(m_colorChannels == 4) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, (const void*)offset);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	m_slots[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
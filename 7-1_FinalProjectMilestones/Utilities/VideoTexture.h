@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////////
+// videotexture.h
+// ============
+// stream the frames of an image sequence or raw video into a texture
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/***********************************************************
+ *  VideoTexture
+ *
+ *  This class plays an image sequence or a raw video file
+ *  into a layer of a texture at the frame rate of the video.
+ *  A decode thread writes the frames straight into a ring of
+ *  frame slots in a pixel buffer, and the main thread uploads
+ *  the newest frame that is due from its slot.  Neither side
+ *  waits for the other - the decode thread skips the frames
+ *  that are already late, and the main thread skips the
+ *  decoded frames that a newer one replaces, so a slow decode
+ *  or a slow frame drops video frames instead of stalling the
+ *  render loop.  Each slot gets a fence after its upload, and
+ *  is only written again once the fence has signaled.
+ ***********************************************************/
+class VideoTexture
+{
+public:
+	// the kinds of video that can be played
+	enum SOURCE_TYPE
+	{
+		// numbered image files, such as frame%03d.jpg, counting
+		// from 0 or 1
+		SOURCE_IMAGE_SEQUENCE = 0,
+		// a file of frames stored one after another, top row
+		// first, without a header
+		SOURCE_RAW_VIDEO
+	};
+
+	// where the frames of a video come from
+	struct VIDEO_SOURCE
+	{
+		SOURCE_TYPE type;
+		// the file name pattern of the sequence, or the raw file
+		std::string path;
+		// the size and channels of a raw frame - an image
+		// sequence takes its size from its first file
+		int width;
+		int height;
+		int colorChannels;
+		// frames per second
+		double frameRate;
+	};
+
+	// constructor
+	VideoTexture(GLStateCache* pStateCache, int slotCount = 4);
+	// destructor
+	~VideoTexture();
+
+	// open a video and start decoding its frames - returns
+	// false when it has no frames
+	bool Open(const VIDEO_SOURCE& source);
+	// stop decoding and free the frame slots
+	void Close();
+	// set the layer of a 2D array texture that the frames are
+	// written into - its storage must have the size of the
+	// frames and the internal format of the video
+	void SetTarget(GLuint textureID, int layer);
+	// upload the newest decoded frame that is due, without
+	// waiting for the decode thread or the GPU - called once
+	// per frame, returns true when a frame was uploaded
+	bool Update();
+	// print the upload throughput and the dropped frames since
+	// the last call
+	void LogStats();
+
+	// check whether a video is playing
+	inline bool IsOpen() const
+	{
+		return(m_frameCount > 0);
+	}
+	// get the size of the frames
+	inline int GetWidth() const
+	{
+		return(m_width);
+	}
+	inline int GetHeight() const
+	{
+		return(m_height);
+	}
+	// get the internal format for the texture storage
+	inline GLenum GetInternalFormat() const
+	{
+		return((m_colorChannels == 4) ? GL_RGBA8 : GL_RGB8);
+	}
+	// get the number of frames uploaded and dropped since the
+	// video was opened
+	inline unsigned int GetUploadedFrames() const
+	{
+		return(m_uploadedFrames);
+	}
+	inline unsigned int GetDroppedFrames() const
+	{
+		return(m_droppedFrames);
+	}
+	// get the number of frame bytes uploaded since the video
+	// was opened
+	inline unsigned long long GetUploadedBytes() const
+	{
+		return(m_uploadedBytes);
+	}
+
+private:
+	// the states of a frame slot, which pass in this order
+	enum SLOT_STATE
+	{
+		SLOT_FREE = 0,
+		// written by the decode thread
+		SLOT_DECODING,
+		// holds a decoded frame that was not uploaded yet
+		SLOT_READY,
+		// read by an upload that has not finished
+		SLOT_UPLOADING
+	};
+
+	// properties for one frame slot of the ring
+	struct FRAME_SLOT
+	{
+		SLOT_STATE state;
+		// the number of the frame since playing started, which
+		// keeps counting when the video loops
+		long long frameNumber;
+		// signaled once the upload from the slot is done
+		GLsync fence;
+	};
+
+	// state cache used for the texture binding
+	GLStateCache* m_pStateCache;
+	// the video that is playing
+	VIDEO_SOURCE m_source;
+	// the file names of the images of a sequence
+	std::vector<std::string> m_frameFiles;
+	// the number of frames before the video loops, or 0 when
+	// no video is open
+	int m_frameCount;
+	int m_width;
+	int m_height;
+	int m_colorChannels;
+	// bytes in a frame
+	size_t m_frameSize;
+
+	// the pixel buffer that holds the frame slots one after
+	// another
+	GLuint m_bufferID;
+	// the persistent mapping of the pixel buffer, or NULL when
+	// the frames are copied in from the staging memory instead
+	unsigned char* m_pMappedData;
+	std::vector<unsigned char> m_staging;
+	// the frame slots of the ring, which are created when a
+	// video is opened
+	int m_slotCount;
+	std::vector<FRAME_SLOT> m_slots;
+	// the texture layer that the frames are written into
+	GLuint m_targetID;
+	int m_targetLayer;
+
+	// the decode thread
+	std::thread m_thread;
+	// guards the slot states and the frame numbers
+	std::mutex m_mutex;
+	// signals the decode thread that a slot is free, or that
+	// it should exit
+	std::condition_variable m_slotFree;
+	// set when the decode thread should exit
+	bool m_bStopRequested;
+	// the next frame that the decode thread decodes
+	long long m_nextDecodeFrame;
+	// the frame that is due on the screen
+	long long m_dueFrame;
+
+	// when the first frame was shown
+	std::chrono::steady_clock::time_point m_startTime;
+	bool m_bStarted;
+	// the last frame that was uploaded, or -1
+	long long m_shownFrame;
+	// counters since the video was opened
+	unsigned int m_uploadedFrames;
+	unsigned int m_droppedFrames;
+	unsigned long long m_uploadedBytes;
+	// the counters at the last LogStats()
+	std::chrono::steady_clock::time_point m_lastLogTime;
+	unsigned int m_lastLogFrames;
+	unsigned int m_lastLogDropped;
+	unsigned long long m_lastLogBytes;
+
+	// find the files of an image sequence and read the size of
+	// its first image
+	bool OpenImageSequence();
+	// check the size of a raw video file
+	bool OpenRawVideo();
+	// create the pixel buffer of the frame slots
+	bool CreateSlots();
+	// the main loop of the decode thread
+	void DecodeThread();
+	// decode a frame of the video into a slot, bottom row first
+	// like the textures loaded from images - returns false when
+	// the frame could not be read
+	bool DecodeFrame(int frame, unsigned char* pPixels, FILE* pRawFile);
+	// find a slot in the passed in state, or -1
+	int FindSlot(SLOT_STATE state) const;
+	// upload the frame of a slot into the target texture
+	void UploadSlot(int slot);
+};
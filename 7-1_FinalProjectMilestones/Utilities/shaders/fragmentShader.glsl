@@ -1,108 +1,161 @@
-#version 440 core
-
-struct Material 
-{
-    vec3 ambientColor;
-    float ambientStrength;
-    vec3 diffuseColor;
-    vec3 specularColor;
-    float shininess;
-}; 
-
-struct LightSource 
-{
-    vec3 position;	
-    vec3 ambientColor;
-    vec3 diffuseColor;
-    vec3 specularColor;
-    float focalStrength;
-    float specularIntensity;
-};
-
-#define TOTAL_LIGHTS 4
-
-in vec3 fragmentPosition;
-in vec3 fragmentVertexNormal;
-in vec2 fragmentTextureCoordinate;
-
-out vec4 outFragmentColor;
-
-uniform bool bUseTexture=false;
-uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform sampler2D objectTexture;
-uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
-
-// function prototypes
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
-
-void main()
-{
-   if(bUseLighting == true)
-   {
-      // properties
-      vec3 lightNormal = normalize(fragmentVertexNormal);
-      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
-      vec3 phongResult = vec3(0.0f);
-
-      for(int i = 0; i < TOTAL_LIGHTS; i++)
-      {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
-      }   
-    
-      if(bUseTexture == true)
-      {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
-         outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
-      }
-      else
-      {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
-      }
-   }
-   else 
-   {
-      if(bUseTexture == true)
-      {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
-      }
-      else
-      {
-         outFragmentColor = objectColor;
-      }
-   }
-}
-
-// calculates the color when using a directional light.
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
-{
-   vec3 ambient;
-   vec3 diffuse;
-   vec3 specular;
-
-   //**Calculate Ambient lighting**
-
-   ambient = light.ambientColor + (material.ambientColor * material.ambientStrength);
-
-   //**Calculate Diffuse lighting**
-
-   // Calculate distance (light direction) between light source and fragments/pixels
-   vec3 lightDirection = normalize(light.position - vertexPosition); 
-   // Calculate diffuse impact by generating dot product of normal and light
-   float impact = max(dot(lightNormal, lightDirection), 0.0);
-   // Generate diffuse material color   
-   diffuse = impact * material.diffuseColor; 
-
-   //**Calculate Specular lighting**
-
-   // Calculate reflection vector
-   vec3 reflectDir = reflect(-lightDirection, lightNormal);
-   // Calculate specular component
-   float specularComponent = pow(max(dot(viewDirection, reflectDir), 0.0), light.focalStrength);
-   specular = (light.specularIntensity * material.shininess) * specularComponent * material.specularColor;
-  
-   return(ambient + diffuse + specular);
-}
\ No newline at end of file
+#version 440 core
+
+// This shader is compiled into variants by the ShaderManager,
+// which defines these before compiling:
+//   USE_TEXTURE   - color the surface from objectTexture
+//   USE_LIGHTING  - apply the phong lighting of the light sources
+//   TOTAL_LIGHTS  - the number of light sources for USE_LIGHTING
+//   USE_BINDLESS_TEXTURES - the texture arrays are bindless handles
+//
+// The uniform locations are fixed so that they match the
+// handles in ShaderUniforms.h and the SPIR-V build of this
+// shader in spirv/fragmentShader.frag.
+
+#ifdef USE_BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
+
+#ifndef TOTAL_LIGHTS
+#define TOTAL_LIGHTS 4
+#endif
+
+// the most texture arrays that objectTexture can select from
+#define MAX_TEXTURE_ARRAYS 16
+
+// the size of the materials array, which matches
+// MaterialTable::MAX_MATERIALS
+#define MAX_MATERIALS 256
+
+// std140 layout that matches MATERIAL_DATA in MaterialTable.h
+struct Material 
+{
+    // rgb holds the ambient color, a the ambient strength
+    vec4 ambient;
+    // rgb holds the diffuse color
+    vec4 diffuse;
+    // rgb holds the specular color, a the shininess
+    vec4 specular;
+}; 
+
+struct LightSource 
+{
+    vec3 position;	
+    vec3 ambientColor;
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float focalStrength;
+    float specularIntensity;
+};
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+// the color, material and texture of the object, from the
+// uniforms of the vertex shader or from its instance attributes
+flat in vec4 fragmentObjectColor;
+flat in int fragmentMaterialIndex;
+flat in ivec2 fragmentObjectTexture;
+flat in vec4 fragmentAtlasRect;
+flat in vec2 fragmentUVScale;
+
+out vec4 outFragmentColor;
+
+#ifdef USE_TEXTURE
+// the scene textures are layers of texture arrays - the object
+// texture holds the index of the array and the layer of the
+// texture, and the atlas rectangle the part of the layer that
+// holds it, as an offset in xy and a scale in zw
+#ifdef USE_BINDLESS_TEXTURES
+layout(bindless_sampler, location = 40) uniform sampler2DArray textureArrays[MAX_TEXTURE_ARRAYS];
+#else
+layout(location = 40) uniform sampler2DArray textureArrays[MAX_TEXTURE_ARRAYS];
+#endif
+#endif
+
+#ifdef USE_LIGHTING
+// the scene materials, packed when the scene is prepared
+layout(std140, binding = 1) uniform MaterialTable
+{
+   Material materials[MAX_MATERIALS];
+};
+layout(location = 16) uniform LightSource lightSources[TOTAL_LIGHTS];
+#endif
+
+#include "frameData.glsl"
+
+#ifdef USE_LIGHTING
+// function prototypes
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+#endif
+
+void main()
+{
+#ifdef USE_TEXTURE
+   // the texture repeats within its rectangle, and the mipmap
+   // level is picked from the coordinates before they wrap, so
+   // the edges of the repeats do not drop to the smallest level
+   vec2 textureCoordinate = fragmentTextureCoordinate * fragmentUVScale;
+   vec2 atlasCoordinate = fragmentAtlasRect.xy + fract(textureCoordinate) * fragmentAtlasRect.zw;
+   vec4 surfaceColor = textureGrad(
+      textureArrays[fragmentObjectTexture.x],
+      vec3(atlasCoordinate, float(fragmentObjectTexture.y)),
+      dFdx(textureCoordinate) * fragmentAtlasRect.zw,
+      dFdy(textureCoordinate) * fragmentAtlasRect.zw);
+#else
+   vec4 surfaceColor = fragmentObjectColor;
+#endif
+
+#ifdef USE_LIGHTING
+   // properties
+   vec3 lightNormal = normalize(fragmentVertexNormal);
+   vec3 viewDirection = normalize(frameData.viewPosition.xyz - fragmentPosition);
+   vec3 phongResult = vec3(0.0f);
+   Material material = materials[fragmentMaterialIndex];
+
+   for(int i = 0; i < TOTAL_LIGHTS; i++)
+   {
+      phongResult += CalcLightSource(lightSources[i], material, lightNormal, fragmentPosition, viewDirection); 
+   }   
+
+#ifdef USE_TEXTURE
+   outFragmentColor = vec4(phongResult * surfaceColor.xyz, 1.0);
+#else
+   outFragmentColor = vec4(phongResult * surfaceColor.xyz, surfaceColor.w);
+#endif
+#else
+   outFragmentColor = surfaceColor;
+#endif
+}
+
+#ifdef USE_LIGHTING
+// calculates the color when using a directional light.
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   vec3 ambient;
+   vec3 diffuse;
+   vec3 specular;
+
+   //**Calculate Ambient lighting**
+
+   ambient = light.ambientColor + (material.ambient.rgb * material.ambient.a);
+
+   //**Calculate Diffuse lighting**
+
+   // Calculate distance (light direction) between light source and fragments/pixels
+   vec3 lightDirection = normalize(light.position - vertexPosition); 
+   // Calculate diffuse impact by generating dot product of normal and light
+   float impact = max(dot(lightNormal, lightDirection), 0.0);
+   // Generate diffuse material color   
+   diffuse = impact * material.diffuse.rgb; 
+
+   //**Calculate Specular lighting**
+
+   // Calculate reflection vector
+   vec3 reflectDir = reflect(-lightDirection, lightNormal);
+   // Calculate specular component
+   float specularComponent = pow(max(dot(viewDirection, reflectDir), 0.0), light.focalStrength);
+   specular = (light.specularIntensity * material.specular.a) * specularComponent * material.specular.rgb;
+  
+   return(ambient + diffuse + specular);
+}
+#endif
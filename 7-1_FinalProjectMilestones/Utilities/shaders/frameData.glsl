@@ -0,0 +1,7 @@
+// per-frame camera data, shared by every shader program
+layout(std140, binding = 0) uniform FrameData
+{
+   mat4 view;
+   mat4 projection;
+   vec4 viewPosition;
+} frameData;
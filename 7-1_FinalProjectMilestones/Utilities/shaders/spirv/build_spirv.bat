@@ -0,0 +1,6 @@
+@echo off
+rem compile the SPIR-V scene shaders for OpenGL with glslangValidator
+rem from the Vulkan SDK
+cd /d "%~dp0"
+glslangValidator -G -o vertexShader.spv vertexShader.vert || exit /b 1
+glslangValidator -G -o fragmentShader.spv fragmentShader.frag || exit /b 1
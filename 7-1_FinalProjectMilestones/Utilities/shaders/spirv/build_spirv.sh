@@ -0,0 +1,6 @@
+#!/bin/sh
+# compile the SPIR-V scene shaders for OpenGL with glslangValidator
+# from the Vulkan SDK or the glslang package
+cd "$(dirname "$0")" || exit 1
+glslangValidator -G -o vertexShader.spv vertexShader.vert || exit 1
+glslangValidator -G -o fragmentShader.spv fragmentShader.frag || exit 1
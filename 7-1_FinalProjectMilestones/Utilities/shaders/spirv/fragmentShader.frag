@@ -0,0 +1,144 @@
+#version 450 core
+#extension GL_GOOGLE_include_directive : require
+
+// SPIR-V build of fragmentShader.glsl - compile it with
+// build_spirv.bat or build_spirv.sh
+//
+// The defines of the GLSL variants are specialization
+// constants here, so one module covers every variant and
+// the driver folds the branches when the shader is
+// specialized.  The constant ids and the uniform locations
+// must match ShaderUniforms.h.
+
+layout(constant_id = 0) const int TOTAL_LIGHTS = 4;
+layout(constant_id = 1) const bool USE_TEXTURE = false;
+layout(constant_id = 2) const bool USE_LIGHTING = false;
+
+// the light array needs a fixed size for its explicit location
+#define MAX_LIGHTS 4
+// the most texture arrays that objectTexture can select from -
+// the SPIR-V build always binds them to texture units, since
+// bindless samplers are not available in SPIR-V
+#define MAX_TEXTURE_ARRAYS 16
+
+// the size of the materials array, which matches
+// MaterialTable::MAX_MATERIALS
+#define MAX_MATERIALS 256
+
+// std140 layout that matches MATERIAL_DATA in MaterialTable.h
+struct Material 
+{
+    // rgb holds the ambient color, a the ambient strength
+    vec4 ambient;
+    // rgb holds the diffuse color
+    vec4 diffuse;
+    // rgb holds the specular color, a the shininess
+    vec4 specular;
+}; 
+
+struct LightSource 
+{
+    vec3 position;	
+    vec3 ambientColor;
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float focalStrength;
+    float specularIntensity;
+};
+
+layout (location = 0) in vec3 fragmentPosition;
+layout (location = 1) in vec3 fragmentVertexNormal;
+layout (location = 2) in vec2 fragmentTextureCoordinate;
+layout (location = 3) flat in vec4 fragmentObjectColor;
+layout (location = 4) flat in int fragmentMaterialIndex;
+layout (location = 5) flat in ivec2 fragmentObjectTexture;
+layout (location = 6) flat in vec4 fragmentAtlasRect;
+layout (location = 7) flat in vec2 fragmentUVScale;
+
+layout (location = 0) out vec4 outFragmentColor;
+
+layout(location = 40) uniform sampler2DArray textureArrays[MAX_TEXTURE_ARRAYS];
+
+// the scene materials, packed when the scene is prepared
+layout(std140, binding = 1) uniform MaterialTable
+{
+   Material materials[MAX_MATERIALS];
+};
+layout(location = 16) uniform LightSource lightSources[MAX_LIGHTS];
+
+#include "../frameData.glsl"
+
+// function prototypes
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+
+void main()
+{
+   vec4 surfaceColor;
+   if (USE_TEXTURE)
+   {
+      // the texture repeats within its atlas rectangle, with the
+      // mipmap level picked before the coordinates wrap
+      vec2 textureCoordinate = fragmentTextureCoordinate * fragmentUVScale;
+      vec2 atlasCoordinate = fragmentAtlasRect.xy + fract(textureCoordinate) * fragmentAtlasRect.zw;
+      surfaceColor = textureGrad(
+         textureArrays[fragmentObjectTexture.x],
+         vec3(atlasCoordinate, float(fragmentObjectTexture.y)),
+         dFdx(textureCoordinate) * fragmentAtlasRect.zw,
+         dFdy(textureCoordinate) * fragmentAtlasRect.zw);
+   }
+   else
+   {
+      surfaceColor = fragmentObjectColor;
+   }
+
+   if (USE_LIGHTING)
+   {
+      // properties
+      vec3 lightNormal = normalize(fragmentVertexNormal);
+      vec3 viewDirection = normalize(frameData.viewPosition.xyz - fragmentPosition);
+      vec3 phongResult = vec3(0.0f);
+      Material material = materials[fragmentMaterialIndex];
+
+      for(int i = 0; i < min(TOTAL_LIGHTS, MAX_LIGHTS); i++)
+      {
+         phongResult += CalcLightSource(lightSources[i], material, lightNormal, fragmentPosition, viewDirection); 
+      }   
+
+      outFragmentColor = vec4(phongResult * surfaceColor.xyz, USE_TEXTURE ? 1.0 : surfaceColor.w);
+   }
+   else
+   {
+      outFragmentColor = surfaceColor;
+   }
+}
+
+// calculates the color when using a directional light.
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   vec3 ambient;
+   vec3 diffuse;
+   vec3 specular;
+
+   //**Calculate Ambient lighting**
+
+   ambient = light.ambientColor + (material.ambient.rgb * material.ambient.a);
+
+   //**Calculate Diffuse lighting**
+
+   // Calculate distance (light direction) between light source and fragments/pixels
+   vec3 lightDirection = normalize(light.position - vertexPosition); 
+   // Calculate diffuse impact by generating dot product of normal and light
+   float impact = max(dot(lightNormal, lightDirection), 0.0);
+   // Generate diffuse material color   
+   diffuse = impact * material.diffuse.rgb; 
+
+   //**Calculate Specular lighting**
+
+   // Calculate reflection vector
+   vec3 reflectDir = reflect(-lightDirection, lightNormal);
+   // Calculate specular component
+   float specularComponent = pow(max(dot(viewDirection, reflectDir), 0.0), light.focalStrength);
+   specular = (light.specularIntensity * material.specular.a) * specularComponent * material.specular.rgb;
+  
+   return(ambient + diffuse + specular);
+}
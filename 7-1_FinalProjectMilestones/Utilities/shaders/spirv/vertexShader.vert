@@ -0,0 +1,78 @@
+#version 450 core
+#extension GL_GOOGLE_include_directive : require
+
+// SPIR-V build of vertexShader.glsl - compile it with
+// build_spirv.bat or build_spirv.sh
+
+layout(constant_id = 3) const bool USE_VERTEX_PULLING = false;
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+layout (location = 8) in int inInstanceMaterial;
+layout (location = 9) in vec4 inInstanceAtlasRect;
+layout (location = 10) in vec2 inInstanceUVScale;
+layout (location = 11) in ivec2 inInstanceTexture;
+
+layout (location = 0) out vec3 fragmentPosition;
+layout (location = 1) out vec3 fragmentVertexNormal;
+layout (location = 2) out vec2 fragmentTextureCoordinate;
+layout (location = 3) flat out vec4 fragmentObjectColor;
+layout (location = 4) flat out int fragmentMaterialIndex;
+layout (location = 5) flat out ivec2 fragmentObjectTexture;
+layout (location = 6) flat out vec4 fragmentAtlasRect;
+layout (location = 7) flat out vec2 fragmentUVScale;
+
+layout(location = 0) uniform mat4 model;
+layout(location = 1) uniform vec4 objectColor;
+layout(location = 2) uniform ivec2 objectTexture;
+layout(location = 3) uniform vec2 UVscale;
+layout(location = 9) uniform vec4 atlasRect;
+layout(location = 4) uniform int materialIndex;
+layout(location = 5) uniform bool instanced;
+
+#include "../frameData.glsl"
+
+struct PackedVertex
+{
+   float positionX;
+   float positionY;
+   float positionZ;
+   uint normal;
+   uint textureCoordinate;
+};
+layout(std430, binding = 0) readonly buffer MeshVertices
+{
+   PackedVertex vertices[];
+};
+
+void main()
+{
+   vec3 vertexPosition = inVertexPosition;
+   vec3 vertexNormal = inVertexNormal;
+   vec2 textureCoordinate = inTextureCoordinate;
+   if (USE_VERTEX_PULLING && instanced)
+   {
+      PackedVertex vertex = vertices[gl_VertexID];
+      vertexPosition = vec3(vertex.positionX, vertex.positionY, vertex.positionZ);
+      int normal = int(vertex.normal);
+      vertexNormal = max(vec3(
+         bitfieldExtract(normal, 0, 10),
+         bitfieldExtract(normal, 10, 10),
+         bitfieldExtract(normal, 20, 10)) / 511.0, -1.0);
+      textureCoordinate = unpackHalf2x16(vertex.textureCoordinate);
+   }
+
+   mat4 objectModel = instanced ? inInstanceModel : model;
+   fragmentPosition = vec3(objectModel * vec4(vertexPosition, 1.0));
+   gl_Position = frameData.projection * frameData.view * objectModel * vec4(vertexPosition, 1.0f);
+   fragmentVertexNormal = vertexNormal;
+   fragmentTextureCoordinate = textureCoordinate;
+   fragmentObjectColor = instanced ? inInstanceColor : objectColor;
+   fragmentMaterialIndex = instanced ? inInstanceMaterial : materialIndex;
+   fragmentObjectTexture = instanced ? inInstanceTexture : objectTexture;
+   fragmentAtlasRect = instanced ? inInstanceAtlasRect : atlasRect;
+   fragmentUVScale = instanced ? inInstanceUVScale : UVscale;
+}
@@ -1,20 +1,90 @@
-#version 330 core
-layout (location = 0) in vec3 inVertexPosition;
-layout (location = 1) in vec3 inVertexNormal;
-layout (location = 2) in vec2 inTextureCoordinate;
-
-out vec3 fragmentPosition;
-out vec3 fragmentVertexNormal;
-out vec2 fragmentTextureCoordinate;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
-   fragmentTextureCoordinate = inTextureCoordinate;
+#version 440 core
+
+// This shader is compiled into variants by the ShaderManager,
+// which defines this before compiling:
+//   USE_VERTEX_PULLING - instanced draws read their vertices
+//                        from the MeshVertices storage buffer
+//                        instead of the vertex attributes
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+// the per-instance values of instanced draws, which match
+// INSTANCE_DATA in InstancedMeshes.h - the model matrix takes
+// locations 3 to 6
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+layout (location = 8) in int inInstanceMaterial;
+layout (location = 9) in vec4 inInstanceAtlasRect;
+layout (location = 10) in vec2 inInstanceUVScale;
+layout (location = 11) in ivec2 inInstanceTexture;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out vec4 fragmentObjectColor;
+flat out int fragmentMaterialIndex;
+flat out ivec2 fragmentObjectTexture;
+flat out vec4 fragmentAtlasRect;
+flat out vec2 fragmentUVScale;
+
+layout(location = 0) uniform mat4 model;
+layout(location = 1) uniform vec4 objectColor = vec4(1.0f);
+layout(location = 2) uniform ivec2 objectTexture;
+layout(location = 3) uniform vec2 UVscale = vec2(1.0f, 1.0f);
+layout(location = 9) uniform vec4 atlasRect = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+layout(location = 4) uniform int materialIndex;
+// whether the model, color, texture and material come from
+// the instance attributes instead of the uniforms above
+layout(location = 5) uniform bool instanced = false;
+
+#include "frameData.glsl"
+
+#ifdef USE_VERTEX_PULLING
+// the vertices of the shared mesh buffer, which match
+// PACKED_VERTEX in InstancedMeshes.h
+struct PackedVertex
+{
+   float positionX;
+   float positionY;
+   float positionZ;
+   uint normal;
+   uint textureCoordinate;
+};
+layout(std430, binding = 0) readonly buffer MeshVertices
+{
+   PackedVertex vertices[];
+};
+#endif
+
+void main()
+{
+   vec3 vertexPosition = inVertexPosition;
+   vec3 vertexNormal = inVertexNormal;
+   vec2 textureCoordinate = inTextureCoordinate;
+#ifdef USE_VERTEX_PULLING
+   // gl_VertexID already counts from the base vertex of the draw
+   if (instanced)
+   {
+      PackedVertex vertex = vertices[gl_VertexID];
+      vertexPosition = vec3(vertex.positionX, vertex.positionY, vertex.positionZ);
+      int normal = int(vertex.normal);
+      vertexNormal = max(vec3(
+         bitfieldExtract(normal, 0, 10),
+         bitfieldExtract(normal, 10, 10),
+         bitfieldExtract(normal, 20, 10)) / 511.0, -1.0);
+      textureCoordinate = unpackHalf2x16(vertex.textureCoordinate);
+   }
+#endif
+
+   mat4 objectModel = instanced ? inInstanceModel : model;
+   fragmentPosition = vec3(objectModel * vec4(vertexPosition, 1.0));
+   gl_Position = frameData.projection * frameData.view * objectModel * vec4(vertexPosition, 1.0f);
+   fragmentVertexNormal = vertexNormal;
+   fragmentTextureCoordinate = textureCoordinate;
+   fragmentObjectColor = instanced ? inInstanceColor : objectColor;
+   fragmentMaterialIndex = instanced ? inInstanceMaterial : materialIndex;
+   fragmentObjectTexture = instanced ? inInstanceTexture : objectTexture;
+   fragmentAtlasRect = instanced ? inInstanceAtlasRect : atlasRect;
+   fragmentUVScale = instanced ? inInstanceUVScale : UVscale;
 }
\ No newline at end of file